@@ -1,4 +1,5 @@
 #include "components/battery/BatteryController.h"
+#include "components/datachanges/DataChanges.h"
 #include "drivers/PinMap.h"
 #include <hal/nrf_gpio.h>
 #include <nrfx_saadc.h>
@@ -15,8 +16,13 @@ Battery::Battery() {
 }
 
 void Battery::ReadPowerState() {
+  bool wasCharging = isCharging;
+  bool wasPowerPresent = isPowerPresent;
   isCharging = !nrf_gpio_pin_read(PinMap::Charging);
   isPowerPresent = !nrf_gpio_pin_read(PinMap::PowerPresent);
+  if (isCharging != wasCharging || isPowerPresent != wasPowerPresent) {
+    DataChanges::Publish(Topics::Battery);
+  }
 
   if (isPowerPresent && !isCharging) {
     isFull = true;
@@ -87,6 +93,7 @@ void Battery::SaadcEventHandler(nrfx_saadc_evt_t const* p_event) {
       firstMeasurement = false;
       percentRemaining = newPercent;
       systemTask->PushMessage(System::Messages::BatteryPercentageUpdated);
+      DataChanges::Publish(Topics::Battery);
     }
 
     nrfx_saadc_uninit();
@@ -1,4 +1,5 @@
 #include "components/ble/BleController.h"
+#include "components/datachanges/DataChanges.h"
 
 using namespace Pinetime::Controllers;
 
@@ -8,10 +9,12 @@ bool Ble::IsConnected() const {
 
 void Ble::Connect() {
   isConnected = true;
+  DataChanges::Publish(Topics::Ble);
 }
 
 void Ble::Disconnect() {
   isConnected = false;
+  DataChanges::Publish(Topics::Ble);
 }
 
 bool Ble::IsRadioEnabled() const {
@@ -20,10 +23,12 @@ bool Ble::IsRadioEnabled() const {
 
 void Ble::EnableRadio() {
   isRadioEnabled = true;
+  DataChanges::Publish(Topics::Ble);
 }
 
 void Ble::DisableRadio() {
   isRadioEnabled = false;
+  DataChanges::Publish(Topics::Ble);
 }
 
 void Ble::StartFirmwareUpdate() {
@@ -0,0 +1,29 @@
+#include "components/datachanges/DataChanges.h"
+
+using namespace Pinetime::Controllers;
+
+std::atomic<TopicSet> DataChanges::subscriptions {0};
+std::atomic<TopicSet> DataChanges::pending {0};
+DataChanges::Listener DataChanges::listener = nullptr;
+void* DataChanges::listenerContext = nullptr;
+
+void DataChanges::Publish(Topics topic) {
+  auto bit = static_cast<TopicSet>(topic);
+  if ((subscriptions & bit) == 0) {
+    return;
+  }
+  if (pending.fetch_or(bit) == 0 && listener != nullptr) {
+    listener(listenerContext);
+  }
+}
+
+void DataChanges::SetListener(Listener listener, void* context) {
+  DataChanges::listenerContext = context;
+  DataChanges::listener = listener;
+}
+
+void DataChanges::Subscribe(TopicSet topics) {
+  subscriptions = topics;
+  // Changes of the previous subscriptions are not relevant anymore
+  pending &= topics;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    // Data of the controllers the screens can subscribe to
+    enum class Topics : uint8_t {
+      DateTime = 1 << 0,  // Every second
+      Battery = 1 << 1,   // Percentage, charging and power present
+      Ble = 1 << 2,       // Connection and radio state
+      HeartRate = 1 << 3, // Heart rate and measurement state
+      Motion = 1 << 4,    // Step count
+    };
+
+    using TopicSet = uint8_t;
+
+    constexpr TopicSet operator|(Topics lhs, Topics rhs) {
+      return static_cast<TopicSet>(lhs) | static_cast<TopicSet>(rhs);
+    }
+
+    constexpr TopicSet operator|(TopicSet lhs, Topics rhs) {
+      return lhs | static_cast<TopicSet>(rhs);
+    }
+
+    /* Publish/subscribe of the changes of the data of the controllers.
+     *
+     * The controllers publish a topic when their data change, from any task or interrupt. The display task subscribes
+     * to the topics the current screen shows: the listener is called when one of them is published while none was
+     * pending, so that the display task is woken up once, and takes the pending topics to refresh the screen.
+     * Topics nobody subscribed to are dropped, and nothing is published while the display sleeps.
+     */
+    class DataChanges {
+    public:
+      using Listener = void (*)(void* context);
+
+      static void Publish(Topics topic);
+
+      static void SetListener(Listener listener, void* context);
+      static void Subscribe(TopicSet topics);
+
+      // Returns and clears the topics published since the last call
+      static TopicSet TakePending() {
+        return pending.exchange(0);
+      }
+
+    private:
+      static std::atomic<TopicSet> subscriptions;
+      static std::atomic<TopicSet> pending;
+      static Listener listener;
+      static void* listenerContext;
+    };
+  }
+}
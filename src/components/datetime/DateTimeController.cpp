@@ -1,5 +1,6 @@
 #include "components/datetime/DateTimeController.h"
 #include <date/date.h>
+#include "components/datachanges/DataChanges.h"
 #include <libraries/log/nrf_log.h>
 #include <systemtask/SystemTask.h>
 
@@ -17,6 +18,7 @@ DateTime::DateTime(Controllers::Settings& settingsController) : settingsControll
 void DateTime::SetCurrentTime(std::chrono::time_point<std::chrono::system_clock, std::chrono::nanoseconds> t) {
   this->currentDateTime = t;
   UpdateTime(previousSystickCounter); // Update internal state without updating the time
+  DataChanges::Publish(Topics::DateTime);
 }
 
 void DateTime::SetTime(uint16_t year,
@@ -44,6 +46,7 @@ void DateTime::SetTime(uint16_t year,
   previousSystickCounter = systickCounter;
 
   UpdateTime(systickCounter);
+  DataChanges::Publish(Topics::DateTime);
   NRF_LOG_INFO("* %d %d %d ", this->hour, this->minute, this->second);
   NRF_LOG_INFO("* %d %d %d ", this->day, this->month, this->year);
 
@@ -96,6 +99,9 @@ void DateTime::UpdateTime(uint32_t systickCounter) {
   hour = time.hours().count();
   minute = time.minutes().count();
   second = time.seconds().count();
+  if (correctedDelta > 0) {
+    DataChanges::Publish(Topics::DateTime);
+  }
 
   if (minute == 0 && !isHourAlreadyNotified) {
     isHourAlreadyNotified = true;
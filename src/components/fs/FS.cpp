@@ -5,6 +5,25 @@
 
 using namespace Pinetime::Controllers;
 
+namespace {
+  class Lock {
+  public:
+    explicit Lock(SemaphoreHandle_t mutex) : mutex {mutex} {
+      xSemaphoreTake(mutex, portMAX_DELAY);
+    }
+
+    ~Lock() {
+      xSemaphoreGive(mutex);
+    }
+
+    Lock(const Lock&) = delete;
+    Lock& operator=(const Lock&) = delete;
+
+  private:
+    SemaphoreHandle_t mutex;
+  };
+}
+
 FS::FS(Pinetime::Drivers::SpiNorFlash& driver)
   : flashDriver {driver},
     lfsConfig {
@@ -29,6 +48,8 @@ FS::FS(Pinetime::Drivers::SpiNorFlash& driver)
 }
 
 void FS::Init() {
+  mutex = xSemaphoreCreateMutex();
+  Lock lock {mutex};
 
   // try mount
   int err = lfs_mount(&lfs, &lfsConfig);
@@ -55,53 +76,67 @@ void FS::VerifyResource() {
 }
 
 int FS::FileOpen(lfs_file_t* file_p, const char* fileName, const int flags) {
+  Lock lock {mutex};
   return lfs_file_open(&lfs, file_p, fileName, flags);
 }
 
 int FS::FileClose(lfs_file_t* file_p) {
+  Lock lock {mutex};
   return lfs_file_close(&lfs, file_p);
 }
 
 int FS::FileRead(lfs_file_t* file_p, uint8_t* buff, uint32_t size) {
+  Lock lock {mutex};
   return lfs_file_read(&lfs, file_p, buff, size);
 }
 
 int FS::FileWrite(lfs_file_t* file_p, const uint8_t* buff, uint32_t size) {
+  Lock lock {mutex};
   return lfs_file_write(&lfs, file_p, buff, size);
 }
 
 int FS::FileSeek(lfs_file_t* file_p, uint32_t pos) {
+  Lock lock {mutex};
   return lfs_file_seek(&lfs, file_p, pos, LFS_SEEK_SET);
 }
 
 int FS::FileDelete(const char* fileName) {
+  Lock lock {mutex};
   return lfs_remove(&lfs, fileName);
 }
 
 int FS::DirOpen(const char* path, lfs_dir_t* lfs_dir) {
+  Lock lock {mutex};
   return lfs_dir_open(&lfs, lfs_dir, path);
 }
 
 int FS::DirClose(lfs_dir_t* lfs_dir) {
+  Lock lock {mutex};
   return lfs_dir_close(&lfs, lfs_dir);
 }
 
 int FS::DirRead(lfs_dir_t* dir, lfs_info* info) {
+  Lock lock {mutex};
   return lfs_dir_read(&lfs, dir, info);
 }
 int FS::DirRewind(lfs_dir_t* dir) {
+  Lock lock {mutex};
   return lfs_dir_rewind(&lfs, dir);
 }
 int FS::DirCreate(const char* path) {
+  Lock lock {mutex};
   return lfs_mkdir(&lfs, path);
 }
 int FS::Rename(const char* oldPath, const char* newPath) {
+  Lock lock {mutex};
   return lfs_rename(&lfs, oldPath, newPath);
 }
 int FS::Stat(const char* path, lfs_info* info) {
+  Lock lock {mutex};
   return lfs_stat(&lfs, path, info);
 }
 lfs_ssize_t FS::GetFSSize() {
+  Lock lock {mutex};
   return lfs_fs_size(&lfs);
 }
 
@@ -1,11 +1,16 @@
 #pragma once
 
 #include <cstdint>
+#include <FreeRTOS.h>
+#include <semphr.h>
 #include "drivers/SpiNorFlash.h"
 #include <littlefs/lfs.h>
 
 namespace Pinetime {
   namespace Controllers {
+    /* The methods can be called from several tasks (the display task reads the fonts while the BLE host writes the files
+     * sent by the companion app): littlefs is not reentrant, every call to it is serialized by a mutex.
+     */
     class FS {
     public:
       FS(Pinetime::Drivers::SpiNorFlash&);
@@ -72,6 +77,7 @@ namespace Pinetime {
       const struct lfs_config lfsConfig;
 
       lfs_t lfs;
+      SemaphoreHandle_t mutex = nullptr;
 
       static int SectorSync(const struct lfs_config* c);
       static int SectorErase(const struct lfs_config* c, lfs_block_t block);
@@ -0,0 +1,117 @@
+#include "components/heartrate/FixedPointFilters.h"
+#include <climits>
+#include <cstdlib>
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+  #include <nrf.h> // CMSIS intrinsics
+#endif
+
+using namespace Pinetime::Controllers::FixedPoint;
+
+namespace {
+  int32_t ToFixed(float value, uint8_t fractionalBits) {
+    float scaled = value * static_cast<float>(1UL << fractionalBits);
+    return static_cast<int32_t>(scaled < 0 ? scaled - 0.5f : scaled + 0.5f);
+  }
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+  // acc + (low half of x * low half of y) + (high half of x * high half of y)
+  inline int32_t MultiplyAccumulateDual(uint32_t x, uint32_t y, int32_t acc) {
+    return static_cast<int32_t>(__SMLAD(x, y, static_cast<uint32_t>(acc)));
+  }
+
+  template <uint8_t Bits> inline int32_t Saturate(int32_t value) {
+    return __SSAT(value, Bits);
+  }
+
+  // low as the low half and the low half of high as the high half
+  inline uint32_t Pack(int32_t low, uint32_t high) {
+    return __PKHBT(static_cast<uint32_t>(low), high, 16);
+  }
+#else
+  inline int32_t MultiplyAccumulateDual(uint32_t x, uint32_t y, int32_t acc) {
+    return acc + static_cast<int16_t>(x) * static_cast<int16_t>(y) + static_cast<int16_t>(x >> 16) * static_cast<int16_t>(y >> 16);
+  }
+
+  template <uint8_t Bits> inline int32_t Saturate(int32_t value) {
+    constexpr int32_t max = (1L << (Bits - 1)) - 1;
+    constexpr int32_t min = -(1L << (Bits - 1));
+    return value > max ? max : (value < min ? min : value);
+  }
+
+  inline uint32_t Pack(int32_t low, uint32_t high) {
+    return (static_cast<uint32_t>(low) & 0xffff) | (high << 16);
+  }
+#endif
+}
+
+/** Same filter as Biquad, computed in Direct Form I so that the state holds samples instead of the (larger) internal
+ * values of the Direct Form II.
+ */
+Biquad32::Biquad32(float b0, float b1, float b2, float a1, float a2)
+  : b0 {ToFixed(b0, 28)}, b1 {ToFixed(b1, 28)}, b2 {ToFixed(b2, 28)}, a1 {ToFixed(a1, 28)}, a2 {ToFixed(a2, 28)} {
+}
+
+int32_t Biquad32::Step(int32_t x) {
+  int64_t acc = (1LL << 27);
+  acc += static_cast<int64_t>(b0) * x;
+  acc += static_cast<int64_t>(b1) * x1;
+  acc += static_cast<int64_t>(b2) * x2;
+  acc -= static_cast<int64_t>(a1) * y1;
+  acc -= static_cast<int64_t>(a2) * y2;
+  auto y = static_cast<int32_t>(acc >> 28);
+
+  x2 = x1;
+  x1 = x;
+  y2 = y1;
+  y1 = y;
+
+  return y;
+}
+
+Biquad16::Biquad16(float b0, float b1, float b2, float a1, float a2)
+  : b0 {ToFixed(b0, 14)},
+    b12 {Pack(ToFixed(b1, 14), static_cast<uint32_t>(ToFixed(b2, 14)))},
+    a12 {Pack(ToFixed(-a1, 14), static_cast<uint32_t>(ToFixed(-a2, 14)))} {
+}
+
+int16_t Biquad16::Step(int16_t x) {
+  int32_t acc = (1L << 13) + b0 * x;
+  acc = MultiplyAccumulateDual(x12, b12, acc);
+  acc = MultiplyAccumulateDual(y12, a12, acc);
+  auto y = Saturate<16>(acc >> 14);
+
+  // The previous value goes to the high half
+  x12 = Pack(x, x12);
+  y12 = Pack(y, y12);
+
+  return static_cast<int16_t>(y);
+}
+
+Ptagc::Ptagc(float start, float decay, float threshold)
+  : peak {ToFixed(start, 16)}, decay {ToFixed(decay, 30)}, boost {ToFixed(1.0f / decay, 30)}, threshold {ToFixed(threshold, 8)} {
+}
+
+int32_t Ptagc::Step(int32_t spl) {
+  int32_t magnitude = std::abs(spl);
+  int32_t gain = (static_cast<int64_t>(magnitude) << 8) > peak ? boost : decay;
+  int64_t nextPeak = (static_cast<int64_t>(peak) * gain + (1LL << 29)) >> 30;
+  // The peak could not grow anymore if it was rounded down to 0 while the input is null
+  constexpr int32_t minPeak = 1 << 8;
+  peak = nextPeak > INT32_MAX ? INT32_MAX : (nextPeak < minPeak ? minPeak : static_cast<int32_t>(nextPeak));
+
+  auto limit = static_cast<int32_t>((static_cast<int64_t>(peak) * threshold) >> 16);
+  if (magnitude > limit)
+    return 0;
+
+  // 100 * spl / (2 * peak) in Q8, spl is scaled down with peak so that the product fits in 32 bits
+  constexpr int32_t scale = 100 * 256 / 2;
+  constexpr int32_t maxMagnitudeBits = 17;
+  int32_t divisor = peak >> 8;
+  int32_t magnitudeBits = 32 - __builtin_clz(magnitude | 1);
+  if (magnitudeBits > maxMagnitudeBits) {
+    spl >>= magnitudeBits - maxMagnitudeBits;
+    divisor >>= magnitudeBits - maxMagnitudeBits;
+  }
+  return scale * spl / divisor;
+}
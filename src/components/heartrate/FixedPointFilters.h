@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Controllers {
+    /* Fixed-point versions of Biquad and Ptagc, for the preprocessing of the samples in Ppg.
+     *
+     * The samples are in Q8 (integers with 8 fractional bits). The coefficients are given as floats and converted
+     * when the filters are constructed.
+     */
+    namespace FixedPoint {
+      /// Direct Form I Biquad Filter with 32 bits samples and Q28 coefficients (64 bits accumulator)
+      class Biquad32 {
+      public:
+        Biquad32(float b0, float b1, float b2, float a1, float a2);
+        int32_t Step(int32_t x);
+
+      private:
+        int32_t b0;
+        int32_t b1;
+        int32_t b2;
+        int32_t a1;
+        int32_t a2;
+
+        int32_t x1 = 0;
+        int32_t x2 = 0;
+        int32_t y1 = 0;
+        int32_t y2 = 0;
+      };
+
+      /// Direct Form I Biquad Filter with 16 bits samples and Q14 coefficients (32 bits accumulator, 2 MACs per
+      /// SMLAD). The gain of the filter must be low enough for the accumulator not to overflow.
+      class Biquad16 {
+      public:
+        Biquad16(float b0, float b1, float b2, float a1, float a2);
+        int16_t Step(int16_t x);
+
+      private:
+        int32_t b0;
+        // Pairs of 16 bits values: b1 and b2, -a1 and -a2
+        uint32_t b12;
+        uint32_t a12;
+
+        // Pairs of 16 bits values: x[n-1] and x[n-2], y[n-1] and y[n-2]
+        uint32_t x12 = 0;
+        uint32_t y12 = 0;
+      };
+
+      /// Peak tracking automatic gain control, the output is in [-100, 100] (Q8)
+      class Ptagc {
+      public:
+        Ptagc(float start, float decay, float threshold);
+        int32_t Step(int32_t spl);
+
+      private:
+        // Q16
+        int32_t peak;
+        // Q30
+        int32_t decay;
+        int32_t boost;
+        // Q8
+        int32_t threshold;
+      };
+    }
+  }
+}
@@ -1,20 +1,27 @@
 #include "components/heartrate/HeartRateController.h"
+#include "components/datachanges/DataChanges.h"
 #include <heartratetask/HeartRateTask.h>
 #include <systemtask/SystemTask.h>
 
 using namespace Pinetime::Controllers;
 
 void HeartRateController::Update(HeartRateController::States newState, uint8_t heartRate) {
+  bool changed = this->state != newState;
   this->state = newState;
   if (this->heartRate != heartRate) {
     this->heartRate = heartRate;
     service->OnNewHeartRateValue(heartRate);
+    changed = true;
+  }
+  if (changed) {
+    DataChanges::Publish(Topics::HeartRate);
   }
 }
 
 void HeartRateController::Start() {
   if (task != nullptr) {
     state = States::NotEnoughData;
+    DataChanges::Publish(Topics::HeartRate);
     task->PushMessage(Pinetime::Applications::HeartRateTask::Messages::StartMeasurement);
   }
 }
@@ -22,6 +29,7 @@ void HeartRateController::Start() {
 void HeartRateController::Stop() {
   if (task != nullptr) {
     state = States::Stopped;
+    DataChanges::Publish(Topics::HeartRate);
     task->PushMessage(Pinetime::Applications::HeartRateTask::Messages::StopMeasurement);
   }
 }
@@ -5,95 +5,167 @@
 */
 
 #include "components/heartrate/Ppg.h"
-#include <vector>
+#include <algorithm>
+#include <nrf.h>
 #include <nrf_log.h>
 using namespace Pinetime::Controllers;
 
 /** Original implementation from wasp-os : https://github.com/daniel-thompson/wasp-os/blob/master/wasp/ppg.py */
 namespace {
-  int Compare(int8_t* d1, int8_t* d2, size_t count) {
-    int e = 0;
-    for (size_t i = 0; i < count; i++) {
-      auto d = d1[i] - d2[i];
-      e += d * d;
-    }
-    return e;
-  }
+  // Rate the filters are designed for
+  constexpr float nominalSampleRate = 24.0f;
+}
+
+Ppg::Ppg(uint32_t timestampFrequency)
+  : timestampFrequency {timestampFrequency},
+    hpf {0.87033078, -1.74066156, 0.87033078, -1.72377617, 0.75754694},
+    agc {20, 0.971, 2},
+    lpf {0.11595249, 0.23190498, 0.11595249, -0.72168143, 0.18549138} {
+}
 
-  int CompareShift(int8_t* d, int shift, size_t count) {
-    return Compare(d + shift, d, count - shift);
+int8_t Ppg::Preprocess(uint32_t spl, uint32_t timestamp) {
+  uint32_t startCycleCount = DWT->CYCCNT;
+#if PPG_FIXED_POINT
+  // Q8, the output of the AGC is in [-100, 100]
+  int32_t value = (static_cast<int32_t>(spl) - offset) * 256;
+  value = hpf.Step(value);
+  value = agc.Step(value);
+  value = lpf.Step(static_cast<int16_t>(value));
+
+  auto spl_int = static_cast<int8_t>(value / 256);
+#else
+  auto value = static_cast<float>(static_cast<int32_t>(spl) - offset);
+  value = hpf.Step(value);
+  value = agc.Step(value);
+  value = lpf.Step(value);
+
+  auto spl_int = static_cast<int8_t>(value);
+#endif
+
+  if (nbTimestamps == 0) {
+    firstTimestamp = timestamp;
   }
+  lastTimestamp = timestamp;
+  nbTimestamps++;
 
-  int Trough(int8_t* d, size_t size, uint8_t mn, uint8_t mx) {
-    auto z2 = CompareShift(d, mn - 2, size);
-    auto z1 = CompareShift(d, mn - 1, size);
-    for (int i = mn; i < mx + 1; i++) {
-      auto z = CompareShift(d, i, size);
-      if (z2 > z1 && z1 < z)
-        return i;
-      z2 = z1;
-      z1 = z;
+  Push(spl_int);
+  preprocessCycles += DWT->CYCCNT - startCycleCount;
+  nbPreprocessed++;
+  return spl_int;
+}
+
+/* The differences of each lag are updated with the pairs of samples that enter and leave the window, instead of being
+ * computed again on the whole window for each estimate: the cost of a sample is constant, and the estimate is
+ * available for each sample.
+ */
+void Ppg::Push(int8_t sample) {
+  size_t position;
+  if (dataIndex == windowSize) {
+    // The oldest sample leaves the window, and the new one takes its place
+    int8_t oldest = data[dataHead];
+    for (int lag = minLag; lag <= maxLag; lag++) {
+      size_t index = dataHead + lag;
+      if (index >= windowSize) {
+        index -= windowSize;
+      }
+      int d = data[index] - oldest;
+      differences[lag - minLag] -= d * d;
     }
-    return -1;
+    position = dataHead;
+    dataHead = (dataHead + 1) % windowSize;
+  } else {
+    position = dataIndex++;
   }
-}
+  data[position] = sample;
 
-Ppg::Ppg()
-  : hpf {0.87033078, -1.74066156, 0.87033078, -1.72377617, 0.75754694},
-    agc {20, 0.971, 2},
-    lpf {0.11595249, 0.23190498, 0.11595249, -0.72168143, 0.18549138} {
+  int lastLag = std::min<int>(maxLag, dataIndex - 1);
+  for (int lag = minLag; lag <= lastLag; lag++) {
+    size_t index = position + (position < static_cast<size_t>(lag) ? windowSize : 0) - lag;
+    int d = sample - data[index];
+    differences[lag - minLag] += d * d;
+  }
 }
 
-int8_t Ppg::Preprocess(float spl) {
-  spl -= offset;
-  spl = hpf.Step(spl);
-  spl = agc.Step(spl);
-  spl = lpf.Step(spl);
-
-  auto spl_int = static_cast<int8_t>(spl);
+int Ppg::Trough(int mn, int mx) const {
+  if (mn - 2 < minLag || mx > maxLag)
+    return -1;
 
-  if (dataIndex < 200)
-    data[dataIndex++] = spl_int;
-  return spl_int;
+  auto z2 = differences[mn - 2 - minLag];
+  auto z1 = differences[mn - 1 - minLag];
+  for (int i = mn; i < mx + 1; i++) {
+    auto z = differences[i - minLag];
+    if (z2 > z1 && z1 < z)
+      return i;
+    z2 = z1;
+    z1 = z;
+  }
+  return -1;
 }
 
 float Ppg::HeartRate() {
-  if (dataIndex < 200)
+  if (dataIndex < windowSize)
     return 0;
 
-  NRF_LOG_INFO("PREPROCESS, offset = %d", offset);
+  uint32_t startCycleCount = DWT->CYCCNT;
   auto hr = ProcessHeartRate();
-  dataIndex = 0;
+  estimateCycles += DWT->CYCCNT - startCycleCount;
+
+  if (++nbEstimates == windowSize) {
+    NRF_LOG_INFO("PREPROCESS, offset = %d, sample rate = %d mHz", offset, static_cast<int>(SampleRate() * 1000));
+    NRF_LOG_INFO("Preprocess = %d cycles/sample, estimate = %d cycles/sample",
+                 preprocessCycles / nbPreprocessed,
+                 estimateCycles / nbEstimates);
+    preprocessCycles = 0;
+    estimateCycles = 0;
+    nbPreprocessed = 0;
+    nbEstimates = 0;
+  }
   return hr;
 }
+
 float Ppg::ProcessHeartRate() {
-  auto t0 = Trough(data.data(), dataIndex, 7, 48);
+  auto t0 = Trough(7, 48);
   if (t0 < 0)
     return 0;
 
-  float t1 = t0 * 2;
-  t1 = Trough(data.data(), dataIndex, t1 - 5, t1 + 5);
+  auto t1 = Trough(t0 * 2 - 5, t0 * 2 + 5);
   if (t1 < 0)
     return 0;
 
-  float t2 = static_cast<int>(t1 * 3) / 2;
-  t2 = Trough(data.data(), dataIndex, t2 - 5, t2 + 5);
+  auto t2 = (t1 * 3) / 2;
+  t2 = Trough(t2 - 5, t2 + 5);
   if (t2 < 0)
     return 0;
 
-  float t3 = static_cast<int>(t2 * 4) / 3;
-  t3 = Trough(data.data(), dataIndex, t3 - 4, t3 + 4);
+  // The lags are counted in samples, they are converted with the rate at which the samples were actually taken
+  auto sampleRate = SampleRate();
+  auto t3 = (t2 * 4) / 3;
+  t3 = Trough(t3 - 4, t3 + 4);
   if (t3 < 0)
-    return static_cast<int>(60 * 24 * 3) / static_cast<int>(t2);
+    return static_cast<int>(60 * sampleRate * 3 / t2);
 
-  return static_cast<int>(60 * 24 * 4) / static_cast<int>(t3);
+  return static_cast<int>(60 * sampleRate * 4 / t3);
 }
 
-void Ppg::SetOffset(uint16_t offset) {
+float Ppg::SampleRate() const {
+  uint32_t duration = lastTimestamp - firstTimestamp;
+  if (nbTimestamps < 2 || duration == 0)
+    return nominalSampleRate;
+  return static_cast<float>(nbTimestamps - 1) * timestampFrequency / duration;
+}
+
+void Ppg::SetOffset(uint32_t offset) {
   this->offset = offset;
-  dataIndex = 0;
+  Reset();
 }
 
 void Ppg::Reset() {
   dataIndex = 0;
+  dataHead = 0;
+  differences.fill(0);
+  nbTimestamps = 0;
+  preprocessCycles = 0;
+  estimateCycles = 0;
+  nbPreprocessed = 0;
+  nbEstimates = 0;
 }
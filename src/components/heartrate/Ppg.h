@@ -4,28 +4,62 @@
 #include <cstddef>
 #include <cstdint>
 #include "components/heartrate/Biquad.h"
+#include "components/heartrate/FixedPointFilters.h"
 #include "components/heartrate/Ptagc.h"
 
+#ifndef PPG_FIXED_POINT
+  #define PPG_FIXED_POINT 1
+#endif
+
 namespace Pinetime {
   namespace Controllers {
     class Ppg {
     public:
-      Ppg();
-      int8_t Preprocess(float spl);
+      // The timestamps of the samples are counted at timestampFrequency
+      explicit Ppg(uint32_t timestampFrequency);
+      int8_t Preprocess(uint32_t spl, uint32_t timestamp);
+      // Estimated on the last windowSize samples, for each new sample once there are enough of them. Returns 0 otherwise.
       float HeartRate();
 
-      void SetOffset(uint16_t i);
+      void SetOffset(uint32_t i);
       void Reset();
 
     private:
-      std::array<int8_t, 200> data;
+      static constexpr size_t windowSize = 200;
+      static constexpr int minLag = 5;
+      static constexpr int maxLag = windowSize - 1;
+
+      // Last samples, the oldest one is at dataHead once the window is full
+      std::array<int8_t, windowSize> data;
       size_t dataIndex = 0;
-      float offset;
+      size_t dataHead = 0;
+      // For each lag, sum of the squared differences between the samples of the window and the samples lag samples later
+      std::array<uint32_t, maxLag - minLag + 1> differences = {};
+      int32_t offset = 0;
+      uint32_t timestampFrequency;
+      // Since the start of the measurement
+      uint32_t firstTimestamp = 0;
+      uint32_t lastTimestamp = 0;
+      uint32_t nbTimestamps = 0;
+      // CPU cycles spent in Preprocess() and HeartRate() since the last log
+      uint32_t preprocessCycles = 0;
+      uint32_t estimateCycles = 0;
+      uint32_t nbPreprocessed = 0;
+      uint32_t nbEstimates = 0;
+#if PPG_FIXED_POINT
+      FixedPoint::Biquad32 hpf;
+      FixedPoint::Ptagc agc;
+      FixedPoint::Biquad16 lpf;
+#else
       Biquad hpf;
       Ptagc agc;
       Biquad lpf;
+#endif
 
+      void Push(int8_t sample);
+      int Trough(int mn, int mx) const;
       float ProcessHeartRate();
+      float SampleRate() const;
     };
   }
 }
@@ -1,4 +1,5 @@
 #include "components/motion/MotionController.h"
+#include "components/datachanges/DataChanges.h"
 #include "os/os_cputime.h"
 using namespace Pinetime::Controllers;
 
@@ -19,6 +20,9 @@ void MotionController::Update(int16_t x, int16_t y, int16_t z, uint32_t nbSteps)
   if (deltaSteps > 0) {
     currentTripSteps += deltaSteps;
   }
+  if (deltaSteps != 0) {
+    DataChanges::Publish(Topics::Motion);
+  }
 }
 
 bool MotionController::Should_RaiseWake(bool isSleeping) {
@@ -67,7 +71,10 @@ int32_t MotionController::currentShakeSpeed() {
 }
 
 void MotionController::IsSensorOk(bool isOk) {
-  isSensorOk = isOk;
+  if (isSensorOk != isOk) {
+    isSensorOk = isOk;
+    DataChanges::Publish(Topics::Motion);
+  }
 }
 void MotionController::Init(Pinetime::Drivers::Bma421::DeviceTypes types) {
   switch (types) {
@@ -0,0 +1,224 @@
+#include "displayapp/AppBenchmark.h"
+#include <malloc.h>
+#include <cstdlib>
+#include <task.h>
+#include <libraries/log/nrf_log.h>
+#include "displayapp/FsFont.h"
+#include "displayapp/GlyphLookupCache.h"
+#include "displayapp/LvglMemory.h"
+#include "displayapp/ScreenArena.h"
+#include "displayapp/screens/Screen.h"
+
+using namespace Pinetime::Applications;
+
+namespace {
+  struct GlyphLookupText {
+    const char* name;
+    const char* text;
+  };
+
+  // All of them are in jetbrains_mono_bold_20
+  constexpr GlyphLookupText glyphLookupTexts[] = {
+    {"ascii", "The quick brown fox jumps over the lazy dog 0123456789"},
+    {"cyrillic", "\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 "
+                 "\xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA\xD0\xB8\xD1\x85 \xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA"},
+    {"symbols", "\xEF\x89\x82\xEF\x88\x9E\xEF\x8A\x94\xEF\x87\xA6\xEF\x95\x8B\xEF\x80\x97\xEF\x84\xA9\xEF\x80\xBA"
+                "\xEF\x86\x85\xEF\x95\xA0\xEF\x80\x81\xEF\x8F\xBD"},
+  };
+  constexpr uint16_t glyphLookupRepeats = 500;
+
+  // Returns the number of glyph descriptors looked up per second
+  uint32_t GlyphLookupRate(const lv_font_t& font, const char* text, bool cached) {
+    lv_font_glyph_dsc_t dsc;
+    uint32_t nbGlyphs = 0;
+    TickType_t start = xTaskGetTickCount();
+    for (uint16_t i = 0; i < glyphLookupRepeats; i++) {
+      uint32_t index = 0;
+      uint32_t letter;
+      while ((letter = _lv_txt_encoded_next(text, &index)) != 0) {
+        if (cached) {
+          font.get_glyph_dsc(&font, &dsc, letter, 0);
+        } else {
+          lv_font_get_glyph_dsc_fmt_txt(&font, &dsc, letter, 0);
+        }
+        nbGlyphs++;
+      }
+    }
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    return elapsed == 0 ? 0 : nbGlyphs * configTICK_RATE_HZ / elapsed;
+  }
+
+  // Header of a block in the heap of newlib-nano, the probes must not go past the end of the heap with it
+  constexpr uint32_t heapBlockOverhead = 16;
+
+  // The fragmentation of the C heap (__HEAP_SIZE bytes, used by malloc() and new) is the part of the free memory
+  // that is not in the largest block.
+  void ReportHeapFragmentation(uint16_t appSwitches) {
+    struct mallinfo info = mallinfo();
+    // The end of the heap, never given to malloc() yet, is free too
+    uint32_t freeBytes = info.fordblks + (__HEAP_SIZE - info.arena);
+    // Size of the largest block malloc() can return, by dichotomy
+    uint32_t low = 0;
+    uint32_t high = freeBytes > heapBlockOverhead ? freeBytes - heapBlockOverhead : 0;
+    while (low < high) {
+      uint32_t size = (low + high + 1) / 2;
+      void* block = malloc(size);
+      if (block != nullptr) {
+        free(block);
+        low = size;
+      } else {
+        high = size - 1;
+      }
+    }
+    NRF_LOG_INFO("C heap after %d app switches (screen arena %s) : %d bytes free, largest block %d, fragmentation %d%%",
+                 appSwitches,
+                 SCREEN_ARENA ? "on" : "off",
+                 freeBytes,
+                 low,
+                 freeBytes == 0 ? 0 : 100 - (low * 100) / freeBytes);
+
+    auto lvglMemory = Components::LvglMemory::GetStatistics();
+    NRF_LOG_INFO("LVGL memory after %d app switches : %d bytes free, largest block %d, fragmentation %d%%, %d failed allocations",
+                 appSwitches,
+                 lvglMemory.free,
+                 lvglMemory.largestFree,
+                 lvglMemory.fragmentation,
+                 lvglMemory.failures);
+  }
+}
+
+AppBenchmark::AppBenchmark(Components::LittleVgl& lvgl) : lvgl {lvgl} {
+}
+
+void AppBenchmark::Start() {
+  scenarioIndex = 0;
+  gestureIndex = 0;
+  appLoaded = false;
+  appSwitches = 0;
+  running = true;
+  Components::FsFont::GetGlyphCache().Clear();
+  ReportGlyphLookupRates();
+  NRF_LOG_INFO("App benchmark : frames, render time, pixels, flushes, bytes, min free heap and lvgl memory, glyph cache hits/misses");
+}
+
+Apps AppBenchmark::Run(Screens::Screen& currentScreen) {
+  if (!running) {
+    return Apps::None;
+  }
+
+  if (scenarioIndex >= scenarios.size()) {
+    return SwitchApp();
+  }
+
+  const auto& scenario = scenarios[scenarioIndex];
+  TickType_t now = xTaskGetTickCount();
+
+  if (!appLoaded) {
+    appLoaded = true;
+    gestureIndex = 0;
+    result = {};
+    result.minFreeHeap = UINT32_MAX;
+    result.minFreeLvglMemory = UINT32_MAX;
+    glyphCacheStart = Components::FsFont::GetGlyphCache().GetStatistics();
+    lastFrameCount = lvgl.GetFrameCount();
+    actionStartTime = now;
+    lastFrameTime = now;
+    return scenario.app;
+  }
+
+  if (lvgl.GetFrameCount() != lastFrameCount) {
+    // Only the statistics of the last frame are kept: sample often enough not to miss any (lv_task_handler() renders
+    // at most one frame per call).
+    lastFrameCount = lvgl.GetFrameCount();
+    lastFrameTime = now;
+    Sample();
+  }
+
+  if ((now - lastFrameTime) < settleTime && (now - actionStartTime) < maxActionTime) {
+    return Apps::None;
+  }
+
+  while (gestureIndex < maxGestures && scenario.gestures[gestureIndex] == TouchEvents::None) {
+    gestureIndex++;
+  }
+  if (gestureIndex < maxGestures) {
+    currentScreen.OnTouchEvent(scenario.gestures[gestureIndex]);
+    gestureIndex++;
+    actionStartTime = now;
+    lastFrameTime = now;
+    return Apps::None;
+  }
+
+  Report(scenario);
+  appLoaded = false;
+  scenarioIndex++;
+  if (scenarioIndex >= scenarios.size()) {
+    NRF_LOG_INFO("App benchmark done, minimum ever free heap : %d", xPortGetMinimumEverFreeHeapSize());
+    ReportHeapFragmentation(0);
+  }
+  return Apps::None;
+}
+
+Apps AppBenchmark::SwitchApp() {
+  appSwitches++;
+  if (appSwitches % 1000 == 0) {
+    ReportHeapFragmentation(appSwitches);
+  }
+  if (appSwitches >= nbAppSwitches) {
+    running = false;
+    return Apps::Clock;
+  }
+  return scenarios[appSwitches % scenarios.size()].app;
+}
+
+void AppBenchmark::ReportGlyphLookupRates() {
+  for (const auto& text : glyphLookupTexts) {
+    uint32_t uncached = GlyphLookupRate(jetbrains_mono_bold_20, text.text, false);
+    uint32_t cached = GlyphLookupRate(jetbrains_mono_bold_20, text.text, true);
+    NRF_LOG_INFO("Glyph lookups (%s) : %d/s, %d/s with the cache", text.name, uncached, cached);
+  }
+  const auto& statistics = Components::GlyphLookupCache::GetStatistics();
+  NRF_LOG_INFO("Glyph lookup cache : %d hits, %d misses", statistics.hits, statistics.misses);
+}
+
+void AppBenchmark::Sample() {
+  const auto& frame = lvgl.GetLastFrameStatistics();
+  result.frames++;
+  result.flushes += frame.flushes;
+  result.flushesBeforeMerge += frame.flushesBeforeMerge;
+  result.bytes += frame.bytes;
+  result.bytesBeforeMerge += frame.bytesBeforeMerge;
+  result.renderTimeMs += frame.refreshTimeMs;
+  result.pixels += frame.pixels;
+
+  uint32_t freeHeap = xPortGetFreeHeapSize();
+  if (freeHeap < result.minFreeHeap) {
+    result.minFreeHeap = freeHeap;
+  }
+
+  auto lvglMemory = Components::LvglMemory::GetStatistics();
+  if (lvglMemory.free < result.minFreeLvglMemory) {
+    result.minFreeLvglMemory = lvglMemory.free;
+  }
+}
+
+void AppBenchmark::Report(const Scenario& scenario) {
+  const auto& glyphCache = Components::FsFont::GetGlyphCache().GetStatistics();
+  result.glyphCacheHits = glyphCache.hits - glyphCacheStart.hits;
+  result.glyphCacheMisses = glyphCache.misses - glyphCacheStart.misses;
+  // NRF_LOG_INFO() takes at most 6 arguments
+  auto app = static_cast<uint8_t>(scenario.app);
+  NRF_LOG_INFO("App %d : %d frames, %d ms, %d px", app, result.frames, result.renderTimeMs, result.pixels);
+  NRF_LOG_INFO("App %d : %d flushes (%d unmerged), %d bytes (%d unmerged)",
+               app,
+               result.flushes,
+               result.flushesBeforeMerge,
+               result.bytes,
+               result.bytesBeforeMerge);
+  NRF_LOG_INFO("App %d : heap %d, lvgl %d, glyphs %d/%d",
+               app,
+               result.minFreeHeap,
+               result.minFreeLvglMemory,
+               result.glyphCacheHits,
+               result.glyphCacheMisses);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <array>
+#include <cstdint>
+#include "displayapp/Apps.h"
+#include "displayapp/LittleVgl.h"
+#include "displayapp/TouchEvents.h"
+
+namespace Pinetime {
+  namespace Applications {
+    namespace Screens {
+      class Screen;
+    }
+
+    // Opens the built-in apps one after the other, replays a few gestures on each of them and logs, per app,
+    // the time LVGL spent rendering, the number of pixels and flushes sent to the display, and the lowest
+    // free FreeRTOS heap and LVGL memory observed. The notification screen is opened twice, first with an empty glyph
+    // cache, to compare the rendering of the fonts loaded from the filesystem with a cold and a warm cache.
+    // It then switches between the same apps nbAppSwitches times, without waiting for them to settle, and logs the
+    // fragmentation of the C heap and of the LVGL memory every 1000 switches.
+    class AppBenchmark {
+    public:
+      struct Result {
+        uint16_t frames;
+        uint32_t flushes;
+        uint32_t flushesBeforeMerge;
+        uint32_t bytes;
+        uint32_t bytesBeforeMerge;
+        uint32_t renderTimeMs;
+        uint32_t pixels;
+        uint32_t minFreeHeap;
+        uint32_t minFreeLvglMemory;
+        uint32_t glyphCacheHits;
+        uint32_t glyphCacheMisses;
+      };
+
+      explicit AppBenchmark(Components::LittleVgl& lvgl);
+
+      void Start();
+
+      bool IsRunning() const {
+        return running;
+      }
+
+      // Called from the display task after each call to lv_task_handler().
+      // Returns the app to load next, or Apps::None to keep the current one.
+      Apps Run(Screens::Screen& currentScreen);
+
+    private:
+      static constexpr uint8_t maxGestures = 2;
+      struct Scenario {
+        Apps app;
+        std::array<TouchEvents, maxGestures> gestures;
+      };
+
+      void Sample();
+      void Report(const Scenario& scenario);
+      static void ReportGlyphLookupRates();
+      Apps SwitchApp();
+
+      static constexpr std::array<Scenario, 27> scenarios {{
+        {Apps::Clock, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Launcher, {TouchEvents::SwipeUp, TouchEvents::SwipeDown}},
+        {Apps::Notifications, {TouchEvents::SwipeUp, TouchEvents::SwipeDown}},
+        {Apps::Notifications, {TouchEvents::SwipeUp, TouchEvents::SwipeDown}},
+        {Apps::QuickSettings, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Settings, {TouchEvents::SwipeUp, TouchEvents::SwipeDown}},
+        {Apps::SettingWatchFace, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingTimeFormat, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingDisplay, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingWakeUp, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingSteps, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingSetDate, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingSetTime, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingChimes, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SettingBluetooth, {TouchEvents::None, TouchEvents::None}},
+        {Apps::BatteryInfo, {TouchEvents::None, TouchEvents::None}},
+        {Apps::SysInfo, {TouchEvents::SwipeUp, TouchEvents::SwipeUp}},
+        {Apps::StopWatch, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Timer, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Alarm, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Steps, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Music, {TouchEvents::SwipeUp, TouchEvents::SwipeDown}},
+        {Apps::Navigation, {TouchEvents::None, TouchEvents::None}},
+        {Apps::HeartRate, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Motion, {TouchEvents::None, TouchEvents::None}},
+        {Apps::Twos, {TouchEvents::SwipeLeft, TouchEvents::SwipeUp}},
+        {Apps::Calculator, {TouchEvents::None, TouchEvents::None}},
+      }};
+
+      // An action (opening an app or replaying a gesture) is over when no frame has been rendered for settleTime,
+      // or after maxActionTime for apps that animate continuously.
+      static constexpr TickType_t settleTime = pdMS_TO_TICKS(200);
+      static constexpr TickType_t maxActionTime = pdMS_TO_TICKS(2000);
+      static constexpr uint16_t nbAppSwitches = 10000;
+
+      Components::LittleVgl& lvgl;
+      Result result {};
+      Components::GlyphCache::Statistics glyphCacheStart {};
+      uint8_t scenarioIndex = 0;
+      uint8_t gestureIndex = 0;
+      bool appLoaded = false;
+      uint16_t appSwitches = 0;
+      uint32_t lastFrameCount = 0;
+      TickType_t actionStartTime = 0;
+      TickType_t lastFrameTime = 0;
+      bool running = false;
+    };
+  }
+}
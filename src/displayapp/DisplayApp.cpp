@@ -1,4 +1,5 @@
 #include "displayapp/DisplayApp.h"
+#include <algorithm>
 #include <libraries/log/nrf_log.h>
 #include "displayapp/screens/HeartRate.h"
 #include "displayapp/screens/Motion.h"
@@ -10,6 +11,7 @@
 #include "components/ble/NotificationManager.h"
 #include "components/motion/MotionController.h"
 #include "components/motor/MotorController.h"
+#include "components/datachanges/DataChanges.h"
 #include "displayapp/screens/ApplicationList.h"
 #include "displayapp/screens/Clock.h"
 #include "displayapp/screens/FirmwareUpdate.h"
@@ -59,6 +61,70 @@ namespace {
   static inline bool in_isr(void) {
     return (SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) != 0;
   }
+
+  constexpr const char* notificationFontPath = "/fonts/notifications.bin";
+
+#if SCREEN_ARENA
+  // The current screen, and the ones kept by the screen cache. All the screens created by LoadApp() must be listed.
+  ScreenArena<1 + ScreenCache::maxScreens,
+              Screens::ApplicationList,
+              Screens::Clock,
+              Screens::Error,
+              Screens::FirmwareValidation,
+              Screens::FirmwareUpdate,
+              Screens::PassKey,
+              Screens::Notifications,
+              Screens::Timer,
+              Screens::Alarm,
+              Screens::QuickSettings,
+              Screens::Settings,
+              Screens::SettingWatchFace,
+              Screens::SettingTimeFormat,
+              Screens::SettingWakeUp,
+              Screens::SettingDisplay,
+              Screens::SettingSteps,
+              Screens::SettingSetDate,
+              Screens::SettingSetTime,
+              Screens::SettingChimes,
+              Screens::SettingShakeThreshold,
+              Screens::SettingBluetooth,
+              Screens::BatteryInfo,
+              Screens::SystemInfo,
+              Screens::FlashLight,
+              Screens::StopWatch,
+              Screens::Twos,
+              Screens::InfiniPaint,
+              Screens::Paddle,
+              Screens::Music,
+              Screens::Navigation,
+              Screens::HeartRate,
+              Screens::Metronome,
+              Screens::Motion,
+              Screens::Steps,
+              Screens::Calculator>
+    screenArena;
+#endif
+
+  template <class T, class... Args> ScreenPtr CreateScreen(Args&&... args) {
+#if SCREEN_ARENA
+    T* screen = screenArena.Create<T>(std::forward<Args>(args)...);
+    if (screen == nullptr) {
+      APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+    }
+    return ScreenPtr(screen);
+#else
+    return ScreenPtr(new T(std::forward<Args>(args)...));
+#endif
+  }
+}
+
+void ScreenDeleter::operator()(Screens::Screen* screen) const {
+#if SCREEN_ARENA
+  screen->~Screen();
+  screenArena.Release(screen);
+#else
+  delete screen;
+#endif
 }
 
 DisplayApp::DisplayApp(Drivers::St7789& lcd,
@@ -76,7 +142,8 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        Pinetime::Controllers::TimerController& timerController,
                        Pinetime::Controllers::AlarmController& alarmController,
                        Pinetime::Controllers::BrightnessController& brightnessController,
-                       Pinetime::Controllers::TouchHandler& touchHandler)
+                       Pinetime::Controllers::TouchHandler& touchHandler,
+                       Pinetime::Controllers::FS& fs)
   : lcd {lcd},
     lvgl {lvgl},
     touchPanel {touchPanel},
@@ -92,7 +159,8 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
     timerController {timerController},
     alarmController {alarmController},
     brightnessController {brightnessController},
-    touchHandler {touchHandler} {
+    touchHandler {touchHandler},
+    notificationFont {fs} {
 }
 
 void DisplayApp::Start(System::BootErrors error) {
@@ -100,10 +168,22 @@ void DisplayApp::Start(System::BootErrors error) {
 
   bootError = error;
 
+  notificationFont.Load(notificationFontPath);
+#if SCREEN_ARENA
+  NRF_LOG_INFO("Screen arena : %d slots of %d bytes", screenArena.nbSlots, screenArena.slotSize);
+#endif
+  Controllers::DataChanges::SetListener(OnDataChanged, this);
+
   if (error == System::BootErrors::TouchController) {
     LoadApp(Apps::Error, DisplayApp::FullRefreshDirections::None);
   } else {
     LoadApp(Apps::Clock, DisplayApp::FullRefreshDirections::None);
+#ifdef DRAW_BUFFER_BENCHMARK
+    drawBufferBenchmark.Start();
+#endif
+#ifdef APP_BENCHMARK
+    appBenchmark.Start();
+#endif
   }
 
   if (pdPASS != xTaskCreate(DisplayApp::Process, "displayapp", 800, this, 0, &taskHandle)) {
@@ -136,10 +216,33 @@ void DisplayApp::Refresh() {
       queueTimeout = portMAX_DELAY;
       break;
     case States::Running:
+      wakeUps++;
       if (!currentScreen->IsRunning()) {
         LoadApp(returnToApp, returnDirection);
       }
-      queueTimeout = lv_task_handler();
+      queueTimeout = frameRateGovernor.Update(lv_task_handler());
+      CheckButtonLatency();
+#ifdef DRAW_BUFFER_BENCHMARK
+      if (drawBufferBenchmark.IsRunning()) {
+        Apps benchmarkApp = drawBufferBenchmark.Run();
+        if (benchmarkApp != Apps::None) {
+          LoadApp(benchmarkApp, DisplayApp::FullRefreshDirections::None);
+        }
+      }
+#endif
+#ifdef APP_BENCHMARK
+      if (appBenchmark.IsRunning()) {
+        Apps benchmarkApp = appBenchmark.Run(*currentScreen);
+        if (benchmarkApp != Apps::None) {
+          LoadApp(benchmarkApp, DisplayApp::FullRefreshDirections::None);
+        }
+        queueTimeout = std::min<TickType_t>(queueTimeout, pdMS_TO_TICKS(10));
+      }
+#endif
+      break;
+    case States::AlwaysOn:
+      // Wake up at the beginning of the next minute
+      queueTimeout = pdMS_TO_TICKS((60 - dateTimeController.Seconds()) * 1000);
       break;
     default:
       queueTimeout = portMAX_DELAY;
@@ -147,7 +250,12 @@ void DisplayApp::Refresh() {
   }
 
   Messages msg;
-  if (xQueueReceive(msgQueue, &msg, queueTimeout)) {
+  if (state == States::Running) {
+    frameRateGovernor.OnSleep();
+  }
+  bool received = xQueueReceive(msgQueue, &msg, queueTimeout);
+  frameRateGovernor.OnWakeUp();
+  if (received) {
     switch (msg) {
       case Messages::DimScreen:
         // Backup brightness is the brightness to return to after dimming or sleeping
@@ -157,17 +265,38 @@ void DisplayApp::Refresh() {
       case Messages::RestoreBrightness:
         brightnessController.Restore();
         break;
-      case Messages::GoToSleep:
+      case Messages::GoToSleep: {
+        ReportWakeUps();
+        // The screen is refreshed by the display task when it wakes up every minute in always on mode
+        Controllers::DataChanges::Subscribe(0);
+        lv_area_t alwaysOnArea;
+        if (settingsController.GetAlwaysOnDisplay() && currentScreen->GetAlwaysOnArea(alwaysOnArea)) {
+          brightnessController.Set(Controllers::BrightnessController::Levels::Low);
+          lvgl.EnterLowPowerMode(alwaysOnArea);
+          alwaysOnStartTime = xTaskGetTickCount();
+          alwaysOnStartBytes = lvgl.GetTotalBytes();
+          PushMessageToSystemTask(Pinetime::System::Messages::OnDisplayTaskAlwaysOn);
+          state = States::AlwaysOn;
+          break;
+        }
         while (brightnessController.Level() != Controllers::BrightnessController::Levels::Off) {
           brightnessController.Lower();
           vTaskDelay(100);
         }
         PushMessageToSystemTask(Pinetime::System::Messages::OnDisplayTaskSleeping);
         state = States::Idle;
-        break;
+      } break;
       case Messages::GoToRunning:
+        if (state == States::AlwaysOn) {
+          lvgl.ExitLowPowerMode();
+          lvgl.SetReducedColorDepth(currentScreen->SupportsReducedColorDepth());
+          ReportAlwaysOn();
+        }
         brightnessController.Restore();
         state = States::Running;
+        SubscribeCurrentScreen();
+        // The data shown may have changed while sleeping
+        currentScreen->OnDataChanged(currentScreen->Subscriptions());
         break;
       case Messages::UpdateTimeOut:
         PushMessageToSystemTask(System::Messages::UpdateTimeOut);
@@ -234,10 +363,13 @@ void DisplayApp::Refresh() {
         }
       } break;
       case Messages::ButtonPushed:
+        buttonPushedTime = xTaskGetTickCount();
         if (!currentScreen->OnButtonPushed()) {
           if (currentApp == Apps::Clock) {
             PushMessageToSystemTask(System::Messages::GoToSleep);
           } else {
+            buttonPushedFrameCount = lvgl.GetFrameCount();
+            measuringButtonLatency = true;
             LoadApp(returnToApp, returnDirection);
             brightnessController.Set(settingsController.GetBrightness());
             brightnessController.Backup();
@@ -278,6 +410,22 @@ void DisplayApp::Refresh() {
       case Messages::Clock:
         LoadApp(Apps::Clock, DisplayApp::FullRefreshDirections::None);
         break;
+      case Messages::DataChanged:
+        // Handled below, the topics may also be published while the task is awake
+        break;
+    }
+  } else if (state == States::AlwaysOn) {
+    // Reduced render path: update the screen and refresh it (only the always on area) right away,
+    // the display task then sleeps until the next minute.
+    currentScreen->OnDataChanged(currentScreen->Subscriptions());
+    lv_task_handler();
+    lvgl.RefreshNow();
+  }
+
+  if (state == States::Running) {
+    Controllers::TopicSet topics = Controllers::DataChanges::TakePending();
+    if (topics != 0) {
+      currentScreen->OnDataChanged(topics);
     }
   }
 
@@ -291,6 +439,72 @@ void DisplayApp::Refresh() {
   }
 }
 
+void DisplayApp::ReportAlwaysOn() {
+  uint32_t seconds = (xTaskGetTickCount() - alwaysOnStartTime) / configTICK_RATE_HZ;
+  uint32_t bytes = lvgl.GetTotalBytes() - alwaysOnStartBytes;
+  if (seconds == 0) {
+    return;
+  }
+  // Waking up the display to show the time every minute redraws the whole screen (in RGB565) each time
+  static constexpr uint32_t fullScreenBytesPerHour = LV_HOR_RES_MAX * LV_VER_RES_MAX * 2 * 60;
+  NRF_LOG_INFO("Always on for %d s : %d bytes, %d bytes/hour (%d bytes/hour with a wake up per minute)",
+               seconds,
+               bytes,
+               static_cast<uint32_t>((static_cast<uint64_t>(bytes) * 3600) / seconds),
+               fullScreenBytesPerHour);
+}
+
+void DisplayApp::ReportWakeUps() {
+  TickType_t elapsed = xTaskGetTickCount() - wakeUpsStartTime;
+  if (elapsed >= configTICK_RATE_HZ) {
+    NRF_LOG_INFO("App %d : %d wake ups/s (%d in %d ms)",
+                 static_cast<uint8_t>(currentApp),
+                 wakeUps * configTICK_RATE_HZ / elapsed,
+                 wakeUps,
+                 elapsed * 1000 / configTICK_RATE_HZ);
+    frameRateGovernor.Report(static_cast<uint8_t>(currentApp));
+  }
+  wakeUps = 0;
+  wakeUpsStartTime = xTaskGetTickCount();
+}
+
+void DisplayApp::CheckButtonLatency() {
+  if (!measuringButtonLatency || lvgl.GetFrameCount() == buttonPushedFrameCount) {
+    return;
+  }
+  measuringButtonLatency = false;
+  if (lvgl.GetFrameCount() != buttonPushedFrameCount + 1) {
+    // The statistics of the first frame were overwritten
+    return;
+  }
+  TickType_t latency = lvgl.GetLastFrameStatistics().firstFlushTick - buttonPushedTime;
+  NRF_LOG_INFO("ButtonPushed -> first pixel : %d ms, app %d %s (screen cache : %d/%d bytes)",
+               latency * 1000 / configTICK_RATE_HZ,
+               static_cast<uint8_t>(currentApp),
+               currentScreenRestored ? "restored" : "created",
+               screenCache.GetMemory(),
+               ScreenCache::budget);
+}
+
+void DisplayApp::SubscribeCurrentScreen() {
+  // Nothing is published while the display sleeps, the topics would only wake the task up
+  Controllers::DataChanges::Subscribe(state == States::Running ? currentScreen->Subscriptions() : 0);
+}
+
+void DisplayApp::OnDataChanged(void* instance) {
+  // Called from the publishing task or interrupt, which must not block: the display task also takes the pending topics
+  // each time it wakes up, and at least once per second
+  auto* app = static_cast<DisplayApp*>(instance);
+  Messages msg = Messages::DataChanged;
+  if (in_isr()) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xQueueSendFromISR(app->msgQueue, &msg, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  } else {
+    xQueueSend(app->msgQueue, &msg, 0);
+  }
+}
+
 void DisplayApp::StartApp(Apps app, DisplayApp::FullRefreshDirections direction) {
   nextApp = app;
   nextDirection = direction;
@@ -303,187 +517,216 @@ void DisplayApp::ReturnApp(Apps app, DisplayApp::FullRefreshDirections direction
 }
 
 void DisplayApp::LoadApp(Apps app, DisplayApp::FullRefreshDirections direction) {
+  if (currentScreen != nullptr) {
+    ReportWakeUps();
+  }
   touchHandler.CancelTap();
-  currentScreen.reset(nullptr);
+  if (currentScreen != nullptr && !screenCache.Retain(currentApp, currentScreen, currentScreenMemory)) {
+    currentScreen.reset(nullptr);
+  }
   SetFullRefresh(direction);
+  uint32_t lvglMemory = ScreenCache::UsedLvglMemory();
+  currentScreenRestored = false;
 
   // default return to launcher
   ReturnApp(Apps::Launcher, FullRefreshDirections::Down, TouchEvents::SwipeDown);
 
   switch (app) {
     case Apps::Launcher:
-      currentScreen = std::make_unique<Screens::ApplicationList>(this, settingsController, batteryController, dateTimeController);
+      currentScreen = screenCache.Restore(Apps::Launcher, currentScreenMemory);
+      currentScreenRestored = currentScreen != nullptr;
+      if (!currentScreenRestored) {
+        currentScreen = CreateScreen<Screens::ApplicationList>(this, settingsController, batteryController, dateTimeController);
+      }
       ReturnApp(Apps::Clock, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::None:
     case Apps::Clock:
-      currentScreen = std::make_unique<Screens::Clock>(this,
-                                                       dateTimeController,
-                                                       batteryController,
-                                                       bleController,
-                                                       notificationManager,
-                                                       settingsController,
-                                                       heartRateController,
-                                                       motionController);
+      currentScreen = screenCache.Restore(Apps::Clock, currentScreenMemory);
+      currentScreenRestored = currentScreen != nullptr;
+      if (currentScreenRestored) {
+        // Done by the clock when it is created: the launcher opens on its first page
+        settingsController.SetAppMenu(0);
+      } else {
+        currentScreen = CreateScreen<Screens::Clock>(this,
+                                                     dateTimeController,
+                                                     batteryController,
+                                                     bleController,
+                                                     notificationManager,
+                                                     settingsController,
+                                                     heartRateController,
+                                                     motionController);
+      }
       break;
 
     case Apps::Error:
-      currentScreen = std::make_unique<Screens::Error>(this, bootError);
+      currentScreen = CreateScreen<Screens::Error>(this, bootError);
       ReturnApp(Apps::Clock, FullRefreshDirections::Down, TouchEvents::None);
       break;
 
     case Apps::FirmwareValidation:
-      currentScreen = std::make_unique<Screens::FirmwareValidation>(this, validator);
+      currentScreen = CreateScreen<Screens::FirmwareValidation>(this, validator);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::FirmwareUpdate:
-      currentScreen = std::make_unique<Screens::FirmwareUpdate>(this, bleController);
+      currentScreen = CreateScreen<Screens::FirmwareUpdate>(this, bleController);
       ReturnApp(Apps::Clock, FullRefreshDirections::Down, TouchEvents::None);
       break;
 
     case Apps::PassKey:
-      currentScreen = std::make_unique<Screens::PassKey>(this, bleController.GetPairingKey());
+      currentScreen = CreateScreen<Screens::PassKey>(this, bleController.GetPairingKey());
       ReturnApp(Apps::Clock, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
 
     case Apps::Notifications:
-      currentScreen = std::make_unique<Screens::Notifications>(this,
-                                                               notificationManager,
-                                                               systemTask->nimble().alertService(),
-                                                               motorController,
-                                                               *systemTask,
-                                                               Screens::Notifications::Modes::Normal);
+      currentScreen = CreateScreen<Screens::Notifications>(this,
+                                                           notificationManager,
+                                                           systemTask->nimble().alertService(),
+                                                           motorController,
+                                                           *systemTask,
+                                                           notificationFont.GetFont(),
+                                                           Screens::Notifications::Modes::Normal);
       ReturnApp(Apps::Clock, FullRefreshDirections::Up, TouchEvents::SwipeUp);
       break;
     case Apps::NotificationsPreview:
-      currentScreen = std::make_unique<Screens::Notifications>(this,
-                                                               notificationManager,
-                                                               systemTask->nimble().alertService(),
-                                                               motorController,
-                                                               *systemTask,
-                                                               Screens::Notifications::Modes::Preview);
+      currentScreen = CreateScreen<Screens::Notifications>(this,
+                                                           notificationManager,
+                                                           systemTask->nimble().alertService(),
+                                                           motorController,
+                                                           *systemTask,
+                                                           notificationFont.GetFont(),
+                                                           Screens::Notifications::Modes::Preview);
       ReturnApp(Apps::Clock, FullRefreshDirections::Up, TouchEvents::SwipeUp);
       break;
     case Apps::Timer:
-      currentScreen = std::make_unique<Screens::Timer>(this, timerController);
+      currentScreen = CreateScreen<Screens::Timer>(this, timerController);
       break;
     case Apps::Alarm:
-      currentScreen = std::make_unique<Screens::Alarm>(this, alarmController, settingsController, *systemTask);
+      currentScreen = CreateScreen<Screens::Alarm>(this, alarmController, settingsController, *systemTask);
       break;
 
     // Settings
     case Apps::QuickSettings:
-      currentScreen = std::make_unique<Screens::QuickSettings>(this,
-                                                               batteryController,
-                                                               dateTimeController,
-                                                               brightnessController,
-                                                               motorController,
-                                                               settingsController);
+      currentScreen = CreateScreen<Screens::QuickSettings>(this,
+                                                           batteryController,
+                                                           dateTimeController,
+                                                           brightnessController,
+                                                           motorController,
+                                                           settingsController);
       ReturnApp(Apps::Clock, FullRefreshDirections::LeftAnim, TouchEvents::SwipeLeft);
       break;
     case Apps::Settings:
-      currentScreen = std::make_unique<Screens::Settings>(this, settingsController);
+      currentScreen = CreateScreen<Screens::Settings>(this, settingsController);
       ReturnApp(Apps::QuickSettings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingWatchFace:
-      currentScreen = std::make_unique<Screens::SettingWatchFace>(this, settingsController);
+      currentScreen = CreateScreen<Screens::SettingWatchFace>(this, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingTimeFormat:
-      currentScreen = std::make_unique<Screens::SettingTimeFormat>(this, settingsController);
+      currentScreen = CreateScreen<Screens::SettingTimeFormat>(this, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingWakeUp:
-      currentScreen = std::make_unique<Screens::SettingWakeUp>(this, settingsController);
+      currentScreen = CreateScreen<Screens::SettingWakeUp>(this, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingDisplay:
-      currentScreen = std::make_unique<Screens::SettingDisplay>(this, settingsController);
+      currentScreen = CreateScreen<Screens::SettingDisplay>(this, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingSteps:
-      currentScreen = std::make_unique<Screens::SettingSteps>(this, settingsController);
+      currentScreen = CreateScreen<Screens::SettingSteps>(this, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingSetDate:
-      currentScreen = std::make_unique<Screens::SettingSetDate>(this, dateTimeController);
+      currentScreen = CreateScreen<Screens::SettingSetDate>(this, dateTimeController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingSetTime:
-      currentScreen = std::make_unique<Screens::SettingSetTime>(this, dateTimeController, settingsController);
+      currentScreen = CreateScreen<Screens::SettingSetTime>(this, dateTimeController, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingChimes:
-      currentScreen = std::make_unique<Screens::SettingChimes>(this, settingsController);
+      currentScreen = CreateScreen<Screens::SettingChimes>(this, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingShakeThreshold:
-      currentScreen = std::make_unique<Screens::SettingShakeThreshold>(this, settingsController, motionController, *systemTask);
+      currentScreen = CreateScreen<Screens::SettingShakeThreshold>(this, settingsController, motionController, *systemTask);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SettingBluetooth:
-      currentScreen = std::make_unique<Screens::SettingBluetooth>(this, settingsController);
+      currentScreen = CreateScreen<Screens::SettingBluetooth>(this, settingsController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::BatteryInfo:
-      currentScreen = std::make_unique<Screens::BatteryInfo>(this, batteryController);
+      currentScreen = CreateScreen<Screens::BatteryInfo>(this, batteryController);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::SysInfo:
-      currentScreen = std::make_unique<Screens::SystemInfo>(this,
-                                                            dateTimeController,
-                                                            batteryController,
-                                                            brightnessController,
-                                                            bleController,
-                                                            watchdog,
-                                                            motionController,
-                                                            touchPanel);
+      currentScreen = CreateScreen<Screens::SystemInfo>(this,
+                                                        dateTimeController,
+                                                        batteryController,
+                                                        brightnessController,
+                                                        bleController,
+                                                        watchdog,
+                                                        motionController,
+                                                        touchPanel);
       ReturnApp(Apps::Settings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::FlashLight:
-      currentScreen = std::make_unique<Screens::FlashLight>(this, *systemTask, brightnessController);
+      currentScreen = CreateScreen<Screens::FlashLight>(this, *systemTask, brightnessController);
       ReturnApp(Apps::QuickSettings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::FlashLightRed:
-      currentScreen = std::make_unique<Screens::FlashLight>(this, *systemTask, brightnessController, LV_COLOR_RED);
+      currentScreen = CreateScreen<Screens::FlashLight>(this, *systemTask, brightnessController, LV_COLOR_RED);
       ReturnApp(Apps::QuickSettings, FullRefreshDirections::Down, TouchEvents::SwipeDown);
       break;
     case Apps::StopWatch:
-      currentScreen = std::make_unique<Screens::StopWatch>(this, *systemTask);
+      currentScreen = CreateScreen<Screens::StopWatch>(this, *systemTask);
       break;
     case Apps::Twos:
-      currentScreen = std::make_unique<Screens::Twos>(this);
+      currentScreen = CreateScreen<Screens::Twos>(this);
       break;
     case Apps::Paint:
-      currentScreen = std::make_unique<Screens::InfiniPaint>(this, lvgl, motorController);
+      currentScreen = CreateScreen<Screens::InfiniPaint>(this, lvgl, motorController);
       break;
     case Apps::Paddle:
-      currentScreen = std::make_unique<Screens::Paddle>(this, lvgl);
+      currentScreen = CreateScreen<Screens::Paddle>(this, lvgl);
       break;
     case Apps::Music:
-      currentScreen = std::make_unique<Screens::Music>(this, systemTask->nimble().music());
+      currentScreen = CreateScreen<Screens::Music>(this, systemTask->nimble().music());
       break;
     case Apps::Navigation:
-      currentScreen = std::make_unique<Screens::Navigation>(this, systemTask->nimble().navigation());
+      currentScreen = CreateScreen<Screens::Navigation>(this, systemTask->nimble().navigation());
       break;
     case Apps::HeartRate:
-      currentScreen = std::make_unique<Screens::HeartRate>(this, heartRateController, *systemTask);
+      currentScreen = CreateScreen<Screens::HeartRate>(this, heartRateController, *systemTask);
       break;
     case Apps::Metronome:
-      currentScreen = std::make_unique<Screens::Metronome>(this, motorController, *systemTask);
+      currentScreen = CreateScreen<Screens::Metronome>(this, motorController, *systemTask);
       ReturnApp(Apps::Launcher, FullRefreshDirections::Down, TouchEvents::None);
       break;
     case Apps::Motion:
-      currentScreen = std::make_unique<Screens::Motion>(this, motionController);
+      currentScreen = CreateScreen<Screens::Motion>(this, motionController);
       break;
     case Apps::Steps:
-      currentScreen = std::make_unique<Screens::Steps>(this, motionController, settingsController);
+      currentScreen = CreateScreen<Screens::Steps>(this, motionController, settingsController);
       break;
     case Apps::Calculator:
-      currentScreen = std::make_unique<Screens::Calculator>(this, motorController);
+      currentScreen = CreateScreen<Screens::Calculator>(this, motorController);
       break;
   }
+  if (currentScreenRestored) {
+    // The data shown may have changed while another app was shown
+    currentScreen->OnDataChanged(currentScreen->Subscriptions());
+  } else {
+    currentScreenMemory = ScreenCache::UsedLvglMemory() - lvglMemory;
+  }
+  lvgl.SetReducedColorDepth(currentScreen->SupportsReducedColorDepth());
   currentApp = app;
+  SubscribeCurrentScreen();
+  frameRateGovernor.SetPolicy(currentScreen->GetFrameRatePolicy(), currentScreen->Subscriptions() != 0);
 }
 
 void DisplayApp::PushMessage(Messages msg) {
@@ -7,6 +7,11 @@
 #include <systemtask/Messages.h>
 #include "displayapp/Apps.h"
 #include "displayapp/LittleVgl.h"
+#include "displayapp/FsFont.h"
+#include "displayapp/DrawBufferBenchmark.h"
+#include "displayapp/AppBenchmark.h"
+#include "displayapp/FrameRateGovernor.h"
+#include "displayapp/ScreenCache.h"
 #include "displayapp/TouchEvents.h"
 #include "components/brightness/BrightnessController.h"
 #include "components/motor/MotorController.h"
@@ -44,7 +49,7 @@ namespace Pinetime {
   namespace Applications {
     class DisplayApp {
     public:
-      enum class States { Idle, Running };
+      enum class States { Idle, Running, AlwaysOn };
       enum class FullRefreshDirections { None, Up, Down, Left, Right, LeftAnim, RightAnim };
 
       DisplayApp(Drivers::St7789& lcd,
@@ -62,7 +67,8 @@ namespace Pinetime {
                  Pinetime::Controllers::TimerController& timerController,
                  Pinetime::Controllers::AlarmController& alarmController,
                  Pinetime::Controllers::BrightnessController& brightnessController,
-                 Pinetime::Controllers::TouchHandler& touchHandler);
+                 Pinetime::Controllers::TouchHandler& touchHandler,
+                 Pinetime::Controllers::FS& fs);
       void Start(System::BootErrors error);
       void PushMessage(Display::Messages msg);
 
@@ -93,15 +99,49 @@ namespace Pinetime {
 
       Pinetime::Controllers::FirmwareValidator validator;
 
+      // Font of the notification texts, used instead of the default font when it is found in the filesystem
+      Components::FsFont notificationFont;
+
+#ifdef DRAW_BUFFER_BENCHMARK
+      DrawBufferBenchmark drawBufferBenchmark {lvgl};
+#endif
+#ifdef APP_BENCHMARK
+      AppBenchmark appBenchmark {lvgl};
+#endif
+
       TaskHandle_t taskHandle;
 
       States state = States::Running;
       QueueHandle_t msgQueue;
 
+      TickType_t alwaysOnStartTime = 0;
+      uint32_t alwaysOnStartBytes = 0;
+      void ReportAlwaysOn();
+
+      FrameRateGovernor frameRateGovernor {lvgl};
+
+      // Wake ups of the display task while the current app is shown
+      TickType_t wakeUpsStartTime = 0;
+      uint32_t wakeUps = 0;
+      void ReportWakeUps();
+
+      static void OnDataChanged(void* instance);
+      void SubscribeCurrentScreen();
+
       static constexpr uint8_t queueSize = 10;
       static constexpr uint8_t itemSize = 1;
 
-      std::unique_ptr<Screens::Screen> currentScreen;
+      ScreenPtr currentScreen;
+      // LVGL memory used by the current screen when it was created
+      uint32_t currentScreenMemory = 0;
+      bool currentScreenRestored = false;
+      ScreenCache screenCache;
+
+      // Time from ButtonPushed to the first band of the screen it loads being sent to the display
+      TickType_t buttonPushedTime = 0;
+      uint32_t buttonPushedFrameCount = 0;
+      bool measuringButtonLatency = false;
+      void CheckButtonLatency();
 
       Apps currentApp = Apps::None;
       Apps returnToApp = Apps::None;
@@ -24,7 +24,8 @@ DisplayApp::DisplayApp(Drivers::St7789& lcd,
                        Pinetime::Controllers::TimerController& timerController,
                        Pinetime::Controllers::AlarmController& alarmController,
                        Pinetime::Controllers::BrightnessController& brightnessController,
-                       Pinetime::Controllers::TouchHandler& touchHandler)
+                       Pinetime::Controllers::TouchHandler& touchHandler,
+                       Pinetime::Controllers::FS& fs)
   : lcd {lcd}, bleController {bleController} {
 }
 
@@ -101,9 +102,14 @@ void DisplayApp::DisplayLogo(uint16_t color) {
 
 void DisplayApp::DisplayOtaProgress(uint8_t percent, uint16_t color) {
   const uint8_t barHeight = 20;
-  std::fill(displayBuffer, displayBuffer + (displayWidth * bytesPerPixel), color);
+  // The last line drawn may still be sent from the buffer
+  ulTaskNotifyTake(pdTRUE, 500);
+  // The colors are swapped: they are sent most significant byte first
+  std::fill_n(reinterpret_cast<uint16_t*>(displayBuffer), displayWidth, color);
   for (int i = 0; i < barHeight; i++) {
-    ulTaskNotifyTake(pdTRUE, 500);
+    if (i > 0) {
+      ulTaskNotifyTake(pdTRUE, 500);
+    }
     uint16_t barWidth = std::min(static_cast<float>(percent) * 2.4f, static_cast<float>(displayWidth));
     lcd.DrawBuffer(0, displayWidth - barHeight + i, barWidth, 1, reinterpret_cast<const uint8_t*>(displayBuffer), barWidth * bytesPerPixel);
   }
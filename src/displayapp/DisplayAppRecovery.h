@@ -35,6 +35,7 @@ namespace Pinetime {
     class TimerController;
     class AlarmController;
     class BrightnessController;
+    class FS;
   }
 
   namespace System {
@@ -59,7 +60,8 @@ namespace Pinetime {
                  Pinetime::Controllers::TimerController& timerController,
                  Pinetime::Controllers::AlarmController& alarmController,
                  Pinetime::Controllers::BrightnessController& brightnessController,
-                 Pinetime::Controllers::TouchHandler& touchHandler);
+                 Pinetime::Controllers::TouchHandler& touchHandler,
+                 Pinetime::Controllers::FS& fs);
       void Start();
       void Start(Pinetime::System::BootErrors) {
         Start();
@@ -91,7 +93,7 @@ namespace Pinetime {
       static constexpr uint16_t colorRed = 0xff00;
       static constexpr uint16_t colorRedSwapped = 0x00ff;
       static constexpr uint16_t colorBlack = 0x0000;
-      uint8_t displayBuffer[displayWidth * bytesPerPixel];
+      alignas(uint16_t) uint8_t displayBuffer[displayWidth * bytesPerPixel];
     };
   }
 }
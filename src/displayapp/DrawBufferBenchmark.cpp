@@ -0,0 +1,120 @@
+#include "displayapp/DrawBufferBenchmark.h"
+#include <FreeRTOS.h>
+#include <libraries/log/nrf_log.h>
+#include "displayapp/LvglMemory.h"
+
+using namespace Pinetime::Applications;
+
+DrawBufferBenchmark::DrawBufferBenchmark(Components::LittleVgl& lvgl) : lvgl {lvgl} {
+}
+
+void DrawBufferBenchmark::Start() {
+  nbResults = 0;
+  heightIndex = 0;
+  appIndex = 0;
+  waitingForFrame = false;
+  running = true;
+  NextHeight();
+}
+
+void DrawBufferBenchmark::NextHeight() {
+  while (heightIndex < candidateLines.size() && candidateLines[heightIndex] > Components::LittleVgl::maxDrawBufferLines) {
+    heightIndex++;
+  }
+  if (heightIndex >= candidateLines.size()) {
+    return;
+  }
+
+  lvgl.SetDrawBufferLines(candidateLines[heightIndex]);
+  auto& result = results[nbResults];
+  result = {};
+  result.nbLines = candidateLines[heightIndex];
+  result.minFreeHeap = UINT32_MAX;
+  result.minFreeLvglMemory = UINT32_MAX;
+}
+
+Apps DrawBufferBenchmark::Run() {
+  if (!running) {
+    return Apps::None;
+  }
+
+  if (!waitingForFrame) {
+    // Loading an app triggers a full refresh: the next frame redraws the whole screen
+    waitingForFrame = true;
+    lastFrameCount = lvgl.GetFrameCount();
+    return apps[appIndex];
+  }
+
+  if (lvgl.GetFrameCount() == lastFrameCount) {
+    return Apps::None;
+  }
+  waitingForFrame = false;
+
+  const auto& frame = lvgl.GetLastFrameStatistics();
+  auto lvglMemory = Components::LvglMemory::GetStatistics();
+
+  auto& result = results[nbResults];
+  result.flushes += frame.flushes;
+  result.refreshTimeMs += frame.refreshTimeMs;
+  if (frame.refreshTimeMs > result.maxRefreshTimeMs) {
+    result.maxRefreshTimeMs = frame.refreshTimeMs;
+  }
+  if (xPortGetFreeHeapSize() < result.minFreeHeap) {
+    result.minFreeHeap = xPortGetFreeHeapSize();
+  }
+  if (lvglMemory.free < result.minFreeLvglMemory) {
+    result.minFreeLvglMemory = lvglMemory.free;
+  }
+
+  appIndex++;
+  if (appIndex < apps.size()) {
+    return Apps::None;
+  }
+
+  appIndex = 0;
+  nbResults++;
+  heightIndex++;
+  NextHeight();
+  if (heightIndex >= candidateLines.size()) {
+    Report();
+    running = false;
+    return Apps::Clock;
+  }
+  return Apps::None;
+}
+
+void DrawBufferBenchmark::Report() {
+  uint32_t bestRefreshTimeMs = UINT32_MAX;
+  for (uint8_t i = 0; i < nbResults; i++) {
+    if (results[i].refreshTimeMs < bestRefreshTimeMs) {
+      bestRefreshTimeMs = results[i].refreshTimeMs;
+    }
+  }
+
+  NRF_LOG_INFO("Draw buffer benchmark (%d apps)", apps.size());
+  selectedLines = Components::LittleVgl::maxDrawBufferLines;
+  bool selected = false;
+  for (uint8_t i = 0; i < nbResults; i++) {
+    const auto& result = results[i];
+    // NRF_LOG_INFO() takes at most 6 arguments
+    NRF_LOG_INFO("lines %d : %d bytes, %d flushes, %d ms (max %d ms)",
+                 result.nbLines,
+                 Components::LittleVgl::DrawBufferSize(result.nbLines),
+                 result.flushes,
+                 result.refreshTimeMs,
+                 result.maxRefreshTimeMs);
+    NRF_LOG_INFO("lines %d : free heap %d, free lvgl %d", result.nbLines, result.minFreeHeap, result.minFreeLvglMemory);
+    // Results are sorted by increasing height
+    if (!selected && result.refreshTimeMs * 100 <= bestRefreshTimeMs * (100 + tolerancePercent)) {
+      selectedLines = result.nbLines;
+      selected = true;
+    }
+  }
+
+  NRF_LOG_INFO("Selected %d lines (build with -DLVGL_DRAW_BUFFER_LINES=%d to save %d bytes of RAM)",
+               selectedLines,
+               selectedLines,
+               Components::LittleVgl::DrawBufferSize(Components::LittleVgl::maxDrawBufferLines) -
+                 Components::LittleVgl::DrawBufferSize(selectedLines));
+  lvgl.SetDrawBufferLines(selectedLines);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "displayapp/Apps.h"
+#include "displayapp/LittleVgl.h"
+
+namespace Pinetime {
+  namespace Applications {
+    // Sweeps the height of the LVGL draw buffers over a set of built-in apps and records, for each height,
+    // the number of flushes and the time needed to redraw every app, and the heap headroom left.
+    // Once the sweep is over, the smallest height whose redraw time is close to the best one is kept.
+    class DrawBufferBenchmark {
+    public:
+      struct Result {
+        uint8_t nbLines;
+        uint32_t flushes;
+        uint32_t refreshTimeMs;
+        uint32_t maxRefreshTimeMs;
+        uint32_t minFreeHeap;
+        uint32_t minFreeLvglMemory;
+      };
+
+      explicit DrawBufferBenchmark(Components::LittleVgl& lvgl);
+
+      void Start();
+
+      bool IsRunning() const {
+        return running;
+      }
+
+      // Called from the display task after each call to lv_task_handler().
+      // Returns the app to load next, or Apps::None to keep the current one.
+      Apps Run();
+
+      uint8_t GetSelectedLines() const {
+        return selectedLines;
+      }
+
+    private:
+      void NextHeight();
+      void Report();
+
+      static constexpr std::array<uint8_t, 10> candidateLines {1, 2, 4, 6, 8, 10, 12, 16, 20, 24};
+      static constexpr std::array<Apps, 12> apps {Apps::Clock,
+                                                 Apps::Launcher,
+                                                 Apps::QuickSettings,
+                                                 Apps::Settings,
+                                                 Apps::SysInfo,
+                                                 Apps::BatteryInfo,
+                                                 Apps::StopWatch,
+                                                 Apps::Timer,
+                                                 Apps::Steps,
+                                                 Apps::Music,
+                                                 Apps::Navigation,
+                                                 Apps::Twos};
+      // Keep the smallest height whose redraw time is within this margin of the fastest one
+      static constexpr uint8_t tolerancePercent = 5;
+
+      Components::LittleVgl& lvgl;
+      std::array<Result, candidateLines.size()> results {};
+      uint8_t nbResults = 0;
+      uint8_t heightIndex = 0;
+      uint8_t appIndex = 0;
+      uint32_t lastFrameCount = 0;
+      bool waitingForFrame = false;
+      bool running = false;
+      uint8_t selectedLines = Components::LittleVgl::maxDrawBufferLines;
+    };
+  }
+}
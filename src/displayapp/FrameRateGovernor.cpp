@@ -0,0 +1,95 @@
+#include "displayapp/FrameRateGovernor.h"
+#include <task.h>
+#include <algorithm>
+#include <libraries/log/nrf_log.h>
+
+using namespace Pinetime::Applications;
+
+namespace {
+  constexpr const char* modeNames[] = {"active", "static", "idle"};
+}
+
+FrameRateGovernor::FrameRateGovernor(Components::LittleVgl& lvgl) : lvgl {lvgl} {
+}
+
+void FrameRateGovernor::SetPolicy(const Screens::FrameRatePolicy& policy, bool eventDriven) {
+  this->policy = policy;
+  this->eventDriven = eventDriven;
+  lvgl.SetRefreshPeriod(policy.activePeriodMs);
+  // A new screen is always rendered
+  mode = Modes::Active;
+  lastActivityTime = xTaskGetTickCount();
+  lastFrameCount = lvgl.GetFrameCount();
+}
+
+TickType_t FrameRateGovernor::Update(TickType_t lvglTimeout) {
+  TickType_t now = xTaskGetTickCount();
+  uint32_t frameCount = lvgl.GetFrameCount();
+  auto& current = statistics[static_cast<uint8_t>(mode)];
+  if (frameCount != lastFrameCount) {
+    current.frames += frameCount - lastFrameCount;
+    lastFrameCount = frameCount;
+    lastActivityTime = now;
+    mode = Modes::Active;
+  } else {
+    current.skipped++;
+    if (!lvgl.IsIdle()) {
+      lastActivityTime = now;
+      mode = Modes::Active;
+    } else if (now - lastActivityTime >= pdMS_TO_TICKS(policy.holdTimeMs)) {
+      mode = eventDriven ? Modes::Idle : Modes::Static;
+    }
+  }
+
+  switch (mode) {
+    case Modes::Static:
+      return std::max<TickType_t>(lvglTimeout, pdMS_TO_TICKS(policy.staticPeriodMs));
+    case Modes::Idle:
+      return maxIdleTime;
+    default:
+      return lvglTimeout;
+  }
+}
+
+void FrameRateGovernor::Account(bool busy) {
+  uint32_t cycleCount = DWT->CYCCNT;
+  auto& current = statistics[static_cast<uint8_t>(mode)];
+  uint32_t elapsed = cycleCount - lastCycleCount;
+  current.totalCycles += elapsed;
+  if (busy) {
+    current.busyCycles += elapsed;
+  }
+  lastCycleCount = cycleCount;
+}
+
+void FrameRateGovernor::OnSleep() {
+  Account(true);
+  sleeping = true;
+}
+
+void FrameRateGovernor::OnWakeUp() {
+  if (sleeping) {
+    Account(false);
+    sleeping = false;
+  } else {
+    // The task did not sleep through OnSleep() (display off): do not count this time
+    lastCycleCount = DWT->CYCCNT;
+  }
+}
+
+void FrameRateGovernor::Report(uint8_t app) {
+  for (uint8_t i = 0; i < nbModes; i++) {
+    const auto& modeStatistics = statistics[i];
+    // The frames are counted even if the cycle counter is not running
+    auto cpuPercent =
+      modeStatistics.totalCycles == 0 ? 0 : static_cast<uint32_t>(modeStatistics.busyCycles * 100 / modeStatistics.totalCycles);
+    NRF_LOG_INFO("App %d %s : %d ms, %d frames, %d skipped, CPU %d%%",
+                 app,
+                 modeNames[i],
+                 static_cast<uint32_t>(modeStatistics.totalCycles / (SystemCoreClock / 1000)),
+                 modeStatistics.frames,
+                 modeStatistics.skipped,
+                 cpuPercent);
+  }
+  statistics = {};
+}
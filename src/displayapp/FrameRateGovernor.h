@@ -0,0 +1,66 @@
+#pragma once
+
+#include <FreeRTOS.h>
+#include <array>
+#include <cstdint>
+#include "displayapp/LittleVgl.h"
+#include "displayapp/screens/Screen.h"
+
+namespace Pinetime {
+  namespace Applications {
+    // Chooses how long the display task sleeps between two runs of the LVGL tasks, in 3 modes:
+    //  - Active: LVGL animates, scrolls, is touched or rendered a frame less than the hold time ago. The task follows the
+    //    LVGL tasks, and the display is refreshed at the active period of the screen.
+    //  - Static: nothing changed during the hold time. The task, and so the refresh tasks of the screen, only run at the
+    //    static period of the screen.
+    //  - Idle: static, for a screen refreshed by the topics it subscribed to. The task sleeps until an event wakes it up.
+    // Any message (touch, button, data change) wakes the task up right away, whatever the mode.
+    // The frames rendered, the wake ups that rendered nothing and the CPU time of the task are counted per mode.
+    class FrameRateGovernor {
+    public:
+      enum class Modes : uint8_t { Active, Static, Idle };
+
+      explicit FrameRateGovernor(Components::LittleVgl& lvgl);
+
+      // Called when a screen is loaded
+      void SetPolicy(const Screens::FrameRatePolicy& policy, bool eventDriven);
+
+      // Called after lv_task_handler(), with the time until the next LVGL task. Returns how long the task may sleep.
+      TickType_t Update(TickType_t lvglTimeout);
+
+      // Called before and after the display task sleeps, to measure its CPU time
+      void OnSleep();
+      void OnWakeUp();
+
+      // Logs and resets the statistics
+      void Report(uint8_t app);
+
+      Modes Mode() const {
+        return mode;
+      }
+
+    private:
+      struct Statistics {
+        uint32_t frames;
+        uint32_t skipped;
+        uint64_t busyCycles;
+        uint64_t totalCycles;
+      };
+      static constexpr uint8_t nbModes = 3;
+      // Longest sleep in idle mode, to let the LVGL housekeeping tasks run
+      static constexpr TickType_t maxIdleTime = pdMS_TO_TICKS(1000);
+
+      void Account(bool busy);
+
+      Components::LittleVgl& lvgl;
+      Screens::FrameRatePolicy policy {};
+      bool eventDriven = false;
+      Modes mode = Modes::Active;
+      TickType_t lastActivityTime = 0;
+      uint32_t lastFrameCount = 0;
+      uint32_t lastCycleCount = 0;
+      bool sleeping = false;
+      std::array<Statistics, nbModes> statistics {};
+    };
+  }
+}
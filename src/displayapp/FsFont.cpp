@@ -0,0 +1,346 @@
+#include "displayapp/FsFont.h"
+#include <algorithm>
+#include "displayapp/GlyphLookupCache.h"
+#include <cstring>
+#include <libraries/log/nrf_log.h>
+
+using namespace Pinetime::Components;
+
+GlyphCache FsFont::glyphCache;
+
+namespace {
+  // Size of the section header (length and label)
+  constexpr uint32_t sectionHeaderSize = 8;
+  // Fields of the "head" section used here (the font header of the LVGL binary format)
+  constexpr size_t fontHeaderSize = 36;
+  // Size of the fields of a glyph record, before its bitmap
+  constexpr uint8_t maxGlyphHeaderSize = 8;
+
+  template <typename T>
+  T Get(const uint8_t* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+  }
+
+  // Reads bit fields, most significant bit first
+  class BitReader {
+  public:
+    explicit BitReader(const uint8_t* data) : data {data} {
+    }
+
+    uint32_t Read(uint8_t nbBits) {
+      uint32_t value = 0;
+      for (uint8_t i = 0; i < nbBits; i++, position++) {
+        value = (value << 1) | ((data[position / 8] >> (7 - position % 8)) & 1);
+      }
+      return value;
+    }
+
+    int32_t ReadSigned(uint8_t nbBits) {
+      uint32_t value = Read(nbBits);
+      if (nbBits > 0 && (value & (1 << (nbBits - 1))) != 0) {
+        value |= ~0U << nbBits;
+      }
+      return static_cast<int32_t>(value);
+    }
+
+  private:
+    const uint8_t* data;
+    size_t position = 0;
+  };
+}
+
+FsFont::FsFont(Controllers::FS& fs) : fs {fs} {
+}
+
+FsFont::~FsFont() {
+  Unload();
+}
+
+bool FsFont::Load(const char* path) {
+  Unload();
+  if (fs.FileOpen(&file, path, LFS_O_RDONLY) != LFS_ERR_OK) {
+    return false;
+  }
+  fileOpened = true;
+
+  uint32_t headLength;
+  uint8_t header[fontHeaderSize];
+  if (!ReadSection(0, "head", headLength) || headLength < sectionHeaderSize + fontHeaderSize ||
+      !ReadAt(sectionHeaderSize, header, sizeof(header))) {
+    NRF_LOG_INFO("[FsFont] %s : invalid header", path);
+    Unload();
+    return false;
+  }
+
+  auto ascent = Get<uint16_t>(&header[8]);
+  auto descent = Get<int16_t>(&header[10]);
+  defaultAdvanceWidth = Get<uint16_t>(&header[22]);
+  dsc.kern_scale = Get<uint16_t>(&header[24]);
+  bool longOffsets = header[26] != 0;
+  integerAdvanceWidth = header[28] == 0;
+  dsc.bpp = header[29];
+  xyBits = header[30];
+  whBits = header[31];
+  advanceWidthBits = header[32];
+  uint8_t compression = header[33];
+
+  if (compression != 0 || longOffsets || (advanceWidthBits + 2 * xyBits + 2 * whBits) > maxGlyphHeaderSize * 8) {
+    // Compressed bitmaps would have to be decompressed from the start of the glyph on each access, and fonts whose
+    // glyph table does not fit in 64KB are too large for the cache anyway.
+    NRF_LOG_INFO("[FsFont] %s : unsupported format", path);
+    Unload();
+    return false;
+  }
+
+  uint32_t cmapStart = headLength;
+  uint32_t cmapLength;
+  uint32_t locaLength;
+  uint32_t glyfLength;
+  if (!ReadSection(cmapStart, "cmap", cmapLength) || !ReadCmaps(cmapStart)) {
+    NRF_LOG_INFO("[FsFont] %s : invalid character maps", path);
+    Unload();
+    return false;
+  }
+  uint32_t locaStart = cmapStart + cmapLength;
+  if (!ReadSection(locaStart, "loca", locaLength) || !ReadSection(locaStart + locaLength, "glyf", glyfLength) ||
+      !ReadGlyphs(locaStart, locaStart + locaLength)) {
+    NRF_LOG_INFO("[FsFont] %s : invalid glyphs", path);
+    Unload();
+    return false;
+  }
+
+  dsc.bitmap_format = LV_FONT_FMT_TXT_PLAIN;
+  font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+  font.get_glyph_bitmap = GetGlyphBitmap;
+  font.line_height = ascent - descent;
+  font.base_line = -descent;
+  font.subpx = LV_FONT_SUBPX_NONE;
+  font.dsc = &dsc;
+  font.user_data = this;
+  GlyphLookupCache::Install(font);
+  loaded = true;
+  NRF_LOG_INFO("[FsFont] %s : %d glyphs", path, nbGlyphs);
+  return true;
+}
+
+void FsFont::Unload() {
+  glyphCache.Remove(this);
+  GlyphLookupCache::Remove(&font);
+
+  if (dsc.cmaps != nullptr) {
+    for (uint16_t i = 0; i < dsc.cmap_num; i++) {
+      const lv_font_fmt_txt_cmap_t& cmap = dsc.cmaps[i];
+      // The glyph ids of the sparse maps are stored in the same block as their unicode list
+      if (cmap.unicode_list != nullptr) {
+        lv_mem_free(cmap.unicode_list);
+      } else if (cmap.glyph_id_ofs_list != nullptr) {
+        lv_mem_free(cmap.glyph_id_ofs_list);
+      }
+    }
+    lv_mem_free(dsc.cmaps);
+  }
+  if (dsc.glyph_dsc != nullptr) {
+    lv_mem_free(dsc.glyph_dsc);
+  }
+  dsc = {};
+  font = {};
+  nbGlyphs = 0;
+
+  if (fileOpened) {
+    fs.FileClose(&file);
+    fileOpened = false;
+  }
+  loaded = false;
+}
+
+bool FsFont::ReadAt(uint32_t position, void* buffer, size_t size) {
+  if (fs.FileSeek(&file, position) < 0) {
+    return false;
+  }
+  return fs.FileRead(&file, static_cast<uint8_t*>(buffer), size) == static_cast<int>(size);
+}
+
+bool FsFont::ReadSection(uint32_t start, const char* label, uint32_t& length) {
+  uint8_t header[sectionHeaderSize];
+  if (!ReadAt(start, header, sizeof(header))) {
+    return false;
+  }
+  length = Get<uint32_t>(&header[0]);
+  return length >= sectionHeaderSize && std::memcmp(&header[4], label, 4) == 0;
+}
+
+bool FsFont::ReadCmaps(uint32_t start) {
+  uint8_t buffer[4];
+  if (!ReadAt(start + sectionHeaderSize, buffer, sizeof(buffer))) {
+    return false;
+  }
+  uint32_t count = Get<uint32_t>(buffer);
+  if (count == 0 || count >= (1 << 9)) {
+    return false;
+  }
+
+  auto* cmaps = static_cast<lv_font_fmt_txt_cmap_t*>(lv_mem_alloc(count * sizeof(lv_font_fmt_txt_cmap_t)));
+  if (cmaps == nullptr) {
+    return false;
+  }
+  std::memset(cmaps, 0, count * sizeof(lv_font_fmt_txt_cmap_t));
+  dsc.cmaps = cmaps;
+  dsc.cmap_num = count;
+
+  for (uint32_t i = 0; i < count; i++) {
+    uint8_t record[16];
+    if (!ReadAt(start + sectionHeaderSize + 4 + i * sizeof(record), record, sizeof(record))) {
+      return false;
+    }
+    lv_font_fmt_txt_cmap_t& cmap = cmaps[i];
+    uint32_t dataOffset = Get<uint32_t>(&record[0]);
+    cmap.range_start = Get<uint32_t>(&record[4]);
+    cmap.range_length = Get<uint16_t>(&record[8]);
+    cmap.glyph_id_start = Get<uint16_t>(&record[10]);
+    cmap.list_length = Get<uint16_t>(&record[12]);
+    cmap.type = static_cast<lv_font_fmt_txt_cmap_type_t>(record[14]);
+
+    size_t listSize;
+    switch (cmap.type) {
+      case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+        listSize = cmap.list_length;
+        break;
+      case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
+        listSize = cmap.list_length * 2 * sizeof(uint16_t);
+        break;
+      case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+        listSize = cmap.list_length * sizeof(uint16_t);
+        break;
+      case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+        listSize = 0;
+        break;
+      default:
+        return false;
+    }
+    if (listSize == 0) {
+      continue;
+    }
+
+    auto* list = static_cast<uint8_t*>(lv_mem_alloc(listSize));
+    if (list == nullptr) {
+      return false;
+    }
+    if (cmap.type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL) {
+      cmap.glyph_id_ofs_list = list;
+    } else {
+      cmap.unicode_list = reinterpret_cast<uint16_t*>(list);
+      if (cmap.type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) {
+        cmap.glyph_id_ofs_list = list + cmap.list_length * sizeof(uint16_t);
+      }
+    }
+    if (!ReadAt(start + dataOffset, list, listSize)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FsFont::ReadGlyphs(uint32_t locaStart, uint32_t glyfStart) {
+  uint8_t buffer[4];
+  if (!ReadAt(locaStart + sectionHeaderSize, buffer, sizeof(buffer))) {
+    return false;
+  }
+  uint32_t count = Get<uint32_t>(buffer);
+  if (count == 0 || count > UINT16_MAX) {
+    return false;
+  }
+
+  auto* glyphs = static_cast<lv_font_fmt_txt_glyph_dsc_t*>(lv_mem_alloc(count * sizeof(lv_font_fmt_txt_glyph_dsc_t)));
+  if (glyphs == nullptr) {
+    return false;
+  }
+  std::memset(glyphs, 0, count * sizeof(lv_font_fmt_txt_glyph_dsc_t));
+  dsc.glyph_dsc = glyphs;
+  nbGlyphs = count;
+  this->glyfStart = glyfStart;
+
+  // The offset of the glyph records are kept in bitmap_index, the bitmaps are read from there on demand
+  uint16_t offsets[16];
+  for (uint32_t i = 0; i < count; i += 16) {
+    size_t nbOffsets = std::min<uint32_t>(16, count - i);
+    if (!ReadAt(locaStart + sectionHeaderSize + 4 + i * sizeof(uint16_t), offsets, nbOffsets * sizeof(uint16_t))) {
+      return false;
+    }
+    for (size_t j = 0; j < nbOffsets; j++) {
+      glyphs[i + j].bitmap_index = offsets[j];
+    }
+  }
+
+  // Glyph 0 is the "missing glyph", left empty
+  for (uint32_t i = 1; i < count; i++) {
+    lv_font_fmt_txt_glyph_dsc_t& glyph = glyphs[i];
+    uint8_t record[maxGlyphHeaderSize] {};
+    if (fs.FileSeek(&file, glyfStart + glyph.bitmap_index) < 0 || fs.FileRead(&file, record, sizeof(record)) <= 0) {
+      return false;
+    }
+    BitReader reader {record};
+    uint32_t advanceWidth = advanceWidthBits == 0 ? defaultAdvanceWidth : reader.Read(advanceWidthBits);
+    glyph.adv_w = integerAdvanceWidth ? advanceWidth * 16 : advanceWidth;
+    glyph.ofs_x = reader.ReadSigned(xyBits);
+    glyph.ofs_y = reader.ReadSigned(xyBits);
+    glyph.box_w = reader.Read(whBits);
+    glyph.box_h = reader.Read(whBits);
+  }
+  return true;
+}
+
+const uint8_t* FsFont::GetGlyphBitmap(const lv_font_t* font, uint32_t letter) {
+  auto* fsFont = static_cast<FsFont*>(font->user_data);
+  // LVGL always asks for the descriptor of a glyph just before its bitmap: the glyph id is still in the cache of the
+  // descriptor lookup.
+  if (fsFont->dsc.last_letter != letter) {
+    lv_font_glyph_dsc_t glyph;
+    if (!lv_font_get_glyph_dsc_fmt_txt(font, &glyph, letter, 0)) {
+      return nullptr;
+    }
+  }
+  return fsFont->ReadBitmap(fsFont->dsc.last_glyph_id);
+}
+
+const uint8_t* FsFont::ReadBitmap(uint16_t glyphId) {
+  if (glyphId == 0 || glyphId >= nbGlyphs) {
+    return nullptr;
+  }
+  // Spaces have no bitmap
+  const lv_font_fmt_txt_glyph_dsc_t& glyph = dsc.glyph_dsc[glyphId];
+  size_t size = (glyph.box_w * glyph.box_h * dsc.bpp + 7) / 8;
+  if (size == 0) {
+    return nullptr;
+  }
+  const uint8_t* cached = glyphCache.Find(this, glyphId);
+  if (cached != nullptr) {
+    return cached;
+  }
+
+  uint8_t* bitmap = glyphCache.Insert(this, glyphId, size);
+  if (bitmap == nullptr) {
+    return nullptr;
+  }
+
+  // The bitmap follows the fields of the glyph record and is not aligned on a byte
+  size_t headerBits = advanceWidthBits + 2 * xyBits + 2 * whBits;
+  uint8_t shift = headerBits % 8;
+  uint8_t next = 0;
+  bool ok = ReadAt(glyfStart + glyph.bitmap_index + headerBits / 8, bitmap, size);
+  if (ok && shift != 0 && (size * 8 - shift) < static_cast<size_t>(glyph.box_w * glyph.box_h * dsc.bpp)) {
+    ok = fs.FileRead(&file, &next, 1) == 1;
+  }
+  if (!ok) {
+    glyphCache.Remove(this, glyphId);
+    return nullptr;
+  }
+  if (shift != 0) {
+    for (size_t i = 0; i < size; i++) {
+      uint8_t following = (i + 1 < size) ? bitmap[i + 1] : next;
+      bitmap[i] = (bitmap[i] << shift) | (following >> (8 - shift));
+    }
+  }
+  return bitmap;
+}
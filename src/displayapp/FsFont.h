@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <lvgl/lvgl.h>
+#include "components/fs/FS.h"
+#include "displayapp/GlyphCache.h"
+
+namespace Pinetime {
+  namespace Components {
+    /* LVGL font stored in the filesystem, in the LVGL binary format (lv_font_conv --format bin --no-compress).
+     *
+     * Unlike lv_font_load(), only the character maps and the glyph descriptors are loaded in memory. The file is kept
+     * open and the glyph bitmaps are read on demand into the GlyphCache shared by all the fonts, so that redrawing the
+     * same text does not read the flash again. Kerning is ignored.
+     */
+    class FsFont {
+    public:
+      explicit FsFont(Controllers::FS& fs);
+      ~FsFont();
+
+      FsFont(const FsFont&) = delete;
+      FsFont& operator=(const FsFont&) = delete;
+
+      bool Load(const char* path);
+      void Unload();
+
+      // Returns nullptr when no font is loaded
+      const lv_font_t* GetFont() const {
+        return loaded ? &font : nullptr;
+      }
+
+      static GlyphCache& GetGlyphCache() {
+        return glyphCache;
+      }
+
+    private:
+      static const uint8_t* GetGlyphBitmap(const lv_font_t* font, uint32_t letter);
+
+      bool ReadAt(uint32_t position, void* buffer, size_t size);
+      bool ReadSection(uint32_t start, const char* label, uint32_t& length);
+      bool ReadCmaps(uint32_t start);
+      bool ReadGlyphs(uint32_t locaStart, uint32_t glyfStart);
+      const uint8_t* ReadBitmap(uint16_t glyphId);
+
+      Controllers::FS& fs;
+      lfs_file_t file;
+      bool fileOpened = false;
+      bool loaded = false;
+
+      lv_font_t font {};
+      lv_font_fmt_txt_dsc_t dsc {};
+      uint16_t nbGlyphs = 0;
+
+      // Layout of the glyph records in the file
+      uint32_t glyfStart = 0;
+      uint16_t defaultAdvanceWidth = 0;
+      bool integerAdvanceWidth = false;
+      uint8_t advanceWidthBits = 0;
+      uint8_t xyBits = 0;
+      uint8_t whBits = 0;
+
+      static GlyphCache glyphCache;
+    };
+  }
+}
@@ -0,0 +1,86 @@
+#include "displayapp/GlyphCache.h"
+#include <cstring>
+
+using namespace Pinetime::Components;
+
+const uint8_t* GlyphCache::Find(const void* owner, uint16_t glyphId) {
+  for (size_t i = 0; i < nbEntries; i++) {
+    Entry& entry = entries[i];
+    if (entry.owner == owner && entry.glyphId == glyphId) {
+      entry.lastUse = ++useCounter;
+      statistics.hits++;
+      return &pool[entry.offset];
+    }
+  }
+  statistics.misses++;
+  return nullptr;
+}
+
+uint8_t* GlyphCache::Insert(const void* owner, uint16_t glyphId, size_t size) {
+  if (size > poolSize) {
+    return nullptr;
+  }
+  while (nbEntries == maxEntries || used + size > poolSize) {
+    RemoveAt(LeastRecentlyUsed());
+    statistics.evictions++;
+  }
+
+  Entry& entry = entries[nbEntries++];
+  entry.owner = owner;
+  entry.lastUse = ++useCounter;
+  entry.glyphId = glyphId;
+  entry.offset = static_cast<uint16_t>(used);
+  entry.size = static_cast<uint16_t>(size);
+  used += size;
+  return &pool[entry.offset];
+}
+
+void GlyphCache::Remove(const void* owner, uint16_t glyphId) {
+  for (size_t i = 0; i < nbEntries; i++) {
+    if (entries[i].owner == owner && entries[i].glyphId == glyphId) {
+      RemoveAt(i);
+      return;
+    }
+  }
+}
+
+void GlyphCache::Remove(const void* owner) {
+  size_t i = 0;
+  while (i < nbEntries) {
+    if (entries[i].owner == owner) {
+      RemoveAt(i);
+    } else {
+      i++;
+    }
+  }
+}
+
+void GlyphCache::Clear() {
+  nbEntries = 0;
+  used = 0;
+  statistics = {};
+}
+
+void GlyphCache::RemoveAt(size_t index) {
+  const Entry removed = entries[index];
+  size_t end = removed.offset + removed.size;
+  std::memmove(&pool[removed.offset], &pool[end], used - end);
+  used -= removed.size;
+
+  for (size_t i = index + 1; i < nbEntries; i++) {
+    entries[i - 1] = entries[i];
+    entries[i - 1].offset -= removed.size;
+  }
+  nbEntries--;
+}
+
+size_t GlyphCache::LeastRecentlyUsed() const {
+  size_t oldest = 0;
+  for (size_t i = 1; i < nbEntries; i++) {
+    // Ages are computed with unsigned arithmetic so that the counter can wrap around
+    if (useCounter - entries[i].lastUse > useCounter - entries[oldest].lastUse) {
+      oldest = i;
+    }
+  }
+  return oldest;
+}
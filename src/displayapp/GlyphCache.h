@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinetime {
+  namespace Components {
+    /* Fixed size cache of glyph bitmaps, shared by all the fonts loaded from the filesystem.
+     *
+     * The bitmaps are packed one after the other in a single pool. When a new bitmap does not fit, the least recently
+     * used ones are evicted and the following bitmaps are moved down to fill the gap. LVGL only uses the bitmap of a
+     * glyph until it asks for the next one, so the pointers returned by Find() and Insert() are only valid until the
+     * next call to Insert() or Remove().
+     */
+    class GlyphCache {
+    public:
+      struct Statistics {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t evictions;
+      };
+
+      static constexpr size_t poolSize = 1536;
+      static constexpr size_t maxEntries = 48;
+
+      // Returns the bitmap of the glyph, or nullptr if it is not in the cache
+      const uint8_t* Find(const void* owner, uint16_t glyphId);
+      // Reserves size bytes for the bitmap of the glyph, or returns nullptr if it is larger than the whole cache
+      uint8_t* Insert(const void* owner, uint16_t glyphId, size_t size);
+      void Remove(const void* owner, uint16_t glyphId);
+      void Remove(const void* owner);
+      void Clear();
+
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
+    private:
+      struct Entry {
+        const void* owner;
+        uint32_t lastUse;
+        uint16_t glyphId;
+        uint16_t offset;
+        uint16_t size;
+      };
+
+      void RemoveAt(size_t index);
+      size_t LeastRecentlyUsed() const;
+
+      std::array<uint8_t, poolSize> pool;
+      // Sorted by offset in the pool
+      std::array<Entry, maxEntries> entries;
+      size_t nbEntries = 0;
+      size_t used = 0;
+      uint32_t useCounter = 0;
+      Statistics statistics {};
+    };
+  }
+}
@@ -0,0 +1,63 @@
+#include "displayapp/GlyphLookupCache.h"
+
+using namespace Pinetime::Components;
+
+GlyphLookupCache::Entry GlyphLookupCache::entries[nbEntries];
+GlyphLookupCache::Statistics GlyphLookupCache::statistics;
+
+void GlyphLookupCache::Install(lv_font_t& font) {
+  if (font.get_glyph_dsc != lv_font_get_glyph_dsc_fmt_txt) {
+    return;
+  }
+  if (static_cast<const lv_font_fmt_txt_dsc_t*>(font.dsc)->kern_dsc != nullptr) {
+    return;
+  }
+  font.get_glyph_dsc = GetGlyphDsc;
+}
+
+void GlyphLookupCache::Remove(const lv_font_t* font) {
+  for (auto& entry : entries) {
+    if (entry.font == font) {
+      entry.font = nullptr;
+    }
+  }
+}
+
+size_t GlyphLookupCache::Index(const lv_font_t* font, uint32_t letter) {
+  // Consecutive letters of the same font use consecutive entries
+  return (letter + (reinterpret_cast<uintptr_t>(font) >> 2)) % nbEntries;
+}
+
+bool GlyphLookupCache::GetGlyphDsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letterNext) {
+  auto* fontDsc = static_cast<lv_font_fmt_txt_dsc_t*>(font->dsc);
+  Entry& entry = entries[Index(font, letter)];
+
+  if (entry.font == font && entry.letter == letter) {
+    statistics.hits++;
+    if (entry.glyphId == 0) {
+      return false;
+    }
+    fontDsc->last_letter = letter;
+    fontDsc->last_glyph_id = entry.glyphId;
+    // Same as lv_font_get_glyph_dsc_fmt_txt() without kerning: the advance width is rounded to a pixel
+    const lv_font_fmt_txt_glyph_dsc_t& glyph = fontDsc->glyph_dsc[entry.glyphId];
+    dsc->adv_w = (glyph.adv_w + (1 << 3)) >> 4;
+    dsc->box_w = glyph.box_w;
+    dsc->box_h = glyph.box_h;
+    dsc->ofs_x = glyph.ofs_x;
+    dsc->ofs_y = glyph.ofs_y;
+    dsc->bpp = fontDsc->bpp;
+    return true;
+  }
+
+  statistics.misses++;
+  bool found = lv_font_get_glyph_dsc_fmt_txt(font, dsc, letter, letterNext);
+  entry.font = font;
+  entry.letter = letter;
+  entry.glyphId = (found && fontDsc->last_letter == letter) ? fontDsc->last_glyph_id : 0;
+  if (found && entry.glyphId == 0) {
+    // The font did not keep the glyph id of the letter: do not cache it
+    entry.font = nullptr;
+  }
+  return found;
+}
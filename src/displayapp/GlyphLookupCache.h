@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <lvgl/lvgl.h>
+
+namespace Pinetime {
+  namespace Components {
+    /* Direct-mapped cache of the glyph ids of the letters of the LVGL fonts, shared by all the fonts.
+     *
+     * LVGL asks for the descriptor of each letter when the text is laid out and again when it is drawn, and each lookup
+     * goes through the character maps of the font (binary search in the sparse lists). Install() replaces the
+     * get_glyph_dsc callback of a font by one that keeps the glyph id of the letter in the cache, the descriptor is then
+     * read directly from the glyph table of the font. On a hit, the glyph id is also written to the 1-entry cache of the
+     * font so that the lookup of the bitmap that follows is immediate too.
+     *
+     * Fonts with kerning are not cached, as the advance width of their letters depends on the next letter.
+     */
+    class GlyphLookupCache {
+    public:
+      struct Statistics {
+        uint32_t hits;
+        uint32_t misses;
+      };
+
+      // The printable ASCII letters all fit, so do the 64 letters of the Cyrillic alphabet
+      static constexpr size_t nbEntries = 128;
+
+      static void Install(lv_font_t& font);
+      // Removes the font from the cache, before it is unloaded
+      static void Remove(const lv_font_t* font);
+
+      static const Statistics& GetStatistics() {
+        return statistics;
+      }
+
+    private:
+      struct Entry {
+        const lv_font_t* font;
+        uint32_t letter;
+        // 0 if the font has no glyph for the letter
+        uint16_t glyphId;
+      };
+
+      static bool GetGlyphDsc(const lv_font_t* font, lv_font_glyph_dsc_t* dsc, uint32_t letter, uint32_t letterNext);
+      static size_t Index(const lv_font_t* font, uint32_t letter);
+
+      static Entry entries[nbEntries];
+      static Statistics statistics;
+    };
+  }
+}
@@ -1,5 +1,6 @@
 #include "displayapp/LittleVgl.h"
 #include "displayapp/lv_pinetime_theme.h"
+#include "displayapp/GlyphLookupCache.h"
 
 #include <FreeRTOS.h>
 #include <task.h>
@@ -11,11 +12,35 @@ using namespace Pinetime::Components;
 
 lv_style_t* LabelBigStyle = nullptr;
 
+LV_FONT_DECLARE(lv_font_navi_80)
+
 static void disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
   auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
   lvgl->FlushDisplay(area, color_p);
 }
 
+static void disp_wait(lv_disp_drv_t* disp_drv) {
+  auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
+  lvgl->WaitFlushCompleted();
+}
+
+static void disp_monitor(lv_disp_drv_t* disp_drv, uint32_t time, uint32_t px) {
+  auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
+  lvgl->OnRefreshCompleted(time, px);
+}
+
+static void refresh_task(lv_task_t* task) {
+  auto* disp = static_cast<lv_disp_t*>(task->user_data);
+  auto* lvgl = static_cast<LittleVgl*>(disp->driver.user_data);
+  lvgl->CoalesceInvalidAreas(disp);
+  _lv_disp_refr_task(task);
+}
+
+static void flush_completed(void* context) {
+  auto* lvgl = static_cast<LittleVgl*>(context);
+  lvgl->OnFlushCompleted();
+}
+
 static void rounder(lv_disp_drv_t* disp_drv, lv_area_t* area) {
   auto* lvgl = static_cast<LittleVgl*>(disp_drv->user_data);
   if (lvgl->GetFullRefresh()) {
@@ -39,11 +64,23 @@ void LittleVgl::Init() {
   InitTheme();
   InitDisplay();
   InitTouchpad();
+  rleImageDecoder.Init();
+
+  lv_font_t* fonts[] = {&jetbrains_mono_bold_20,
+                        &jetbrains_mono_extrabold_compressed,
+                        &jetbrains_mono_42,
+                        &jetbrains_mono_76,
+                        &open_sans_light,
+                        &lv_font_sys_48,
+                        &lv_font_navi_80};
+  for (lv_font_t* font : fonts) {
+    GlyphLookupCache::Install(*font);
+  }
 }
 
 void LittleVgl::InitDisplay() {
-  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * 4); /*Initialize the display buffer*/
-  lv_disp_drv_init(&disp_drv);                                       /*Basic initialization*/
+  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * nbWriteLines); /*Initialize the display buffer*/
+  lv_disp_drv_init(&disp_drv);                                                  /*Basic initialization*/
 
   /*Set up the functions to access to your display*/
 
@@ -53,13 +90,18 @@ void LittleVgl::InitDisplay() {
 
   /*Used to copy the buffer's content to the display*/
   disp_drv.flush_cb = disp_flush;
+  /*The flush is asynchronous: LVGL renders in the other buffer while the SPI sends the current one*/
+  disp_drv.wait_cb = disp_wait;
+  disp_drv.monitor_cb = disp_monitor;
   /*Set a display buffer*/
   disp_drv.buffer = &disp_buf_2;
   disp_drv.user_data = this;
   disp_drv.rounder_cb = rounder;
 
   /*Finally register the driver*/
-  lv_disp_drv_register(&disp_drv);
+  lv_disp_t* disp = lv_disp_drv_register(&disp_drv);
+  /*Merge the invalidated areas before each refresh*/
+  lv_task_set_cb(disp->refr_task, refresh_task);
 }
 
 void LittleVgl::InitTouchpad() {
@@ -93,9 +135,19 @@ void LittleVgl::SetFullRefresh(FullRefreshDirections direction) {
 void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
   uint16_t y1, y2, width, height = 0;
 
+  uint32_t waitStartCycleCount = DWT->CYCCNT;
   ulTaskNotifyTake(pdTRUE, 200);
   // Notification is still needed (even if there is a mutex on SPI) because of the DataCommand pin
   // which cannot be set/clear during a transfer.
+  currentFrameStatistics.stallCycles += DWT->CYCCNT - waitStartCycleCount;
+  if (currentFrameStatistics.flushes == 0) {
+    currentFrameStatistics.firstFlushTick = xTaskGetTickCount();
+  }
+  currentFrameStatistics.flushes++;
+  uint32_t bytes = Drivers::St7789::AddrWindowSetupSize + Drivers::St7789::BufferSize(lv_area_get_size(area), lcd.GetPixelFormat());
+  currentFrameStatistics.bytes += bytes;
+  totalBytes += bytes;
+  transferStartCycleCount = DWT->CYCCNT;
 
   if ((scrollDirection == LittleVgl::FullRefreshDirections::Down) && (area->y2 == visibleNbLines - 1)) {
     writeOffset = ((writeOffset + totalNbLines) - visibleNbLines) % totalNbLines;
@@ -159,23 +211,196 @@ void LittleVgl::FlushDisplay(const lv_area_t* area, lv_color_t* color_p) {
     height = totalNbLines - y1;
 
     if (height > 0) {
-      lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), width * height * 2);
+      lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), PrepareBuffer(color_p, width * height));
+      waitStartCycleCount = DWT->CYCCNT;
       ulTaskNotifyTake(pdTRUE, 100);
+      currentFrameStatistics.stallCycles += DWT->CYCCNT - waitStartCycleCount;
     }
 
     uint16_t pixOffset = width * height;
     height = y2 + 1;
-    lcd.DrawBuffer(area->x1, 0, width, height, reinterpret_cast<const uint8_t*>(color_p + pixOffset), width * height * 2);
+    lcd.DrawBuffer(area->x1,
+                   0,
+                   width,
+                   height,
+                   reinterpret_cast<const uint8_t*>(color_p + pixOffset),
+                   PrepareBuffer(color_p + pixOffset, width * height),
+                   flush_completed,
+                   this);
 
   } else {
-    lcd.DrawBuffer(area->x1, y1, width, height, reinterpret_cast<const uint8_t*>(color_p), width * height * 2);
+    lcd.DrawBuffer(area->x1,
+                   y1,
+                   width,
+                   height,
+                   reinterpret_cast<const uint8_t*>(color_p),
+                   PrepareBuffer(color_p, width * height),
+                   flush_completed,
+                   this);
+  }
+
+  // lv_disp_flush_ready() will be called from the SPI interrupt once the transfer is done (OnFlushCompleted()).
+  // Meanwhile, LVGL renders the next band in the other buffer.
+}
+
+size_t LittleVgl::PrepareBuffer(lv_color_t* buffer, size_t nbPixels) {
+  if (lcd.GetPixelFormat() == Drivers::St7789::PixelFormats::Rgb444) {
+    // LVGL does not read the buffer back once it is flushed, it can be converted in place
+    return Drivers::St7789::PackRgb444(reinterpret_cast<uint8_t*>(buffer), nbPixels);
   }
+  return nbPixels * sizeof(lv_color_t);
+}
+
+void LittleVgl::OnFlushCompleted() {
+  // Called from the SPI interrupt
+  currentFrameStatistics.transferCycles += DWT->CYCCNT - transferStartCycleCount;
 
   // IMPORTANT!!!
   // Inform the graphics library that you are ready with the flushing
   lv_disp_flush_ready(&disp_drv);
 }
 
+void LittleVgl::WaitFlushCompleted() {
+  // Called by LVGL when it needs a buffer that is still being sent to the display.
+  // Do not consume the notification, FlushDisplay() still needs it.
+  uint32_t waitStartCycleCount = DWT->CYCCNT;
+  xTaskNotifyWait(0, 0, nullptr, 100);
+  currentFrameStatistics.stallCycles += DWT->CYCCNT - waitStartCycleCount;
+}
+
+void LittleVgl::OnRefreshCompleted(uint32_t timeMs, uint32_t pixels) {
+  currentFrameStatistics.refreshTimeMs = timeMs;
+  currentFrameStatistics.pixels = pixels;
+  lastFrameStatistics = currentFrameStatistics;
+  currentFrameStatistics = {};
+  frameCount++;
+}
+
+uint16_t LittleVgl::FlushCount(const lv_area_t& area) const {
+  // LVGL renders an area in bands as high as the draw buffer allows, each band is flushed separately
+  uint16_t linesPerFlush = (LV_HOR_RES_MAX * nbWriteLines) / lv_area_get_width(&area);
+  return (lv_area_get_height(&area) + linesPerFlush - 1) / linesPerFlush;
+}
+
+uint32_t LittleVgl::FlushCost(const lv_area_t& area) const {
+  // Cost in bytes sent to the display. Each flush also has a fixed cost on the CPU side (rendering setup, DMA setup,
+  // interrupt and task notification), estimated as the time needed to send flushOverheadSize bytes.
+  static constexpr uint32_t flushOverheadSize = 32;
+  return FlushCount(area) * (Drivers::St7789::AddrWindowSetupSize + flushOverheadSize) +
+         Drivers::St7789::BufferSize(lv_area_get_size(&area), lcd.GetPixelFormat());
+}
+
+void LittleVgl::CoalesceInvalidAreas(lv_disp_t* disp) {
+  // LVGL only joins overlapping areas, and only when the result is smaller than both areas together. Also join
+  // close areas, and areas the display can be sent faster as a whole than separately.
+  // Joined areas are flagged in inv_area_joined[], which LVGL honours when joining and refreshing.
+  if (disp->inv_p == 0) {
+    return;
+  }
+
+  if (lowPowerMode) {
+    // Nothing is displayed outside of the low power area
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+      if (disp->inv_area_joined[i] == 0 && !_lv_area_intersect(&disp->inv_areas[i], &disp->inv_areas[i], &lowPowerArea)) {
+        disp->inv_area_joined[i] = 1;
+      }
+    }
+  }
+
+  for (uint16_t i = 0; i < disp->inv_p; i++) {
+    if (disp->inv_area_joined[i] == 0) {
+      currentFrameStatistics.flushesBeforeMerge += FlushCount(disp->inv_areas[i]);
+      currentFrameStatistics.bytesBeforeMerge += FlushCost(disp->inv_areas[i]);
+    }
+  }
+
+  bool joined;
+  do {
+    joined = false;
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+      if (disp->inv_area_joined[i] != 0) {
+        continue;
+      }
+      for (uint16_t j = i + 1; j < disp->inv_p; j++) {
+        if (disp->inv_area_joined[j] != 0) {
+          continue;
+        }
+        lv_area_t merged;
+        _lv_area_join(&merged, &disp->inv_areas[i], &disp->inv_areas[j]);
+        if (FlushCost(merged) < FlushCost(disp->inv_areas[i]) + FlushCost(disp->inv_areas[j])) {
+          lv_area_copy(&disp->inv_areas[i], &merged);
+          disp->inv_area_joined[j] = 1;
+          joined = true;
+        }
+      }
+    }
+  } while (joined);
+}
+
+void LittleVgl::SetReducedColorDepth(bool enabled) {
+  auto format = enabled ? Drivers::St7789::PixelFormats::Rgb444 : Drivers::St7789::PixelFormats::Rgb565;
+  if (format == lcd.GetPixelFormat()) {
+    return;
+  }
+
+  // The D/C pin cannot be changed during a transfer
+  WaitTransferCompleted();
+  lcd.SetPixelFormat(format);
+}
+
+void LittleVgl::EnterLowPowerMode(const lv_area_t& area) {
+  WaitTransferCompleted();
+  lowPowerMode = true;
+  lv_area_copy(&lowPowerArea, &area);
+  // Colours are limited to 8 in idle mode: the 4 MSB of each component are more than enough
+  SetReducedColorDepth(true);
+  lcd.LowPowerOn((area.y1 + writeOffset) % totalNbLines, (area.y2 + writeOffset) % totalNbLines);
+}
+
+void LittleVgl::ExitLowPowerMode() {
+  if (!lowPowerMode) {
+    return;
+  }
+  WaitTransferCompleted();
+  lowPowerMode = false;
+  lcd.LowPowerOff();
+  // The rest of the screen has not been refreshed while in low power mode
+  lv_obj_invalidate(lv_scr_act());
+}
+
+void LittleVgl::RefreshNow() {
+  lv_disp_t* disp = lv_disp_get_default();
+  refresh_task(disp->refr_task);
+}
+
+void LittleVgl::SetRefreshPeriod(uint32_t periodMs) {
+  lv_task_set_period(lv_disp_get_default()->refr_task, periodMs);
+}
+
+bool LittleVgl::IsIdle() const {
+  lv_disp_t* disp = lv_disp_get_default();
+  return disp->inv_p == 0 && lv_anim_count_running() == 0 && !tapped;
+}
+
+void LittleVgl::WaitTransferCompleted() {
+  while (disp_buf_2.flushing) {
+    WaitFlushCompleted();
+  }
+}
+
+void LittleVgl::SetDrawBufferLines(uint8_t nbLines) {
+  if (nbLines == 0 || nbLines > maxDrawBufferLines || nbLines == nbWriteLines) {
+    return;
+  }
+
+  // Do not pull the buffers from under a transfer that is still in progress
+  WaitTransferCompleted();
+
+  nbWriteLines = nbLines;
+  lv_disp_buf_init(&disp_buf_2, buf2_1, buf2_2, LV_HOR_RES_MAX * nbWriteLines);
+  lv_obj_invalidate(lv_scr_act());
+}
+
 void LittleVgl::SetNewTouchPoint(uint16_t x, uint16_t y, bool contact) {
   tap_x = x;
   tap_y = y;
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <lvgl/lvgl.h>
+#include "displayapp/RleImageDecoder.h"
+
+#ifndef LVGL_DRAW_BUFFER_LINES
+  #define LVGL_DRAW_BUFFER_LINES 4
+#endif
 
 namespace Pinetime {
   namespace Drivers {
@@ -12,6 +17,39 @@ namespace Pinetime {
     class LittleVgl {
     public:
       enum class FullRefreshDirections { None, Up, Down, Left, Right, LeftAnim, RightAnim };
+
+      // Render vs transfer statistics of a frame, in CPU cycles.
+      // transferCycles is the time the display DMA was busy, stallCycles is the part of it LVGL spent
+      // waiting instead of rendering the next band.
+      // flushesBeforeMerge and bytesBeforeMerge are the estimated flushes and bytes (pixels and address window
+      // setup) the invalidated areas would have cost without CoalesceInvalidAreas(), flushes and bytes are
+      // what was actually sent. firstFlushTick is the FreeRTOS tick count when the first band was sent.
+      struct FrameStatistics {
+        uint16_t flushes;
+        uint32_t bytes;
+        uint16_t flushesBeforeMerge;
+        uint32_t bytesBeforeMerge;
+        uint32_t transferCycles;
+        uint32_t stallCycles;
+        uint32_t refreshTimeMs;
+        uint32_t pixels;
+        uint32_t firstFlushTick;
+
+        uint8_t OverlapPercent() const {
+          if (transferCycles == 0 || stallCycles >= transferCycles) {
+            return 0;
+          }
+          return static_cast<uint8_t>(((uint64_t) (transferCycles - stallCycles) * 100) / transferCycles);
+        }
+      };
+
+      // Height (in lines) of the 2 draw buffers reserved at build time. LVGL renders the screen in bands
+      // of at most this height, each band being sent to the display in a single flush.
+      static constexpr uint8_t maxDrawBufferLines = LVGL_DRAW_BUFFER_LINES;
+      static constexpr size_t DrawBufferSize(uint8_t nbLines) {
+        return 2 * LV_HOR_RES_MAX * nbLines * sizeof(lv_color_t);
+      }
+
       LittleVgl(Pinetime::Drivers::St7789& lcd, Pinetime::Drivers::Cst816S& touchPanel);
 
       LittleVgl(const LittleVgl&) = delete;
@@ -22,10 +60,40 @@ namespace Pinetime {
       void Init();
 
       void FlushDisplay(const lv_area_t* area, lv_color_t* color_p);
+      void WaitFlushCompleted();
+      void OnFlushCompleted();
+      void OnRefreshCompleted(uint32_t timeMs, uint32_t pixels);
+      void CoalesceInvalidAreas(lv_disp_t* disp);
       bool GetTouchPadInfo(lv_indev_data_t* ptr);
       void SetFullRefresh(FullRefreshDirections direction);
       void SetNewTouchPoint(uint16_t x, uint16_t y, bool contact);
 
+      // Send 12 bits (RGB444) instead of 16 bits pixels to the display, for screens that do not need more colours.
+      // Must be called from the display task.
+      void SetReducedColorDepth(bool enabled);
+
+      // Only the given area is shown (with 8 colours) and refreshed, invalidations outside of it are ignored.
+      // Must be called from the display task.
+      void EnterLowPowerMode(const lv_area_t& area);
+      void ExitLowPowerMode();
+
+      // Runs the LVGL refresh now instead of waiting for its next period.
+      void RefreshNow();
+
+      // Period of the LVGL refresh task, LV_DISP_DEF_REFR_PERIOD by default
+      void SetRefreshPeriod(uint32_t periodMs);
+
+      // True when LVGL has nothing to render: no invalidated area, no running animation and no touch in progress
+      bool IsIdle() const;
+
+      // Use only the first nbLines lines of the draw buffers (1 <= nbLines <= maxDrawBufferLines).
+      // Must be called from the display task.
+      void SetDrawBufferLines(uint8_t nbLines);
+
+      uint8_t GetDrawBufferLines() const {
+        return nbWriteLines;
+      }
+
       bool GetFullRefresh() {
         bool returnValue = fullRefresh;
         if (fullRefresh) {
@@ -34,31 +102,58 @@ namespace Pinetime {
         return returnValue;
       }
 
+      const FrameStatistics& GetLastFrameStatistics() const {
+        return lastFrameStatistics;
+      }
+
+      uint32_t GetFrameCount() const {
+        return frameCount;
+      }
+
+      // Bytes sent to the display since boot
+      uint32_t GetTotalBytes() const {
+        return totalBytes;
+      }
+
     private:
       void InitDisplay();
       void InitTouchpad();
       void InitTheme();
+      void WaitTransferCompleted();
+      size_t PrepareBuffer(lv_color_t* buffer, size_t nbPixels);
+      uint16_t FlushCount(const lv_area_t& area) const;
+      uint32_t FlushCost(const lv_area_t& area) const;
 
       Pinetime::Drivers::St7789& lcd;
       Pinetime::Drivers::Cst816S& touchPanel;
 
       lv_disp_buf_t disp_buf_2;
-      lv_color_t buf2_1[LV_HOR_RES_MAX * 4];
-      lv_color_t buf2_2[LV_HOR_RES_MAX * 4];
+      lv_color_t buf2_1[LV_HOR_RES_MAX * maxDrawBufferLines];
+      lv_color_t buf2_2[LV_HOR_RES_MAX * maxDrawBufferLines];
 
       lv_disp_drv_t disp_drv;
+      RleImageDecoder rleImageDecoder;
 
       bool fullRefresh = false;
-      static constexpr uint8_t nbWriteLines = 4;
+      uint8_t nbWriteLines = maxDrawBufferLines;
       static constexpr uint16_t totalNbLines = 320;
       static constexpr uint16_t visibleNbLines = 240;
-      static constexpr uint8_t MaxScrollOffset() {
+      uint8_t MaxScrollOffset() const {
         return LV_VER_RES_MAX - nbWriteLines;
       }
       FullRefreshDirections scrollDirection = FullRefreshDirections::None;
       uint16_t writeOffset = 0;
       uint16_t scrollOffset = 0;
 
+      volatile uint32_t transferStartCycleCount = 0;
+      FrameStatistics currentFrameStatistics {};
+      FrameStatistics lastFrameStatistics {};
+      uint32_t frameCount = 0;
+      uint32_t totalBytes = 0;
+
+      bool lowPowerMode = false;
+      lv_area_t lowPowerArea;
+
       uint16_t tap_x = 0;
       uint16_t tap_y = 0;
       bool tapped = false;
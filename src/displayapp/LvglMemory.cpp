@@ -0,0 +1,239 @@
+#include "displayapp/LvglMemory.h"
+#include <lvgl/lvgl.h>
+
+using namespace Pinetime::Components;
+
+namespace {
+  constexpr uint16_t poolSize = LV_MEM_SIZE & ~3U;
+  static_assert(LV_MEM_SIZE < 0x8000, "The offsets and sizes of the blocks are 16 bits, with 2 classes to spare");
+
+  // The last 4 bytes of the pool are the header of an empty block which is never free: each block has a next one
+  alignas(4) uint8_t pool[poolSize];
+
+  uint8_t Log2(uint32_t value) {
+    return 31 - __builtin_clz(value);
+  }
+}
+
+bool LvglMemory::initialized = false;
+uint16_t LvglMemory::freeLists[nbClasses][nbSubClasses];
+uint8_t LvglMemory::subClassBitmaps[nbClasses];
+uint16_t LvglMemory::classBitmap = 0;
+uint32_t LvglMemory::used = 0;
+uint32_t LvglMemory::maxUsed = 0;
+uint32_t LvglMemory::failures = 0;
+
+void* lv_pinetime_mem_alloc(size_t size) {
+  return LvglMemory::Allocate(size);
+}
+
+void lv_pinetime_mem_free(void* p) {
+  LvglMemory::Free(p);
+}
+
+LvglMemory::BlockHeader& LvglMemory::Header(uint16_t block) {
+  return *reinterpret_cast<BlockHeader*>(pool + block);
+}
+
+uint16_t& LvglMemory::NextFree(uint16_t block) {
+  return *reinterpret_cast<uint16_t*>(pool + block + headerSize);
+}
+
+uint16_t& LvglMemory::PreviousFree(uint16_t block) {
+  return *reinterpret_cast<uint16_t*>(pool + block + headerSize + sizeof(uint16_t));
+}
+
+uint16_t LvglMemory::Size(uint16_t block) {
+  return Header(block).size & ~freeFlag;
+}
+
+bool LvglMemory::IsFree(uint16_t block) {
+  return (Header(block).size & freeFlag) != 0;
+}
+
+uint16_t LvglMemory::Next(uint16_t block) {
+  return block + headerSize + Size(block);
+}
+
+void LvglMemory::Init() {
+  for (auto& lists : freeLists) {
+    for (auto& list : lists) {
+      list = none;
+    }
+  }
+  constexpr uint16_t last = poolSize - headerSize;
+  Header(0) = {none, static_cast<uint16_t>((last - headerSize) | freeFlag)};
+  Header(last) = {0, 0};
+  Insert(0);
+  initialized = true;
+}
+
+void LvglMemory::Mapping(uint32_t size, uint8_t& sizeClass, uint8_t& subClass) {
+  if (size < smallBlockSize) {
+    sizeClass = 0;
+    subClass = size >> alignmentLog2;
+  } else {
+    uint8_t log = Log2(size);
+    subClass = (size >> (log - nbSubClassesLog2)) ^ nbSubClasses;
+    sizeClass = log - classShift + 1;
+  }
+}
+
+uint16_t LvglMemory::FindFreeBlock(uint32_t size) {
+  // Round the size up to the next subclass: all the blocks of the list found are large enough
+  if (size >= smallBlockSize) {
+    size += (1U << (Log2(size) - nbSubClassesLog2)) - 1;
+  }
+  uint8_t sizeClass;
+  uint8_t subClass;
+  Mapping(size, sizeClass, subClass);
+  if (sizeClass >= nbClasses) {
+    return none;
+  }
+
+  uint32_t subClasses = subClassBitmaps[sizeClass] & (~0U << subClass);
+  if (subClasses == 0) {
+    uint32_t classes = classBitmap & (~0U << (sizeClass + 1));
+    if (classes == 0) {
+      return none;
+    }
+    sizeClass = __builtin_ctz(classes);
+    subClasses = subClassBitmaps[sizeClass];
+  }
+  return freeLists[sizeClass][__builtin_ctz(subClasses)];
+}
+
+void LvglMemory::Insert(uint16_t block) {
+  uint8_t sizeClass;
+  uint8_t subClass;
+  Mapping(Size(block), sizeClass, subClass);
+  uint16_t& head = freeLists[sizeClass][subClass];
+  NextFree(block) = head;
+  PreviousFree(block) = none;
+  if (head != none) {
+    PreviousFree(head) = block;
+  }
+  head = block;
+  subClassBitmaps[sizeClass] |= 1U << subClass;
+  classBitmap |= 1U << sizeClass;
+}
+
+void LvglMemory::Remove(uint16_t block) {
+  uint8_t sizeClass;
+  uint8_t subClass;
+  Mapping(Size(block), sizeClass, subClass);
+  uint16_t next = NextFree(block);
+  uint16_t previous = PreviousFree(block);
+  if (next != none) {
+    PreviousFree(next) = previous;
+  }
+  if (previous != none) {
+    NextFree(previous) = next;
+  }
+  uint16_t& head = freeLists[sizeClass][subClass];
+  if (head == block) {
+    head = next;
+    if (head == none) {
+      subClassBitmaps[sizeClass] &= ~(1U << subClass);
+      if (subClassBitmaps[sizeClass] == 0) {
+        classBitmap &= ~(1U << sizeClass);
+      }
+    }
+  }
+}
+
+void* LvglMemory::Allocate(size_t size) {
+  if (!initialized) {
+    Init();
+  }
+  constexpr uint32_t alignmentMask = (1U << alignmentLog2) - 1;
+  uint32_t blockSize = (size + alignmentMask) & ~alignmentMask;
+  if (blockSize < minBlockSize) {
+    blockSize = minBlockSize;
+  }
+
+  uint16_t block = blockSize < poolSize ? FindFreeBlock(blockSize) : none;
+  if (block == none) {
+    failures++;
+    return nullptr;
+  }
+  Remove(block);
+
+  // Give the end of the block back if it is large enough for another block
+  uint16_t freeSize = Size(block);
+  if (freeSize >= blockSize + headerSize + minBlockSize) {
+    auto remainder = static_cast<uint16_t>(block + headerSize + blockSize);
+    Header(remainder) = {block, static_cast<uint16_t>((freeSize - blockSize - headerSize) | freeFlag)};
+    Header(Next(remainder)).previous = remainder;
+    Header(block).size = blockSize;
+    Insert(remainder);
+  } else {
+    Header(block).size = freeSize;
+  }
+
+  used += Size(block) + headerSize;
+  if (used > maxUsed) {
+    maxUsed = used;
+  }
+  return pool + block + headerSize;
+}
+
+void LvglMemory::Free(void* p) {
+  if (p == nullptr) {
+    return;
+  }
+  auto block = static_cast<uint16_t>(static_cast<uint8_t*>(p) - pool - headerSize);
+  used -= Size(block) + headerSize;
+  Header(block).size |= freeFlag;
+
+  uint16_t previous = Header(block).previous;
+  if (previous != none && IsFree(previous)) {
+    Remove(previous);
+    Header(previous).size = (Size(previous) + headerSize + Size(block)) | freeFlag;
+    block = previous;
+    Header(Next(block)).previous = block;
+  }
+  uint16_t next = Next(block);
+  if (IsFree(next)) {
+    Remove(next);
+    Header(block).size = (Size(block) + headerSize + Size(next)) | freeFlag;
+    Header(Next(block)).previous = block;
+  }
+  Insert(block);
+}
+
+LvglMemory::Statistics LvglMemory::GetStatistics() {
+  Statistics statistics {};
+#if LV_MEM_CUSTOM == 0
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  statistics.total = mon.total_size;
+  statistics.used = mon.total_size - mon.free_size;
+  statistics.maxUsed = mon.max_used;
+  statistics.free = mon.free_size;
+  statistics.largestFree = mon.free_biggest_size;
+  statistics.usedPercent = mon.used_pct;
+  statistics.fragmentation = mon.frag_pct;
+#else
+  if (!initialized) {
+    Init();
+  }
+  statistics.total = poolSize;
+  statistics.used = used;
+  statistics.maxUsed = maxUsed;
+  for (uint16_t block = 0; Size(block) != 0; block = Next(block)) {
+    if (IsFree(block)) {
+      statistics.free += Size(block);
+      if (Size(block) > statistics.largestFree) {
+        statistics.largestFree = Size(block);
+      }
+    }
+  }
+  statistics.usedPercent = static_cast<uint8_t>(used * 100 / poolSize);
+  if (statistics.free > 0) {
+    statistics.fragmentation = static_cast<uint8_t>(100 - (statistics.largestFree * 100) / statistics.free);
+  }
+  statistics.failures = failures;
+#endif
+  return statistics;
+}
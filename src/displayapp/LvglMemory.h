@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Allocation functions of LVGL when LV_MEM_CUSTOM is 1 in lv_conf.h (this header is also included by the C sources of
+ * LVGL) */
+#ifdef __cplusplus
+extern "C" {
+#endif
+void* lv_pinetime_mem_alloc(size_t size);
+void lv_pinetime_mem_free(void* p);
+#ifdef __cplusplus
+}
+#endif
+
+#ifdef __cplusplus
+namespace Pinetime {
+  namespace Components {
+    /* Memory of LVGL (LV_MEM_SIZE bytes).
+     *
+     * With LV_MEM_CUSTOM = 1, the blocks are allocated by a TLSF (two-level segregated fit) allocator instead of the
+     * first fit allocator of LVGL: the free blocks are kept in lists by size class (a power of two, split in 4), and an
+     * allocation takes the first block of the smallest non-empty class that is large enough for it. It runs in
+     * constant time, and it does not cut the large free blocks into pieces for the small objects as long as blocks
+     * of their size are free, which is what made the screens with many objects fail to allocate after the apps were
+     * opened many times. Free blocks are merged with their free neighbours when they are released.
+     *
+     * With LV_MEM_CUSTOM = 0, the statistics come from the allocator of LVGL.
+     */
+    class LvglMemory {
+    public:
+      struct Statistics {
+        uint32_t total;
+        // Including the headers of the blocks
+        uint32_t used;
+        uint32_t maxUsed;
+        uint32_t free;
+        uint32_t largestFree;
+        uint8_t usedPercent;
+        // Part of the free memory that is not in the largest free block
+        uint8_t fragmentation;
+        // Allocations that failed
+        uint32_t failures;
+      };
+
+      static Statistics GetStatistics();
+
+      static void* Allocate(size_t size);
+      static void Free(void* p);
+
+    private:
+      struct BlockHeader {
+        // Offset of the previous block in the pool, none for the first one
+        uint16_t previous;
+        // Size of the data of the block, freeFlag is set when the block is free
+        uint16_t size;
+      };
+
+      static constexpr uint16_t none = 0xffff;
+      static constexpr uint16_t freeFlag = 1;
+      static constexpr uint16_t headerSize = sizeof(BlockHeader);
+      // Free blocks keep the offsets of the next and previous free blocks of their list in their data
+      static constexpr uint16_t minBlockSize = 2 * sizeof(uint16_t);
+      static constexpr uint8_t alignmentLog2 = 2;
+      // Number of subdivisions of the size classes
+      static constexpr uint8_t nbSubClassesLog2 = 2;
+      static constexpr uint8_t nbSubClasses = 1 << nbSubClassesLog2;
+      // The blocks smaller than this are in the first class, with a subclass per size
+      static constexpr uint8_t classShift = nbSubClassesLog2 + alignmentLog2;
+      static constexpr uint16_t smallBlockSize = 1 << classShift;
+      static constexpr uint8_t nbClasses = 12;
+
+      static void Init();
+      static void Mapping(uint32_t size, uint8_t& sizeClass, uint8_t& subClass);
+      static uint16_t FindFreeBlock(uint32_t size);
+      static void Insert(uint16_t block);
+      static void Remove(uint16_t block);
+
+      static BlockHeader& Header(uint16_t block);
+      static uint16_t& NextFree(uint16_t block);
+      static uint16_t& PreviousFree(uint16_t block);
+      static uint16_t Size(uint16_t block);
+      static bool IsFree(uint16_t block);
+      static uint16_t Next(uint16_t block);
+
+      static bool initialized;
+      static uint16_t freeLists[nbClasses][nbSubClasses];
+      static uint8_t subClassBitmaps[nbClasses];
+      static uint16_t classBitmap;
+      static uint32_t used;
+      static uint32_t maxUsed;
+      static uint32_t failures;
+    };
+  }
+}
+#endif
@@ -0,0 +1,212 @@
+#include "displayapp/RleImageDecoder.h"
+
+using namespace Pinetime::Components;
+
+namespace {
+  lv_res_t decoder_info(lv_img_decoder_t* /*decoder*/, const void* src, lv_img_header_t* header) {
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE) {
+      return LV_RES_INV;
+    }
+    auto* image = static_cast<const lv_img_dsc_t*>(src);
+    if (image->header.cf != RleImageDecoder::Rle1Bit && image->header.cf != RleImageDecoder::Rle2BitClut8) {
+      return LV_RES_INV;
+    }
+
+    header->w = image->header.w;
+    header->h = image->header.h;
+    // Lines are decoded to opaque true colour pixels
+    header->cf = LV_IMG_CF_RAW;
+    return LV_RES_OK;
+  }
+
+  lv_res_t decoder_open(lv_img_decoder_t* /*decoder*/, lv_img_decoder_dsc_t* dsc) {
+    if (dsc->src_type != LV_IMG_SRC_VARIABLE) {
+      return LV_RES_INV;
+    }
+    auto* cursor = static_cast<RleImageDecoder::Cursor*>(lv_mem_alloc(sizeof(RleImageDecoder::Cursor)));
+    if (cursor == nullptr) {
+      return LV_RES_INV;
+    }
+    if (!RleImageDecoder::Reset(*cursor, *static_cast<const lv_img_dsc_t*>(dsc->src))) {
+      lv_mem_free(cursor);
+      return LV_RES_INV;
+    }
+    dsc->user_data = cursor;
+    // No decoded image: LVGL reads it line by line
+    dsc->img_data = nullptr;
+    return LV_RES_OK;
+  }
+
+  lv_res_t decoder_read_line(lv_img_decoder_t* /*decoder*/,
+                             lv_img_decoder_dsc_t* dsc,
+                             lv_coord_t x,
+                             lv_coord_t y,
+                             lv_coord_t len,
+                             uint8_t* buf) {
+    auto* cursor = static_cast<RleImageDecoder::Cursor*>(dsc->user_data);
+    if (y < cursor->row && !RleImageDecoder::Reset(*cursor, *static_cast<const lv_img_dsc_t*>(dsc->src))) {
+      return LV_RES_INV;
+    }
+    return RleImageDecoder::ReadLine(*cursor, x, y, len, reinterpret_cast<lv_color_t*>(buf)) ? LV_RES_OK : LV_RES_INV;
+  }
+
+  void decoder_close(lv_img_decoder_t* /*decoder*/, lv_img_decoder_dsc_t* dsc) {
+    lv_mem_free(dsc->user_data);
+    dsc->user_data = nullptr;
+  }
+}
+
+void RleImageDecoder::Init() {
+  lv_img_decoder_t* decoder = lv_img_decoder_create();
+  lv_img_decoder_set_info_cb(decoder, decoder_info);
+  lv_img_decoder_set_open_cb(decoder, decoder_open);
+  lv_img_decoder_set_read_line_cb(decoder, decoder_read_line);
+  lv_img_decoder_set_close_cb(decoder, decoder_close);
+}
+
+bool RleImageDecoder::Reset(Cursor& cursor, const lv_img_dsc_t& image) {
+  cursor.data = image.data;
+  cursor.size = image.data_size;
+  cursor.index = 0;
+  cursor.format = image.header.cf;
+  cursor.width = image.header.w;
+  cursor.row = 0;
+  cursor.runRemaining = 0;
+  cursor.runColor = LV_COLOR_BLACK;
+  cursor.nextColor = 0;
+
+  if (cursor.format == Rle2BitClut8) {
+    if (cursor.size < 3 || cursor.data[0] != 2) {
+      return false;
+    }
+    // Skip the descriptor, the size of the image is also in the LVGL header
+    cursor.index = 3;
+    // black, grey25, grey50, white
+    cursor.palette[0] = Clut8(0);
+    cursor.palette[1] = Clut8(254);
+    cursor.palette[2] = Clut8(219);
+    cursor.palette[3] = Clut8(215);
+  } else {
+    cursor.palette[0] = LV_COLOR_BLACK;
+    cursor.palette[1] = LV_COLOR_WHITE;
+  }
+  return true;
+}
+
+bool RleImageDecoder::ReadLine(Cursor& cursor, lv_coord_t x, lv_coord_t y, lv_coord_t len, lv_color_t* buffer) {
+  while (cursor.row < y) {
+    if (!Skip(cursor, cursor.width)) {
+      return false;
+    }
+    cursor.row++;
+  }
+
+  if (!Skip(cursor, x) || !Emit(cursor, len, buffer) || !Skip(cursor, cursor.width - x - len)) {
+    return false;
+  }
+  cursor.row++;
+  return true;
+}
+
+bool RleImageDecoder::NextRun(Cursor& cursor) {
+  while (cursor.runRemaining == 0) {
+    if (cursor.index >= cursor.size) {
+      return false;
+    }
+    uint8_t code = cursor.data[cursor.index++];
+
+    if (cursor.format == Rle1Bit) {
+      // Runs alternate between both colours, a run of 255 pixels followed by an empty one encodes longer runs.
+      cursor.runRemaining = code;
+      cursor.runColor = cursor.palette[cursor.nextColor];
+      cursor.nextColor ^= 1;
+      continue;
+    }
+
+    uint8_t colorIndex = code >> 6;
+    uint32_t runLength = code & 0x3f;
+    if (runLength == 0) {
+      // Empty run: the next byte is the new CLUT index of this palette entry
+      if (cursor.index >= cursor.size) {
+        return false;
+      }
+      cursor.palette[colorIndex] = Clut8(cursor.data[cursor.index++]);
+      continue;
+    }
+    if (runLength == 0x3f) {
+      uint8_t extension;
+      do {
+        if (cursor.index >= cursor.size) {
+          return false;
+        }
+        extension = cursor.data[cursor.index++];
+        runLength += extension;
+      } while (extension == 255);
+    }
+    cursor.runRemaining = runLength;
+    cursor.runColor = cursor.palette[colorIndex];
+  }
+  return true;
+}
+
+bool RleImageDecoder::Skip(Cursor& cursor, uint32_t nbPixels) {
+  while (nbPixels > 0) {
+    if (!NextRun(cursor)) {
+      return false;
+    }
+    uint32_t count = (nbPixels < cursor.runRemaining) ? nbPixels : cursor.runRemaining;
+    cursor.runRemaining -= count;
+    nbPixels -= count;
+  }
+  return true;
+}
+
+bool RleImageDecoder::Emit(Cursor& cursor, uint32_t nbPixels, lv_color_t* buffer) {
+  while (nbPixels > 0) {
+    if (!NextRun(cursor)) {
+      return false;
+    }
+    uint32_t count = (nbPixels < cursor.runRemaining) ? nbPixels : cursor.runRemaining;
+    Fill(buffer, cursor.runColor, count);
+    buffer += count;
+    cursor.runRemaining -= count;
+    nbPixels -= count;
+  }
+  return true;
+}
+
+void RleImageDecoder::Fill(lv_color_t* buffer, lv_color_t color, uint32_t nbPixels) {
+  // Write 2 pixels at a time once the buffer is word aligned
+  if (nbPixels > 0 && (reinterpret_cast<uintptr_t>(buffer) & 0x3) != 0) {
+    *buffer++ = color;
+    nbPixels--;
+  }
+  uint32_t pattern = (static_cast<uint32_t>(color.full) << 16) | color.full;
+  auto* words = reinterpret_cast<uint32_t*>(buffer);
+  for (; nbPixels >= 2; nbPixels -= 2) {
+    *words++ = pattern;
+  }
+  if (nbPixels > 0) {
+    *reinterpret_cast<lv_color_t*>(words) = color;
+  }
+}
+
+lv_color_t RleImageDecoder::Clut8(uint8_t index) {
+  // wasp-os reference CLUT (see clut8_rgb888() in tools/rle_encode.py): the 216 web-safe colours,
+  // 36 brighter colours and 4 greys.
+  uint8_t r, g, b;
+  if (index < 216) {
+    b = (index % 6) * 0x33;
+    g = ((index / 6) % 6) * 0x33;
+    r = (index / 36) * 0x33;
+  } else if (index < 252) {
+    index -= 216;
+    b = 0x7f + (index % 3) * 0x33;
+    g = 0x4c + ((index / 3) % 4) * 0x33;
+    r = 0x7f + (index / 12) * 0x33;
+  } else {
+    index -= 252;
+    r = g = b = 0x2c + 0x10 * index;
+  }
+  return LV_COLOR_MAKE(r, g, b);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <lvgl/lvgl.h>
+
+namespace Pinetime {
+  namespace Components {
+    /* LVGL image decoder for the RLE formats generated by tools/rle_encode.py (from wasp-os):
+     *  - LV_IMG_CF_USER_ENCODED_0 : 1-bit RLE, white on black (use the image recolor style to change the colours).
+     *    The data is the list of run lengths, alternating between the 2 colours, starting with black.
+     *  - LV_IMG_CF_USER_ENCODED_1 : 2-bit RLE with a reprogrammable palette of 4 colours from the wasp-os 8-bit CLUT.
+     *    The data starts with its descriptor (2, width, height).
+     *
+     * Images are decoded line by line, straight into the buffer provided by LVGL, and are never decoded as a whole.
+     * The position in the stream is kept between lines, so that drawing the image from top to bottom decodes it only
+     * once.
+     */
+    class RleImageDecoder {
+    public:
+      static constexpr lv_img_cf_t Rle1Bit = LV_IMG_CF_USER_ENCODED_0;
+      static constexpr lv_img_cf_t Rle2BitClut8 = LV_IMG_CF_USER_ENCODED_1;
+
+      void Init();
+
+      // Decoder state of an opened image
+      struct Cursor {
+        const uint8_t* data;
+        size_t size;
+        size_t index;
+        lv_img_cf_t format;
+        uint16_t width;
+        uint16_t row;
+        uint32_t runRemaining;
+        lv_color_t runColor;
+        uint8_t nextColor;
+        lv_color_t palette[4];
+      };
+
+      static bool Reset(Cursor& cursor, const lv_img_dsc_t& image);
+      static bool ReadLine(Cursor& cursor, lv_coord_t x, lv_coord_t y, lv_coord_t len, lv_color_t* buffer);
+
+    private:
+      static bool NextRun(Cursor& cursor);
+      static bool Skip(Cursor& cursor, uint32_t nbPixels);
+      static bool Emit(Cursor& cursor, uint32_t nbPixels, lv_color_t* buffer);
+      static void Fill(lv_color_t* buffer, lv_color_t color, uint32_t nbPixels);
+      static lv_color_t Clut8(uint8_t index);
+    };
+  }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "displayapp/screens/Screen.h"
+
+#ifndef SCREEN_ARENA
+  #define SCREEN_ARENA 1
+#endif
+
+namespace Pinetime {
+  namespace Applications {
+    // Destroys a screen created by DisplayApp, and gives its slot back to the screen arena
+    struct ScreenDeleter {
+      void operator()(Screens::Screen* screen) const;
+    };
+
+    using ScreenPtr = std::unique_ptr<Screens::Screen, ScreenDeleter>;
+
+    /* Storage of the screens created by DisplayApp, reserved at build time: NbSlots slots, each one as large as the
+     * largest of the screen types. Creating a screen constructs it in place in a free slot, destroying it releases
+     * the slot.
+     *
+     * The screens used to be allocated in the C heap (__HEAP_SIZE), between the strings, functions and sub-screens
+     * allocated by the screens themselves, which fragmented it a bit more at each app switch.
+     */
+    template <size_t NbSlots, class... Types> class ScreenArena {
+    public:
+      static constexpr size_t nbSlots = NbSlots;
+      static constexpr size_t slotSize = std::max({sizeof(Types)...});
+      static constexpr size_t slotAlignment = std::max({alignof(Types)...});
+
+      // Returns nullptr if all the slots are used
+      template <class T, class... Args> T* Create(Args&&... args) {
+        static_assert((std::is_same_v<T, Types> || ...), "The screen type must be in the list of the types of the arena");
+        for (size_t i = 0; i < nbSlots; i++) {
+          if (!used[i]) {
+            used[i] = true;
+            nbUsed++;
+            maxUsed = std::max(maxUsed, nbUsed);
+            return new (slots[i].bytes) T(std::forward<Args>(args)...);
+          }
+        }
+        return nullptr;
+      }
+
+      // Called once the screen at address (which may be the address of a base class of the screen) is destroyed
+      void Release(const void* address) {
+        auto* byte = static_cast<const uint8_t*>(address);
+        for (size_t i = 0; i < nbSlots; i++) {
+          if (byte >= slots[i].bytes && byte < slots[i].bytes + slotSize) {
+            used[i] = false;
+            nbUsed--;
+            return;
+          }
+        }
+      }
+
+      uint8_t GetMaxUsedSlots() const {
+        return maxUsed;
+      }
+
+    private:
+      struct Slot {
+        alignas(slotAlignment) uint8_t bytes[slotSize];
+      };
+
+      Slot slots[nbSlots];
+      bool used[nbSlots] = {};
+      uint8_t nbUsed = 0;
+      uint8_t maxUsed = 0;
+    };
+  }
+}
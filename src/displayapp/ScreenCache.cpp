@@ -0,0 +1,95 @@
+#include "displayapp/ScreenCache.h"
+#include <libraries/log/nrf_log.h>
+#include "displayapp/LvglMemory.h"
+
+using namespace Pinetime::Applications;
+
+uint32_t ScreenCache::UsedLvglMemory() {
+  return Components::LvglMemory::GetStatistics().used;
+}
+
+bool ScreenCache::Retain(Apps app, ScreenPtr& screen, uint32_t memory) {
+  if (!IsCacheable(app) || memory > budget || !screen->IsRunning()) {
+    return false;
+  }
+
+  while (GetMemory() + memory > budget) {
+    Entry* oldest = nullptr;
+    for (auto& entry : entries) {
+      if (entry.screen != nullptr && (oldest == nullptr || entry.retainedAt < oldest->retainedAt)) {
+        oldest = &entry;
+      }
+    }
+    Destroy(*oldest);
+  }
+
+  for (auto& entry : entries) {
+    if (entry.screen == nullptr) {
+      entry.app = app;
+      entry.screen = std::move(screen);
+      entry.lvglScreen = lv_scr_act();
+      entry.memory = memory;
+      entry.retainedAt = nbRetained++;
+      // The next app creates its objects on the active screen
+      lv_scr_load(lv_obj_create(nullptr, nullptr));
+      NRF_LOG_INFO("[ScreenCache] App %d retained : %d bytes (%d/%d)", static_cast<uint8_t>(app), memory, GetMemory(), budget);
+      return true;
+    }
+  }
+  return false;
+}
+
+ScreenPtr ScreenCache::Restore(Apps app, uint32_t& memory) {
+  for (auto& entry : entries) {
+    if (entry.screen == nullptr || entry.app != app) {
+      continue;
+    }
+    if (!entry.screen->CanBeRestored()) {
+      Destroy(entry);
+      return nullptr;
+    }
+
+    // The objects of the previous app were deleted with it, only its empty LVGL screen remains
+    lv_obj_t* previous = lv_scr_act();
+    lv_scr_load(entry.lvglScreen);
+    lv_obj_del(previous);
+
+    memory = entry.memory;
+    entry.app = Apps::None;
+    entry.lvglScreen = nullptr;
+    entry.memory = 0;
+    return std::move(entry.screen);
+  }
+  return nullptr;
+}
+
+void ScreenCache::Clear() {
+  for (auto& entry : entries) {
+    if (entry.screen != nullptr) {
+      Destroy(entry);
+    }
+  }
+}
+
+uint32_t ScreenCache::GetMemory() const {
+  uint32_t memory = 0;
+  for (const auto& entry : entries) {
+    if (entry.screen != nullptr) {
+      memory += entry.memory;
+    }
+  }
+  return memory;
+}
+
+void ScreenCache::Destroy(Entry& entry) {
+  // The screens delete the objects of the active LVGL screen when they are destroyed
+  lv_obj_t* active = lv_scr_act();
+  lv_scr_load(entry.lvglScreen);
+  entry.screen.reset();
+  lv_scr_load(active);
+  lv_obj_del(entry.lvglScreen);
+
+  entry.app = Apps::None;
+  entry.lvglScreen = nullptr;
+  entry.memory = 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <lvgl/lvgl.h>
+#include "displayapp/Apps.h"
+#include "displayapp/ScreenArena.h"
+
+#ifndef SCREEN_CACHE_BUDGET
+  #define SCREEN_CACHE_BUDGET 4096
+#endif
+
+namespace Pinetime {
+  namespace Applications {
+    /* Keeps the screens of the apps the user goes back to all the time (the watch face and the launcher) alive while
+     * another app is shown, so that going back to them only loads their LVGL screen instead of creating all their
+     * objects again.
+     *
+     * A retained screen keeps its objects on its own LVGL screen, and the next app is created on a new one. The LVGL
+     * memory used by the retained screens (measured when they were created) is not available to the other apps: it is
+     * limited to budget bytes, the screen retained first being destroyed first. A budget of 0 disables the cache.
+     */
+    class ScreenCache {
+    public:
+      static constexpr uint32_t budget = SCREEN_CACHE_BUDGET;
+      // Number of screens retained at most
+      static constexpr size_t maxScreens = budget > 0 ? 2 : 0;
+
+      static constexpr bool IsCacheable(Apps app) {
+        return budget > 0 && (app == Apps::Clock || app == Apps::Launcher);
+      }
+
+      // LVGL memory in use, to measure the memory used by a screen when it is created
+      static uint32_t UsedLvglMemory();
+
+      // Keeps screen, which is the current screen of app and uses memory bytes of LVGL memory, and makes a new empty LVGL
+      // screen active for the next app. Returns false (and leaves screen untouched) if it is not retained.
+      bool Retain(Apps app, ScreenPtr& screen, uint32_t memory);
+
+      // Returns the screen retained for app and makes its LVGL screen the active one, or nullptr if there is none.
+      // Must be called once the current screen is destroyed.
+      ScreenPtr Restore(Apps app, uint32_t& memory);
+
+      void Clear();
+
+      uint32_t GetMemory() const;
+
+    private:
+      struct Entry {
+        Apps app = Apps::None;
+        ScreenPtr screen;
+        lv_obj_t* lvglScreen = nullptr;
+        uint32_t memory = 0;
+        uint32_t retainedAt = 0;
+      };
+
+      void Destroy(Entry& entry);
+
+      std::array<Entry, maxScreens> entries;
+      uint32_t nbRetained = 0;
+    };
+  }
+}
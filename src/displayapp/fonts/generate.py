@@ -18,8 +18,8 @@ class Source(object):
         self.symbols = d.get('symbols')
 
 
-def gen_lvconv_line(lv_font_conv: str, dest: str, size: int, bpp: int, sources: typing.List[Source], compress:bool=False):
-    args = [lv_font_conv, '--size', str(size), '--output', dest, '--bpp', str(bpp), '--format', 'lvgl']
+def gen_lvconv_line(lv_font_conv: str, dest: str, size: int, bpp: int, sources: typing.List[Source], compress:bool=False, format:str='lvgl'):
+    args = [lv_font_conv, '--size', str(size), '--output', dest, '--bpp', str(bpp), '--format', format]
     if not compress:
         args.append('--no-compress')
     for source in sources:
@@ -63,7 +63,8 @@ def main():
         sources = font.pop('sources')
         patches = font.pop('patches') if 'patches' in font else  []
         font['sources'] = [Source(thing) for thing in sources]
-        line = gen_lvconv_line(args.lv_font_conv, f'{name}.c', **font)
+        extension = 'bin' if font.get('format') == 'bin' else 'c'
+        line = gen_lvconv_line(args.lv_font_conv, f'{name}.{extension}', **font)
         subprocess.check_call(line)
         if patches:
             for patch in patches:
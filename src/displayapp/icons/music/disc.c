@@ -19,92 +19,37 @@
 
 #include "lvgl/lvgl.h"
 
-#ifndef LV_ATTRIBUTE_MEM_ALIGN
-#define LV_ATTRIBUTE_MEM_ALIGN
-#endif
-
-#ifndef LV_ATTRIBUTE_IMG_DISC
-#define LV_ATTRIBUTE_IMG_DISC
-#endif
-
-const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_IMG_DISC uint8_t disc_map[] = {
-    0xbd, 0xc1, 0xbe, 0xff,  /* Color of index 0: foreground */
-    0x00, 0x00, 0x00, 0x00,  /* Color of index 1: background */
-    
-    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xc0, 0x01, 0xff, 0xff, 0xff,
-    0xff, 0xff, 0xfc, 0x00, 0x00, 0x1f, 0xff, 0xff,
-    0xff, 0xff, 0xf0, 0x0f, 0xf8, 0x07, 0xff, 0xff,
-    0xff, 0xff, 0xc0, 0xff, 0xff, 0x81, 0xff, 0xff,
-    0xff, 0xff, 0x07, 0xff, 0xff, 0xf0, 0x7f, 0xff,
-    0xff, 0xfc, 0x1f, 0xff, 0xff, 0xfc, 0x1f, 0xff,
-    0xff, 0xf8, 0x7f, 0xff, 0xff, 0xff, 0x0f, 0xff,
-    0xff, 0xf0, 0xff, 0xff, 0xff, 0xff, 0x87, 0xff,
-    0xff, 0xe3, 0xff, 0xff, 0xff, 0xff, 0xe3, 0xff,
-    0xff, 0xc7, 0xff, 0xff, 0xff, 0xff, 0xf1, 0xff,
-    0xff, 0x8f, 0xff, 0xff, 0xff, 0xff, 0xf8, 0xff,
-    0xff, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xfc, 0x7f,
-    0xfe, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xfe, 0x3f,
-    0xfc, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1f,
-    0xfc, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1f,
-    0xf8, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x8f,
-    0xf9, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xcf,
-    0xf1, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xc7,
-    0xf3, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe7,
-    0xe3, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe3,
-    0xe7, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf3,
-    0xc7, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf1,
-    0xc7, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf1,
-    0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf9,
-    0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf9,
-    0x8f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8,
-    0x8f, 0xff, 0xff, 0xf8, 0x0f, 0xff, 0xff, 0xf8,
-    0x9f, 0xff, 0xff, 0xf0, 0x07, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xe3, 0xe3, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xe7, 0xf3, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xe7, 0xf3, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xe7, 0xf3, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xe7, 0xf3, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xe7, 0xf3, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xe3, 0xe3, 0xff, 0xff, 0xfc,
-    0x9f, 0xff, 0xff, 0xf0, 0x07, 0xff, 0xff, 0xfc,
-    0x8f, 0xff, 0xff, 0xf8, 0x0f, 0xff, 0xff, 0xf8,
-    0x8f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf8,
-    0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf9,
-    0xcf, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf9,
-    0xc7, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf1,
-    0xc7, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf1,
-    0xe7, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xf3,
-    0xe3, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe3,
-    0xf3, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xe7,
-    0xf1, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xc7,
-    0xf9, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xcf,
-    0xf8, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x8f,
-    0xfc, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1f,
-    0xfc, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0x1f,
-    0xfe, 0x3f, 0xff, 0xff, 0xff, 0xff, 0xfe, 0x3f,
-    0xff, 0x1f, 0xff, 0xff, 0xff, 0xff, 0xfc, 0x7f,
-    0xff, 0x8f, 0xff, 0xff, 0xff, 0xff, 0xf8, 0xff,
-    0xff, 0xc7, 0xff, 0xff, 0xff, 0xff, 0xf1, 0xff,
-    0xff, 0xe3, 0xff, 0xff, 0xff, 0xff, 0xe3, 0xff,
-    0xff, 0xf0, 0xff, 0xff, 0xff, 0xff, 0x87, 0xff,
-    0xff, 0xf8, 0x7f, 0xff, 0xff, 0xff, 0x0f, 0xff,
-    0xff, 0xfc, 0x1f, 0xff, 0xff, 0xfc, 0x1f, 0xff,
-    0xff, 0xff, 0x07, 0xff, 0xff, 0xf0, 0x7f, 0xff,
-    0xff, 0xff, 0xc0, 0xff, 0xff, 0x81, 0xff, 0xff,
-    0xff, 0xff, 0xf0, 0x0f, 0xf8, 0x07, 0xff, 0xff,
-    0xff, 0xff, 0xfc, 0x00, 0x00, 0x1f, 0xff, 0xff,
-    0xff, 0xff, 0xff, 0xc0, 0x01, 0xff, 0xff, 0xff,
+// Drawn by RleImageDecoder. Generated with:
+//   tools/rle_encode.py --lvgl --2bit --black 6cfc6a disc.png
+// 2-bit RLE, generated from disc.png, 287 bytes
+static const uint8_t disc[] = {
+  0x2, 0x40, 0x40, 0x3f, 0x1b, 0x40, 0xac, 0x4d, 0x2f, 0x55, 0x29, 0x48,
+  0x9, 0x48, 0x25, 0x46, 0x11, 0x46, 0x21, 0x45, 0x17, 0x45, 0x1d, 0x45,
+  0x1b, 0x45, 0x1a, 0x44, 0x1f, 0x44, 0x18, 0x44, 0x21, 0x44, 0x16, 0x43,
+  0x25, 0x43, 0x14, 0x43, 0x27, 0x43, 0x12, 0x43, 0x29, 0x43, 0x10, 0x43,
+  0x2b, 0x43, 0xe, 0x43, 0x2d, 0x43, 0xc, 0x43, 0x2f, 0x43, 0xb, 0x43,
+  0x2f, 0x43, 0xa, 0x43, 0x31, 0x43, 0x9, 0x42, 0x33, 0x42, 0x8, 0x43,
+  0x33, 0x43, 0x7, 0x42, 0x35, 0x42, 0x6, 0x43, 0x35, 0x43, 0x5, 0x42,
+  0x37, 0x42, 0x4, 0x43, 0x37, 0x43, 0x3, 0x43, 0x37, 0x43, 0x3, 0x42,
+  0x39, 0x42, 0x3, 0x42, 0x39, 0x42, 0x2, 0x43, 0x39, 0x43, 0x1, 0x43,
+  0x19, 0x47, 0x19, 0x43, 0x1, 0x42, 0x19, 0x49, 0x19, 0x42, 0x1, 0x42,
+  0x18, 0x43, 0x5, 0x43, 0x18, 0x42, 0x1, 0x42, 0x18, 0x42, 0x7, 0x42,
+  0x18, 0x42, 0x1, 0x42, 0x18, 0x42, 0x7, 0x42, 0x18, 0x42, 0x1, 0x42,
+  0x18, 0x42, 0x7, 0x42, 0x18, 0x42, 0x1, 0x42, 0x18, 0x42, 0x7, 0x42,
+  0x18, 0x42, 0x1, 0x42, 0x18, 0x42, 0x7, 0x42, 0x18, 0x42, 0x1, 0x42,
+  0x18, 0x43, 0x5, 0x43, 0x18, 0x42, 0x1, 0x42, 0x19, 0x49, 0x19, 0x42,
+  0x1, 0x43, 0x19, 0x47, 0x19, 0x43, 0x1, 0x43, 0x39, 0x43, 0x2, 0x42,
+  0x39, 0x42, 0x3, 0x42, 0x39, 0x42, 0x3, 0x43, 0x37, 0x43, 0x3, 0x43,
+  0x37, 0x43, 0x4, 0x42, 0x37, 0x42, 0x5, 0x43, 0x35, 0x43, 0x6, 0x42,
+  0x35, 0x42, 0x7, 0x43, 0x33, 0x43, 0x8, 0x42, 0x33, 0x42, 0x9, 0x43,
+  0x31, 0x43, 0xa, 0x43, 0x2f, 0x43, 0xb, 0x43, 0x2f, 0x43, 0xc, 0x43,
+  0x2d, 0x43, 0xe, 0x43, 0x2b, 0x43, 0x10, 0x43, 0x29, 0x43, 0x12, 0x43,
+  0x27, 0x43, 0x14, 0x43, 0x25, 0x43, 0x16, 0x44, 0x21, 0x44, 0x18, 0x44,
+  0x1f, 0x44, 0x1a, 0x45, 0x1b, 0x45, 0x1d, 0x45, 0x17, 0x45, 0x21, 0x46,
+  0x11, 0x46, 0x25, 0x48, 0x9, 0x48, 0x29, 0x55, 0x2f, 0x4d, 0x19,
+};
+const lv_img_dsc_t disc_img = {
+  {LV_IMG_CF_USER_ENCODED_1, 0, 0, 64, 64},
+  sizeof(disc),
+  disc
 };
-
-const lv_img_dsc_t disc = {
-    {
-        LV_IMG_CF_INDEXED_1BIT,
-        0,
-        0,
-        64,
-        64
-    },
-    520,
-    disc_map
-};
\ No newline at end of file
@@ -36,6 +36,11 @@ bool ApplicationList::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
   return screens.OnTouchEvent(event);
 }
 
+bool ApplicationList::CanBeRestored() const {
+  // The launcher opens on the page of the menu saved in the settings (the first one when coming from the watch face)
+  return running && screens.GetScreenIndex() == settingsController.GetAppMenu();
+}
+
 std::unique_ptr<Screen> ApplicationList::CreateScreen(unsigned int screenNum) const {
   return std::make_unique<Screens::Tile>(screenNum, nScreens, app, settingsController, batteryController, dateTimeController, applications[screenNum]);
 }
@@ -21,6 +21,7 @@ namespace Pinetime {
                                  Controllers::DateTime& dateTimeController);
         ~ApplicationList() override;
         bool OnTouchEvent(TouchEvents event) override;
+        bool CanBeRestored() const override;
 
       private:
         auto CreateScreenList() const;
@@ -31,8 +31,9 @@ Clock::Clock(DisplayApp* app,
     settingsController {settingsController},
     heartRateController {heartRateController},
     motionController {motionController},
-    screen {[this, &settingsController]() {
-      switch (settingsController.GetClockFace()) {
+    clockFace {settingsController.GetClockFace()},
+    screen {[this]() {
+      switch (clockFace) {
         case 0:
           return WatchFaceDigitalScreen();
           break;
@@ -55,6 +56,11 @@ Clock::~Clock() {
   lv_obj_clean(lv_scr_act());
 }
 
+bool Clock::CanBeRestored() const {
+  // The watch face may have been changed in the settings since the screen was created
+  return running && settingsController.GetClockFace() == clockFace;
+}
+
 bool Clock::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
   return screen->OnTouchEvent(event);
 }
@@ -34,6 +34,28 @@ namespace Pinetime {
         bool OnTouchEvent(TouchEvents event) override;
         bool OnButtonPushed() override;
 
+        Controllers::TopicSet Subscriptions() const override {
+          return screen->Subscriptions();
+        }
+
+        void OnDataChanged(Controllers::TopicSet topics) override {
+          screen->OnDataChanged(topics);
+        }
+
+        FrameRatePolicy GetFrameRatePolicy() const override {
+          return screen->GetFrameRatePolicy();
+        }
+
+        bool SupportsReducedColorDepth() const override {
+          return screen->SupportsReducedColorDepth();
+        }
+
+        bool GetAlwaysOnArea(lv_area_t& area) const override {
+          return screen->GetAlwaysOnArea(area);
+        }
+
+        bool CanBeRestored() const override;
+
       private:
         Controllers::DateTime& dateTimeController;
         Controllers::Battery& batteryController;
@@ -43,6 +65,7 @@ namespace Pinetime {
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
 
+        uint8_t clockFace;
         std::unique_ptr<Screen> screen;
         std::unique_ptr<Screen> WatchFaceDigitalScreen();
         std::unique_ptr<Screen> WatchFaceAnalogScreen();
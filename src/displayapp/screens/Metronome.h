@@ -16,6 +16,11 @@ namespace Pinetime {
         void OnEvent(lv_obj_t* obj, lv_event_t event);
         bool OnTouchEvent(TouchEvents event) override;
 
+        // The beats are timed by the refresh task
+        FrameRatePolicy GetFrameRatePolicy() const override {
+          return {LV_DISP_DEF_REFR_PERIOD, LV_DISP_DEF_REFR_PERIOD, 0};
+        }
+
       private:
         TickType_t startTime = 0;
         TickType_t tappedTime = 0;
@@ -129,7 +129,7 @@ Music::Music(Pinetime::Applications::DisplayApp* app, Pinetime::Controllers::Mus
 
   /** Init animation */
   imgDisc = lv_img_create(lv_scr_act(), nullptr);
-  lv_img_set_src_arr(imgDisc, &disc);
+  lv_img_set_src_arr(imgDisc, &disc_img);
   lv_obj_align(imgDisc, nullptr, LV_ALIGN_IN_TOP_RIGHT, -15, 15);
 
   imgDiscAnim = lv_img_create(lv_scr_act(), nullptr);
@@ -13,12 +13,14 @@ Notifications::Notifications(DisplayApp* app,
                              Pinetime::Controllers::AlertNotificationService& alertNotificationService,
                              Pinetime::Controllers::MotorController& motorController,
                              System::SystemTask& systemTask,
+                             const lv_font_t* font,
                              Modes mode)
   : Screen(app),
     notificationManager {notificationManager},
     alertNotificationService {alertNotificationService},
     motorController {motorController},
     systemTask {systemTask},
+    font {font},
     mode {mode} {
   notificationManager.ClearNewNotificationFlag();
   auto notification = notificationManager.GetLastNotification();
@@ -30,6 +32,7 @@ Notifications::Notifications(DisplayApp* app,
                                                      notification.category,
                                                      notificationManager.NbNotifications(),
                                                      mode,
+                                                     font,
                                                      alertNotificationService,
                                                      motorController);
     validDisplay = true;
@@ -40,6 +43,7 @@ Notifications::Notifications(DisplayApp* app,
                                                      notification.category,
                                                      notificationManager.NbNotifications(),
                                                      Modes::Preview,
+                                                     font,
                                                      alertNotificationService,
                                                      motorController);
   }
@@ -128,6 +132,7 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
                                                        previousNotification.category,
                                                        notificationManager.NbNotifications(),
                                                        mode,
+                                                       font,
                                                        alertNotificationService,
                                                        motorController);
     }
@@ -154,6 +159,7 @@ bool Notifications::OnTouchEvent(Pinetime::Applications::TouchEvents event) {
                                                        nextNotification.category,
                                                        notificationManager.NbNotifications(),
                                                        mode,
+                                                       font,
                                                        alertNotificationService,
                                                        motorController);
     }
@@ -176,6 +182,7 @@ Notifications::NotificationItem::NotificationItem(const char* title,
                                                   Controllers::NotificationManager::Categories category,
                                                   uint8_t notifNb,
                                                   Modes mode,
+                                                  const lv_font_t* font,
                                                   Pinetime::Controllers::AlertNotificationService& alertNotificationService,
                                                   Pinetime::Controllers::MotorController& motorController)
   : mode {mode}, alertNotificationService {alertNotificationService}, motorController {motorController} {
@@ -198,6 +205,9 @@ Notifications::NotificationItem::NotificationItem(const char* title,
 
   lv_obj_t* alert_type = lv_label_create(lv_scr_act(), nullptr);
   lv_obj_set_style_local_text_color(alert_type, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_MAKE(0xb0, 0xb0, 0xb0));
+  if (font != nullptr) {
+    lv_obj_set_style_local_text_font(alert_type, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, font);
+  }
   if (title == nullptr) {
     lv_label_set_text_static(alert_type, "Notification");
   } else {
@@ -221,6 +231,9 @@ Notifications::NotificationItem::NotificationItem(const char* title,
       lv_obj_set_style_local_text_color(alert_subject, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, LV_COLOR_MAKE(0xff, 0xb0, 0x0));
       lv_label_set_long_mode(alert_subject, LV_LABEL_LONG_BREAK);
       lv_obj_set_width(alert_subject, LV_HOR_RES - 20);
+      if (font != nullptr) {
+        lv_obj_set_style_local_text_font(alert_subject, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, font);
+      }
       lv_label_set_text(alert_subject, msg);
     } break;
     case Controllers::NotificationManager::Categories::IncomingCall: {
@@ -235,6 +248,9 @@ Notifications::NotificationItem::NotificationItem(const char* title,
       lv_obj_align(alert_caller, alert_subject, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 0);
       lv_label_set_long_mode(alert_caller, LV_LABEL_LONG_BREAK);
       lv_obj_set_width(alert_caller, LV_HOR_RES - 20);
+      if (font != nullptr) {
+        lv_obj_set_style_local_text_font(alert_caller, LV_LABEL_PART_MAIN, LV_STATE_DEFAULT, font);
+      }
       lv_label_set_text(alert_caller, msg);
 
       bt_accept = lv_btn_create(lv_scr_act(), nullptr);
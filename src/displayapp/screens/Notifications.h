@@ -24,6 +24,7 @@ namespace Pinetime {
                                Pinetime::Controllers::AlertNotificationService& alertNotificationService,
                                Pinetime::Controllers::MotorController& motorController,
                                System::SystemTask& systemTask,
+                               const lv_font_t* font,
                                Modes mode);
         ~Notifications() override;
 
@@ -39,6 +40,7 @@ namespace Pinetime {
                            Controllers::NotificationManager::Categories,
                            uint8_t notifNb,
                            Modes mode,
+                           const lv_font_t* font,
                            Pinetime::Controllers::AlertNotificationService& alertNotificationService,
                            Pinetime::Controllers::MotorController& motorController);
           ~NotificationItem();
@@ -66,6 +68,7 @@ namespace Pinetime {
         Pinetime::Controllers::AlertNotificationService& alertNotificationService;
         Pinetime::Controllers::MotorController& motorController;
         System::SystemTask& systemTask;
+        const lv_font_t* font;
         Modes mode = Modes::Normal;
         std::unique_ptr<NotificationItem> currentItem;
         Controllers::NotificationManager::Notification::Id currentId;
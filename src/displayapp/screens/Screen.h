@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include "displayapp/TouchEvents.h"
+#include "components/datachanges/DataChanges.h"
 #include <lvgl/lvgl.h>
 
 namespace Pinetime {
@@ -38,6 +39,15 @@ namespace Pinetime {
         bool isUpdated {true}; // NSDMI - use brace initialisation
       };
 
+      // How often the display task runs for a screen, see FrameRateGovernor
+      struct FrameRatePolicy {
+        // Refresh period of LVGL while it animates, scrolls or is touched
+        uint16_t activePeriodMs;
+        // Period of the display task when nothing changed during holdTimeMs
+        uint16_t staticPeriodMs;
+        uint16_t holdTimeMs;
+      };
+
       class Screen {
       private:
         virtual void Refresh() {
@@ -68,6 +78,36 @@ namespace Pinetime {
           return false;
         }
 
+        /** @return the topics the screen is refreshed on, instead of polling the controllers in a refresh task. The display
+         * task sleeps while none of them is published and LVGL has nothing to render */
+        virtual Controllers::TopicSet Subscriptions() const {
+          return 0;
+        }
+
+        /** Called by the display task when topics the screen subscribed to were published */
+        virtual void OnDataChanged(Controllers::TopicSet topics) {
+          Refresh();
+        }
+
+        virtual FrameRatePolicy GetFrameRatePolicy() const {
+          return {LV_DISP_DEF_REFR_PERIOD, 100, 300};
+        }
+
+        /** @return true if the screen looks the same with 12 bits colours, which are faster to send to the display */
+        virtual bool SupportsReducedColorDepth() const {
+          return false;
+        }
+
+        /** @return true if the screen, kept by the screen cache while another app was shown, can be shown again as it is */
+        virtual bool CanBeRestored() const {
+          return running;
+        }
+
+        /** @return true if the screen can stay on while the watch sleeps, with only area being displayed and refreshed */
+        virtual bool GetAlwaysOnArea(lv_area_t& area) const {
+          return false;
+        }
+
       protected:
         DisplayApp* app;
         bool running = true;
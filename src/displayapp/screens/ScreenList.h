@@ -34,6 +34,10 @@ namespace Pinetime {
           lv_obj_clean(lv_scr_act());
         }
 
+        uint8_t GetScreenIndex() const {
+          return screenIndex;
+        }
+
         bool OnTouchEvent(TouchEvents event) override {
 
           if (mode == ScreenListModes::UpDown) {
@@ -4,6 +4,7 @@
 #include <lvgl/lvgl.h>
 #include "displayapp/DisplayApp.h"
 #include "displayapp/screens/Label.h"
+#include "displayapp/LvglMemory.h"
 #include "Version.h"
 #include "BootloaderVersion.h"
 #include "components/battery/BatteryController.h"
@@ -170,8 +171,7 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen2() {
 }
 
 std::unique_ptr<Screen> SystemInfo::CreateScreen3() {
-  lv_mem_monitor_t mon;
-  lv_mem_monitor(&mon);
+  auto lvglMemory = Components::LvglMemory::GetStatistics();
 
   lv_obj_t* label = lv_label_create(lv_scr_act(), nullptr);
   lv_label_set_recolor(label, true);
@@ -181,21 +181,23 @@ std::unique_ptr<Screen> SystemInfo::CreateScreen3() {
                         " %02x:%02x:%02x:%02x:%02x:%02x"
                         "\n"
                         "#808080 LVGL Memory#\n"
-                        " #808080 used# %d (%d%%)\n"
+                        " #808080 used# %lu (%d%%)\n"
                         " #808080 max used# %lu\n"
-                        " #808080 frag# %d%%\n"
-                        " #808080 free# %d",
+                        " #808080 free# %lu\n"
+                        " #808080 largest# %lu\n"
+                        " #808080 frag# %d%%",
                         bleAddr[5],
                         bleAddr[4],
                         bleAddr[3],
                         bleAddr[2],
                         bleAddr[1],
                         bleAddr[0],
-                        static_cast<int>(mon.total_size - mon.free_size),
-                        mon.used_pct,
-                        mon.max_used,
-                        mon.frag_pct,
-                        static_cast<int>(mon.free_biggest_size));
+                        lvglMemory.used,
+                        lvglMemory.usedPercent,
+                        lvglMemory.maxUsed,
+                        lvglMemory.free,
+                        lvglMemory.largestFree,
+                        lvglMemory.fragmentation);
   lv_obj_align(label, lv_scr_act(), LV_ALIGN_CENTER, 0, 0);
   return std::make_unique<Screens::Label>(2, 5, app, label);
 }
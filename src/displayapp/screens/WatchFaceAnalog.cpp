@@ -1,5 +1,7 @@
 #include "displayapp/screens/WatchFaceAnalog.h"
-#include <cmath>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <lvgl/lvgl.h>
 #include "displayapp/screens/BatteryIcon.h"
 #include "displayapp/screens/BleIcon.h"
@@ -15,31 +17,79 @@ namespace {
   constexpr int16_t HourLength = 70;
   constexpr int16_t MinuteLength = 90;
   constexpr int16_t SecondLength = 110;
+  constexpr int16_t SecondTailLength = -20;
+  constexpr int16_t BodyStart = 30;
+  constexpr int16_t TraceStart = 5;
+  constexpr int16_t TraceEnd = 31;
 
-  // sin(90) = 1 so the value of _lv_trigo_sin(90) is the scaling factor
-  const auto LV_TRIG_SCALE = _lv_trigo_sin(90);
+  constexpr lv_coord_t BodyWidth = 7;
+  constexpr lv_coord_t TraceWidth = 3;
+  constexpr lv_coord_t SecondWidth = 3;
 
-  int16_t Cosine(int16_t angle) {
-    return _lv_trigo_sin(angle + 90);
-  }
+  // Length of the strips invalidated along the hands. Both the old and the new position of every hand fit in
+  // LV_INV_BUF_SIZE (32) areas, when they all move at the same time.
+  constexpr lv_coord_t StripLength = 24;
+
+  // The hands have 60 positions, 6 degrees apart, clockwise from 12 o'clock
+  constexpr uint8_t NbPositions = 60;
+  using HandPositions = std::array<lv_point_t, NbPositions>;
+
+  constexpr double Pi = 3.14159265358979323846;
 
-  int16_t Sine(int16_t angle) {
-    return _lv_trigo_sin(angle);
+  // Taylor series of sin(), only evaluated at build time, for 0 <= angle < 2 * Pi
+  constexpr double Sine(double angle) {
+    if (angle > Pi) {
+      angle -= 2 * Pi;
+    }
+    double term = angle;
+    double sum = angle;
+    for (int n = 1; n < 10; n++) {
+      term *= -angle * angle / ((2 * n) * (2 * n + 1));
+      sum += term;
+    }
+    return sum;
   }
 
-  int16_t CoordinateXRelocate(int16_t x) {
-    return (x + LV_HOR_RES / 2);
+  constexpr int16_t Round(double value) {
+    return static_cast<int16_t>(value < 0 ? value - 0.5 : value + 0.5);
   }
 
-  int16_t CoordinateYRelocate(int16_t y) {
-    return std::abs(y - LV_HOR_RES / 2);
+  constexpr HandPositions MakeHandPositions(int16_t radius) {
+    HandPositions positions {};
+    for (uint8_t i = 0; i < NbPositions; i++) {
+      double angle = 2 * Pi * i / NbPositions;
+      positions[i].x = static_cast<lv_coord_t>(LV_HOR_RES_MAX / 2 + Round(radius * Sine(angle)));
+      positions[i].y = static_cast<lv_coord_t>(LV_VER_RES_MAX / 2 - Round(radius * Sine(angle + Pi / 2)));
+    }
+    return positions;
   }
 
-  lv_point_t CoordinateRelocate(int16_t radius, int16_t angle) {
-    return lv_point_t {.x = CoordinateXRelocate(radius * static_cast<int32_t>(Sine(angle)) / LV_TRIG_SCALE),
-                       .y = CoordinateYRelocate(radius * static_cast<int32_t>(Cosine(angle)) / LV_TRIG_SCALE)};
+  constexpr HandPositions hourEnd = MakeHandPositions(HourLength);
+  constexpr HandPositions minuteEnd = MakeHandPositions(MinuteLength);
+  constexpr HandPositions bodyStart = MakeHandPositions(BodyStart);
+  constexpr HandPositions traceStart = MakeHandPositions(TraceStart);
+  constexpr HandPositions traceEnd = MakeHandPositions(TraceEnd);
+  constexpr HandPositions secondEnd = MakeHandPositions(SecondLength);
+  constexpr HandPositions secondTail = MakeHandPositions(SecondTailLength);
+
+  // Area covered by a segment of a hand: the rounded ends (and the antialiasing) go up to half the width beyond the points
+  lv_area_t SegmentArea(const lv_point_t& start, const lv_point_t& end, lv_coord_t width) {
+    lv_coord_t pad = width / 2 + 1;
+    return {static_cast<lv_coord_t>(std::min(start.x, end.x) - pad),
+            static_cast<lv_coord_t>(std::min(start.y, end.y) - pad),
+            static_cast<lv_coord_t>(std::max(start.x, end.x) + pad),
+            static_cast<lv_coord_t>(std::max(start.y, end.y) + pad)};
   }
 
+  // The points of the hands are updated in place: the lines cover the whole screen so that LVGL does not resize them
+  // and invalidate their bounding boxes, the strips around the hands are invalidated instead.
+  lv_obj_t* CreateHand(const lv_point_t* points) {
+    lv_obj_t* hand = lv_line_create(lv_scr_act(), nullptr);
+    lv_line_set_auto_size(hand, false);
+    lv_obj_set_size(hand, LV_HOR_RES_MAX, LV_VER_RES_MAX);
+    lv_line_set_points(hand, points, 2);
+    return hand;
+  }
 }
 
 WatchFaceAnalog::WatchFaceAnalog(Pinetime::Applications::DisplayApp* app,
@@ -59,6 +109,7 @@ WatchFaceAnalog::WatchFaceAnalog(Pinetime::Applications::DisplayApp* app,
   sHour = 99;
   sMinute = 99;
   sSecond = 99;
+  hourPosition = 99;
 
   lv_obj_t* bg_clock_img = lv_img_create(lv_scr_act(), NULL);
   lv_img_set_src(bg_clock_img, &bg_clock);
@@ -85,50 +136,46 @@ WatchFaceAnalog::WatchFaceAnalog(Pinetime::Applications::DisplayApp* app,
   lv_label_set_align(label_date_day, LV_LABEL_ALIGN_CENTER);
   lv_obj_align(label_date_day, NULL, LV_ALIGN_CENTER, 50, 0);
 
-  minute_body = lv_line_create(lv_scr_act(), NULL);
-  minute_body_trace = lv_line_create(lv_scr_act(), NULL);
-  hour_body = lv_line_create(lv_scr_act(), NULL);
-  hour_body_trace = lv_line_create(lv_scr_act(), NULL);
-  second_body = lv_line_create(lv_scr_act(), NULL);
+  minute_body = CreateHand(minute_point);
+  minute_body_trace = CreateHand(minute_point_trace);
+  hour_body = CreateHand(hour_point);
+  hour_body_trace = CreateHand(hour_point_trace);
+  second_body = CreateHand(second_point);
 
   lv_style_init(&second_line_style);
-  lv_style_set_line_width(&second_line_style, LV_STATE_DEFAULT, 3);
+  lv_style_set_line_width(&second_line_style, LV_STATE_DEFAULT, SecondWidth);
   lv_style_set_line_color(&second_line_style, LV_STATE_DEFAULT, LV_COLOR_RED);
   lv_style_set_line_rounded(&second_line_style, LV_STATE_DEFAULT, true);
   lv_obj_add_style(second_body, LV_LINE_PART_MAIN, &second_line_style);
 
   lv_style_init(&minute_line_style);
-  lv_style_set_line_width(&minute_line_style, LV_STATE_DEFAULT, 7);
+  lv_style_set_line_width(&minute_line_style, LV_STATE_DEFAULT, BodyWidth);
   lv_style_set_line_color(&minute_line_style, LV_STATE_DEFAULT, LV_COLOR_WHITE);
   lv_style_set_line_rounded(&minute_line_style, LV_STATE_DEFAULT, true);
   lv_obj_add_style(minute_body, LV_LINE_PART_MAIN, &minute_line_style);
 
   lv_style_init(&minute_line_style_trace);
-  lv_style_set_line_width(&minute_line_style_trace, LV_STATE_DEFAULT, 3);
+  lv_style_set_line_width(&minute_line_style_trace, LV_STATE_DEFAULT, TraceWidth);
   lv_style_set_line_color(&minute_line_style_trace, LV_STATE_DEFAULT, LV_COLOR_WHITE);
   lv_style_set_line_rounded(&minute_line_style_trace, LV_STATE_DEFAULT, false);
   lv_obj_add_style(minute_body_trace, LV_LINE_PART_MAIN, &minute_line_style_trace);
 
   lv_style_init(&hour_line_style);
-  lv_style_set_line_width(&hour_line_style, LV_STATE_DEFAULT, 7);
+  lv_style_set_line_width(&hour_line_style, LV_STATE_DEFAULT, BodyWidth);
   lv_style_set_line_color(&hour_line_style, LV_STATE_DEFAULT, LV_COLOR_WHITE);
   lv_style_set_line_rounded(&hour_line_style, LV_STATE_DEFAULT, true);
   lv_obj_add_style(hour_body, LV_LINE_PART_MAIN, &hour_line_style);
 
   lv_style_init(&hour_line_style_trace);
-  lv_style_set_line_width(&hour_line_style_trace, LV_STATE_DEFAULT, 3);
+  lv_style_set_line_width(&hour_line_style_trace, LV_STATE_DEFAULT, TraceWidth);
   lv_style_set_line_color(&hour_line_style_trace, LV_STATE_DEFAULT, LV_COLOR_WHITE);
   lv_style_set_line_rounded(&hour_line_style_trace, LV_STATE_DEFAULT, false);
   lv_obj_add_style(hour_body_trace, LV_LINE_PART_MAIN, &hour_line_style_trace);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
-
   Refresh();
 }
 
 WatchFaceAnalog::~WatchFaceAnalog() {
-  lv_task_del(taskRefresh);
-
   lv_style_reset(&hour_line_style);
   lv_style_reset(&hour_line_style_trace);
   lv_style_reset(&minute_line_style);
@@ -138,45 +185,62 @@ WatchFaceAnalog::~WatchFaceAnalog() {
   lv_obj_clean(lv_scr_act());
 }
 
+void WatchFaceAnalog::InvalidateHand(const lv_point_t& start, const lv_point_t& end, lv_coord_t width) {
+  // The bounding box of a diagonal hand is most of its square, a few strips along the hand are much smaller
+  lv_coord_t dx = end.x - start.x;
+  lv_coord_t dy = end.y - start.y;
+  lv_coord_t length = std::max(std::abs(dx), std::abs(dy));
+  lv_coord_t nbStrips = std::max<lv_coord_t>(1, (length + StripLength - 1) / StripLength);
+  lv_disp_t* disp = lv_obj_get_disp(second_body);
+
+  lv_point_t from = start;
+  for (lv_coord_t i = 1; i <= nbStrips; i++) {
+    lv_point_t to {static_cast<lv_coord_t>(start.x + dx * i / nbStrips), static_cast<lv_coord_t>(start.y + dy * i / nbStrips)};
+    lv_area_t strip = SegmentArea(from, to, width);
+    _lv_inv_area(disp, &strip);
+    from = to;
+  }
+}
+
 void WatchFaceAnalog::UpdateClock() {
   uint8_t hour = dateTimeController.Hours();
   uint8_t minute = dateTimeController.Minutes();
   uint8_t second = dateTimeController.Seconds();
 
   if (sMinute != minute) {
-    auto const angle = minute * 6;
-    minute_point[0] = CoordinateRelocate(30, angle);
-    minute_point[1] = CoordinateRelocate(MinuteLength, angle);
-
-    minute_point_trace[0] = CoordinateRelocate(5, angle);
-    minute_point_trace[1] = CoordinateRelocate(31, angle);
-
-    lv_line_set_points(minute_body, minute_point, 2);
-    lv_line_set_points(minute_body_trace, minute_point_trace, 2);
+    // The trace and the body overlap: the strips of the whole hand cover both
+    InvalidateHand(minute_point_trace[0], minute_point[1], BodyWidth);
+    minute_point[0] = bodyStart[minute];
+    minute_point[1] = minuteEnd[minute];
+    minute_point_trace[0] = traceStart[minute];
+    minute_point_trace[1] = traceEnd[minute];
+    InvalidateHand(minute_point_trace[0], minute_point[1], BodyWidth);
   }
 
   if (sHour != hour || sMinute != minute) {
     sHour = hour;
     sMinute = minute;
-    auto const angle = (hour * 30 + minute / 2);
-
-    hour_point[0] = CoordinateRelocate(30, angle);
-    hour_point[1] = CoordinateRelocate(HourLength, angle);
 
-    hour_point_trace[0] = CoordinateRelocate(5, angle);
-    hour_point_trace[1] = CoordinateRelocate(31, angle);
-
-    lv_line_set_points(hour_body, hour_point, 2);
-    lv_line_set_points(hour_body_trace, hour_point_trace, 2);
+    // The hour hand only moves every 12 minutes
+    uint8_t position = (hour % 12) * 5 + minute / 12;
+    if (hourPosition != position) {
+      hourPosition = position;
+      InvalidateHand(hour_point_trace[0], hour_point[1], BodyWidth);
+      hour_point[0] = bodyStart[position];
+      hour_point[1] = hourEnd[position];
+      hour_point_trace[0] = traceStart[position];
+      hour_point_trace[1] = traceEnd[position];
+      InvalidateHand(hour_point_trace[0], hour_point[1], BodyWidth);
+    }
   }
 
   if (sSecond != second) {
     sSecond = second;
-    auto const angle = second * 6;
 
-    second_point[0] = CoordinateRelocate(-20, angle);
-    second_point[1] = CoordinateRelocate(SecondLength, angle);
-    lv_line_set_points(second_body, second_point, 2);
+    InvalidateHand(second_point[0], second_point[1], SecondWidth);
+    second_point[0] = secondTail[second];
+    second_point[1] = secondEnd[second];
+    InvalidateHand(second_point[0], second_point[1], SecondWidth);
   }
 }
 
@@ -34,8 +34,14 @@ namespace Pinetime {
 
         void Refresh() override;
 
+        Controllers::TopicSet Subscriptions() const override {
+          return Controllers::Topics::DateTime | Controllers::Topics::Battery;
+        }
+
       private:
         uint8_t sHour, sMinute, sSecond;
+        // Position of the hour hand, in minutes on the dial
+        uint8_t hourPosition;
 
         Pinetime::Controllers::DateTime::Months currentMonth = Pinetime::Controllers::DateTime::Months::Unknown;
         Pinetime::Controllers::DateTime::Days currentDayOfWeek = Pinetime::Controllers::DateTime::Days::Unknown;
@@ -52,11 +58,11 @@ namespace Pinetime {
         lv_obj_t* minute_body_trace;
         lv_obj_t* second_body;
 
-        lv_point_t hour_point[2];
-        lv_point_t hour_point_trace[2];
-        lv_point_t minute_point[2];
-        lv_point_t minute_point_trace[2];
-        lv_point_t second_point[2];
+        lv_point_t hour_point[2] {};
+        lv_point_t hour_point_trace[2] {};
+        lv_point_t minute_point[2] {};
+        lv_point_t minute_point_trace[2] {};
+        lv_point_t second_point[2] {};
 
         lv_style_t hour_line_style;
         lv_style_t hour_line_style_trace;
@@ -77,9 +83,8 @@ namespace Pinetime {
         Controllers::Settings& settingsController;
 
         void UpdateClock();
+        void InvalidateHand(const lv_point_t& start, const lv_point_t& end, lv_coord_t width);
         void SetBatteryIcon();
-
-        lv_task_t* taskRefresh;
       };
     }
   }
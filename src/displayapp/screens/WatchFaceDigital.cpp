@@ -84,15 +84,21 @@ WatchFaceDigital::WatchFaceDigital(DisplayApp* app,
   lv_label_set_text_static(stepIcon, Symbols::shoe);
   lv_obj_align(stepIcon, stepValue, LV_ALIGN_OUT_LEFT_MID, -5, 0);
 
-  taskRefresh = lv_task_create(RefreshTaskCallback, LV_DISP_DEF_REFR_PERIOD, LV_TASK_PRIO_MID, this);
   Refresh();
 }
 
 WatchFaceDigital::~WatchFaceDigital() {
-  lv_task_del(taskRefresh);
   lv_obj_clean(lv_scr_act());
 }
 
+bool WatchFaceDigital::GetAlwaysOnArea(lv_area_t& area) const {
+  // The width of the time label depends on the time, keep the whole lines
+  lv_obj_get_coords(label_time, &area);
+  area.x1 = 0;
+  area.x2 = LV_HOR_RES - 1;
+  return true;
+}
+
 void WatchFaceDigital::Refresh() {
   powerPresent = batteryController.IsPowerPresent();
   if (powerPresent.IsUpdated()) {
@@ -36,6 +36,17 @@ namespace Pinetime {
 
         void Refresh() override;
 
+        Controllers::TopicSet Subscriptions() const override {
+          return Controllers::Topics::DateTime | Controllers::Topics::Battery | Controllers::Topics::Ble |
+                 Controllers::Topics::HeartRate | Controllers::Topics::Motion;
+        }
+
+        bool SupportsReducedColorDepth() const override {
+          return true;
+        }
+
+        bool GetAlwaysOnArea(lv_area_t& area) const override;
+
       private:
         uint8_t displayedHour = -1;
         uint8_t displayedMinute = -1;
@@ -76,8 +87,6 @@ namespace Pinetime {
         Controllers::Settings& settingsController;
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
-
-        lv_task_t* taskRefresh;
       };
     }
   }
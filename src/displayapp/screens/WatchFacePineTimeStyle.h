@@ -38,6 +38,11 @@ namespace Pinetime {
 
         void Refresh() override;
 
+        Controllers::TopicSet Subscriptions() const override {
+          return Controllers::Topics::DateTime | Controllers::Topics::Battery | Controllers::Topics::Ble |
+                 Controllers::Topics::Motion;
+        }
+
         void UpdateSelected(lv_obj_t* object, lv_event_t event);
 
       private:
@@ -105,8 +110,6 @@ namespace Pinetime {
         void SetBatteryIcon();
         void CloseMenu();
         void AlignIcons();
-
-        lv_task_t* taskRefresh;
       };
     }
   }
@@ -34,6 +34,15 @@ namespace Pinetime {
 
         void Refresh() override;
 
+        Controllers::TopicSet Subscriptions() const override {
+          return Controllers::Topics::DateTime | Controllers::Topics::Battery | Controllers::Topics::Ble |
+                 Controllers::Topics::HeartRate | Controllers::Topics::Motion;
+        }
+
+        bool SupportsReducedColorDepth() const override {
+          return true;
+        }
+
       private:
         uint8_t displayedHour = -1;
         uint8_t displayedMinute = -1;
@@ -72,8 +81,6 @@ namespace Pinetime {
         Controllers::Settings& settingsController;
         Controllers::HeartRateController& heartRateController;
         Controllers::MotionController& motionController;
-
-        lv_task_t* taskRefresh;
       };
     }
   }
@@ -54,18 +54,35 @@ void Hrs3300::Disable() {
   WriteRegister(static_cast<uint8_t>(Registers::Enable), value);
 }
 
-uint32_t Hrs3300::ReadHrs() {
-  auto m = ReadRegister(static_cast<uint8_t>(Registers::C0DataM));
-  auto h = ReadRegister(static_cast<uint8_t>(Registers::C0DataH));
-  auto l = ReadRegister(static_cast<uint8_t>(Registers::C0dataL));
-  return ((l & 0x30) << 12) | (m << 8) | ((h & 0x0f) << 4) | (l & 0x0f);
-}
+bool Hrs3300::ReadSample(Sample& sample) {
+  // The data registers of both channels are between C1dataM and C0dataL
+  constexpr auto first = static_cast<uint8_t>(Registers::C1dataM);
+  constexpr auto last = static_cast<uint8_t>(Registers::C0dataL);
+  uint8_t data[last - first + 1];
+  auto at = [&data](Registers reg) {
+    return static_cast<uint32_t>(data[static_cast<uint8_t>(reg) - first]);
+  };
+
+  sample.timestamp = xTaskGetTickCount();
+  uint32_t startCycleCount = DWT->CYCCNT;
+  auto ret = twiMaster.Read(twiAddress, first, data, sizeof(data));
+  uint32_t latency = DWT->CYCCNT - startCycleCount;
+  statistics.transactions++;
+  if (ret != TwiMaster::ErrorCodes::NoError) {
+    NRF_LOG_INFO("READ ERROR");
+    return false;
+  }
 
-uint32_t Hrs3300::ReadAls() {
-  auto m = ReadRegister(static_cast<uint8_t>(Registers::C1dataM));
-  auto h = ReadRegister(static_cast<uint8_t>(Registers::C1dataH));
-  auto l = ReadRegister(static_cast<uint8_t>(Registers::C1dataL));
-  return ((h & 0x3f) << 11) | (m << 3) | (l & 0x07);
+  sample.hrs = ((at(Registers::C0dataL) & 0x30) << 12) | (at(Registers::C0DataM) << 8) | ((at(Registers::C0DataH) & 0x0f) << 4) |
+               (at(Registers::C0dataL) & 0x0f);
+  sample.als = ((at(Registers::C1dataH) & 0x3f) << 11) | (at(Registers::C1dataM) << 3) | (at(Registers::C1dataL) & 0x07);
+
+  statistics.samples++;
+  statistics.totalLatency += latency;
+  if (latency > statistics.maxLatency) {
+    statistics.maxLatency = latency;
+  }
+  return true;
 }
 
 void Hrs3300::SetGain(uint8_t gain) {
@@ -92,6 +109,7 @@ void Hrs3300::SetDrive(uint8_t drive) {
 
 void Hrs3300::WriteRegister(uint8_t reg, uint8_t data) {
   auto ret = twiMaster.Write(twiAddress, reg, &data, 1);
+  statistics.transactions++;
   if (ret != TwiMaster::ErrorCodes::NoError)
     NRF_LOG_INFO("WRITE ERROR");
 }
@@ -99,6 +117,7 @@ void Hrs3300::WriteRegister(uint8_t reg, uint8_t data) {
 uint8_t Hrs3300::ReadRegister(uint8_t reg) {
   uint8_t value;
   auto ret = twiMaster.Read(twiAddress, reg, &value, 1);
+  statistics.transactions++;
   if (ret != TwiMaster::ErrorCodes::NoError)
     NRF_LOG_INFO("READ ERROR");
   return value;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <FreeRTOS.h>
 #include "drivers/TwiMaster.h"
 
 namespace Pinetime {
@@ -21,6 +22,21 @@ namespace Pinetime {
         Hgain = 0x17
       };
 
+      struct Sample {
+        // Tick count when the sample was read
+        TickType_t timestamp;
+        uint32_t hrs;
+        uint32_t als;
+      };
+
+      struct Statistics {
+        uint32_t samples;
+        uint32_t transactions;
+        // Time to read a sample (CPU cycles)
+        uint32_t totalLatency;
+        uint32_t maxLatency;
+      };
+
       Hrs3300(TwiMaster& twiMaster, uint8_t twiAddress);
       Hrs3300(const Hrs3300&) = delete;
       Hrs3300& operator=(const Hrs3300&) = delete;
@@ -30,14 +46,19 @@ namespace Pinetime {
       void Init();
       void Enable();
       void Disable();
-      uint32_t ReadHrs();
-      uint32_t ReadAls();
+      /** Reads both channels (HRS and ALS) in a single bus transaction. Returns false if it failed. */
+      bool ReadSample(Sample& sample);
       void SetGain(uint8_t gain);
       void SetDrive(uint8_t drive);
 
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
     private:
       TwiMaster& twiMaster;
       uint8_t twiAddress;
+      Statistics statistics = {};
 
       void WriteRegister(uint8_t reg, uint8_t data);
       uint8_t ReadRegister(uint8_t reg);
@@ -4,17 +4,27 @@
 
 using namespace Pinetime::Drivers;
 
-Spi::Spi(SpiMaster& spiMaster, uint8_t pinCsn) : spiMaster {spiMaster}, pinCsn {pinCsn} {
+Spi::Spi(SpiMaster& spiMaster, uint8_t pinCsn, SpiMaster::Priorities priority)
+  : spiMaster {spiMaster}, pinCsn {pinCsn}, priority {priority} {
   nrf_gpio_cfg_output(pinCsn);
   nrf_gpio_pin_set(pinCsn);
 }
 
-bool Spi::Write(const uint8_t* data, size_t size) {
-  return spiMaster.Write(pinCsn, data, size);
+bool Spi::Write(const uint8_t* data, size_t size, SpiMaster::TransferCompletedCallback onCompleted, void* onCompletedContext) {
+  return spiMaster.Write(pinCsn, priority, data, size, onCompleted, onCompletedContext);
 }
 
 bool Spi::Read(uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize) {
-  return spiMaster.Read(pinCsn, cmd, cmdSize, data, dataSize);
+  return spiMaster.Read(pinCsn, priority, cmd, cmdSize, data, dataSize);
+}
+
+bool Spi::ReadAsync(uint8_t* cmd,
+                    size_t cmdSize,
+                    uint8_t* data,
+                    size_t dataSize,
+                    SpiMaster::TransferCompletedCallback onCompleted,
+                    void* onCompletedContext) {
+  return spiMaster.ReadAsync(pinCsn, priority, cmd, cmdSize, data, dataSize, onCompleted, onCompletedContext);
 }
 
 void Spi::Sleep() {
@@ -23,7 +33,11 @@ void Spi::Sleep() {
 }
 
 bool Spi::WriteCmdAndBuffer(const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize) {
-  return spiMaster.WriteCmdAndBuffer(pinCsn, cmd, cmdSize, data, dataSize);
+  return spiMaster.WriteCmdAndBuffer(pinCsn, priority, cmd, cmdSize, data, dataSize);
+}
+
+bool Spi::WriteCommandSequence(uint8_t pinDataCommand, const uint8_t* data, const uint8_t* runSizes, size_t nbRuns) {
+  return spiMaster.WriteCommandSequence(pinCsn, priority, pinDataCommand, data, runSizes, nbRuns);
 }
 
 bool Spi::Init() {
@@ -7,22 +7,33 @@ namespace Pinetime {
   namespace Drivers {
     class Spi {
     public:
-      Spi(SpiMaster& spiMaster, uint8_t pinCsn);
+      Spi(SpiMaster& spiMaster, uint8_t pinCsn, SpiMaster::Priorities priority = SpiMaster::Priorities::Low);
       Spi(const Spi&) = delete;
       Spi& operator=(const Spi&) = delete;
       Spi(Spi&&) = delete;
       Spi& operator=(Spi&&) = delete;
 
       bool Init();
-      bool Write(const uint8_t* data, size_t size);
+      bool Write(const uint8_t* data,
+                 size_t size,
+                 SpiMaster::TransferCompletedCallback onCompleted = nullptr,
+                 void* onCompletedContext = nullptr);
       bool Read(uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize);
+      bool ReadAsync(uint8_t* cmd,
+                     size_t cmdSize,
+                     uint8_t* data,
+                     size_t dataSize,
+                     SpiMaster::TransferCompletedCallback onCompleted,
+                     void* onCompletedContext);
       bool WriteCmdAndBuffer(const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize);
+      bool WriteCommandSequence(uint8_t pinDataCommand, const uint8_t* data, const uint8_t* runSizes, size_t nbRuns);
       void Sleep();
       void Wakeup();
 
     private:
       SpiMaster& spiMaster;
       uint8_t pinCsn;
+      SpiMaster::Priorities priority;
     };
   }
 }
@@ -6,13 +6,28 @@
 
 using namespace Pinetime::Drivers;
 
+namespace {
+  // EasyDMA and the PPI take 32 bits addresses
+  uint32_t ToAddress(const volatile void* pointer) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer));
+  }
+}
+
 SpiMaster::SpiMaster(const SpiMaster::SpiModule spi, const SpiMaster::Parameters& params) : spi {spi}, params {params} {
 }
 
 bool SpiMaster::Init() {
-  if (mutex == nullptr) {
-    mutex = xSemaphoreCreateBinary();
-    ASSERT(mutex != nullptr);
+  for (auto& granted : busGranted) {
+    if (granted == nullptr) {
+      granted = xSemaphoreCreateCounting(maxBusWaiters, 0);
+      ASSERT(granted != nullptr);
+    }
+  }
+  for (auto& completed : readCompleted) {
+    if (completed == nullptr) {
+      completed = xSemaphoreCreateBinary();
+      ASSERT(completed != nullptr);
+    }
   }
 
   /* Configure GPIO pins used for pselsck, pselmosi, pselmiso and pselss for SPI0 */
@@ -90,7 +105,8 @@ bool SpiMaster::Init() {
   NRFX_IRQ_PRIORITY_SET(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, 2);
   NRFX_IRQ_ENABLE(SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn);
 
-  xSemaphoreGive(mutex);
+  SetupChain();
+
   return true;
 }
 
@@ -100,8 +116,8 @@ void SpiMaster::SetupWorkaroundForFtpan58(NRF_SPIM_Type* spim, uint32_t ppi_chan
                                        (GPIOTE_CONFIG_POLARITY_Toggle << GPIOTE_CONFIG_POLARITY_Pos);
 
   // Stop the spim instance when SCK toggles.
-  NRF_PPI->CH[ppi_channel].EEP = (uint32_t) &NRF_GPIOTE->EVENTS_IN[gpiote_channel];
-  NRF_PPI->CH[ppi_channel].TEP = (uint32_t) &spim->TASKS_STOP;
+  NRF_PPI->CH[ppi_channel].EEP = ToAddress(&NRF_GPIOTE->EVENTS_IN[gpiote_channel]);
+  NRF_PPI->CH[ppi_channel].TEP = ToAddress(&spim->TASKS_STOP);
   NRF_PPI->CHENSET = 1U << ppi_channel;
   spiBaseAddress->EVENTS_END = 0;
 
@@ -122,32 +138,154 @@ void SpiMaster::DisableWorkaroundForFtpan58(NRF_SPIM_Type* spim, uint32_t ppi_ch
   spim->INTENSET = (1 << 19);
 }
 
+void SpiMaster::SetupChain() {
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER3->MODE = TIMER_MODE_MODE_Counter << TIMER_MODE_MODE_Pos;
+  NRF_TIMER3->BITMODE = TIMER_BITMODE_BITMODE_16Bit << TIMER_BITMODE_BITMODE_Pos;
+  NRF_TIMER3->SHORTS = TIMER_SHORTS_COMPARE0_CLEAR_Msk | TIMER_SHORTS_COMPARE0_STOP_Msk;
+  NRF_TIMER3->INTENSET = TIMER_INTENSET_COMPARE0_Msk;
+
+  // Restart the SPIM at the end of each chunk. This channel is the only member of the group
+  // so that it can be disabled by the TIMER without CPU intervention.
+  NRF_PPI->CH[chainPpiChannel].EEP = ToAddress(&spiBaseAddress->EVENTS_END);
+  NRF_PPI->CH[chainPpiChannel].TEP = ToAddress(&spiBaseAddress->TASKS_START);
+  NRF_PPI->CHG[chainPpiGroup] = 1U << chainPpiChannel;
+
+  // Count every chunk, the last one included.
+  NRF_PPI->CH[chainCountPpiChannel].EEP = ToAddress(&spiBaseAddress->EVENTS_END);
+  NRF_PPI->CH[chainCountPpiChannel].TEP = ToAddress(&NRF_TIMER3->TASKS_COUNT);
+
+  // The last chunk has been started: do not restart the SPIM once it's done.
+  NRF_PPI->CH[chainStopPpiChannel].EEP = ToAddress(&NRF_TIMER3->EVENTS_COMPARE[1]);
+  NRF_PPI->CH[chainStopPpiChannel].TEP = ToAddress(&NRF_PPI->TASKS_CHG[chainPpiGroup].DIS);
+
+  NRF_PPI->CHENCLR = (1U << chainPpiChannel) | (1U << chainCountPpiChannel) | (1U << chainStopPpiChannel);
+
+  NRFX_IRQ_PRIORITY_SET(TIMER3_IRQn, 2);
+  NRFX_IRQ_ENABLE(TIMER3_IRQn);
+}
+
+size_t SpiMaster::ChainChunkSize(size_t size) {
+  // Chunks of a chained transfer all have the same size. Prefer a size that divides the buffer evenly
+  // so that the whole buffer is sent with a single interrupt. Otherwise, the remainder is sent separately.
+  for (size_t chunkSize = maxChunkSize; chunkSize >= minChainChunkSize; chunkSize--) {
+    if ((size % chunkSize) == 0) {
+      return chunkSize;
+    }
+  }
+  return maxChunkSize;
+}
+
+void SpiMaster::StartChainedTx(uint32_t bufferAddress, size_t chunkSize, size_t chunkCount) {
+  // Only the interrupt of TIMER3 is needed once the chain is running, the SPIM would otherwise be interrupted
+  // at each chunk
+  spiBaseAddress->INTENCLR = (1 << 6);
+  spiBaseAddress->INTENCLR = (1 << 1);
+  spiBaseAddress->INTENCLR = (1 << 19);
+
+  NRF_TIMER3->TASKS_STOP = 1;
+  NRF_TIMER3->TASKS_CLEAR = 1;
+  NRF_TIMER3->EVENTS_COMPARE[0] = 0;
+  NRF_TIMER3->EVENTS_COMPARE[1] = 0;
+  NRF_TIMER3->CC[0] = chunkCount;
+  NRF_TIMER3->CC[1] = chunkCount - 1;
+  NRF_TIMER3->TASKS_START = 1;
+
+  if (chunkCount > 1) {
+    NRF_PPI->CHENSET = (1U << chainPpiChannel) | (1U << chainCountPpiChannel) | (1U << chainStopPpiChannel);
+  } else {
+    NRF_PPI->CHENSET = (1U << chainCountPpiChannel);
+  }
+
+  chainRunning = true;
+  spiBaseAddress->TXD.PTR = bufferAddress;
+  spiBaseAddress->TXD.MAXCNT = chunkSize;
+  spiBaseAddress->TXD.LIST = SPIM_TXD_LIST_LIST_ArrayList << SPIM_TXD_LIST_LIST_Pos;
+  spiBaseAddress->RXD.PTR = 0;
+  spiBaseAddress->RXD.MAXCNT = 0;
+  spiBaseAddress->RXD.LIST = 0;
+  spiBaseAddress->EVENTS_END = 0;
+  // The following chunks are started by the PPI
+  statistics.dmaTransactions += chunkCount - 1;
+  StartTransaction();
+}
+
+void SpiMaster::StopChain() {
+  NRF_PPI->CHENCLR = (1U << chainPpiChannel) | (1U << chainCountPpiChannel) | (1U << chainStopPpiChannel);
+  chainRunning = false;
+  spiBaseAddress->TXD.LIST = 0;
+  spiBaseAddress->EVENTS_END = 0;
+  spiBaseAddress->EVENTS_STARTED = 0;
+  spiBaseAddress->EVENTS_STOPPED = 0;
+  spiBaseAddress->INTENSET = (1 << 6);
+  spiBaseAddress->INTENSET = (1 << 1);
+  spiBaseAddress->INTENSET = (1 << 19);
+}
+
+void SpiMaster::StartTransaction() {
+  statistics.dmaTransactions++;
+  spiBaseAddress->TASKS_START = 1;
+}
+
+void SpiMaster::OnChainEndEvent() {
+  if (!chainRunning) {
+    return;
+  }
+  statistics.interrupts++;
+  StopChain();
+
+  auto s = currentBufferSize;
+  if (s > 0) {
+    // Remainder of a buffer that could not be split evenly
+    PrepareTx(currentBufferAddr, s);
+    currentBufferAddr += s;
+    currentBufferSize = 0;
+    StartTransaction();
+  } else {
+    EndTransfer();
+  }
+}
+
 void SpiMaster::OnEndEvent() {
   if (currentBufferAddr == 0) {
     return;
   }
+  statistics.interrupts++;
+
+  if (readInProgress) {
+    OnReadEndEvent();
+    return;
+  }
 
   auto s = currentBufferSize;
   if (s > 0) {
-    auto currentSize = std::min((size_t) 255, s);
+    auto currentSize = std::min(maxChunkSize, s);
     PrepareTx(currentBufferAddr, currentSize);
     currentBufferAddr += currentSize;
     currentBufferSize -= currentSize;
 
-    spiBaseAddress->TASKS_START = 1;
+    StartTransaction();
   } else {
-    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-    if (taskToNotify != nullptr) {
-      vTaskNotifyGiveFromISR(taskToNotify, &xHigherPriorityTaskWoken);
-      portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
-    }
+    EndTransfer();
+  }
+}
 
-    nrf_gpio_pin_set(this->pinCsn);
-    currentBufferAddr = 0;
-    BaseType_t xHigherPriorityTaskWoken2 = pdFALSE;
-    xSemaphoreGiveFromISR(mutex, &xHigherPriorityTaskWoken2);
-    portYIELD_FROM_ISR(xHigherPriorityTaskWoken | xHigherPriorityTaskWoken2);
+void SpiMaster::EndTransfer() {
+  nrf_gpio_pin_set(this->pinCsn);
+  currentBufferAddr = 0;
+
+  if (transferCompletedCallback != nullptr) {
+    transferCompletedCallback(transferCompletedContext);
+    transferCompletedCallback = nullptr;
   }
+
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  if (taskToNotify != nullptr) {
+    vTaskNotifyGiveFromISR(taskToNotify, &xHigherPriorityTaskWoken);
+  }
+  BaseType_t xHigherPriorityTaskWoken2 = pdFALSE;
+  ReleaseBusFromISR(&xHigherPriorityTaskWoken2);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken | xHigherPriorityTaskWoken2);
 }
 
 void SpiMaster::OnStartedEvent() {
@@ -176,12 +314,18 @@ void SpiMaster::PrepareRx(const volatile uint32_t cmdAddress,
   spiBaseAddress->EVENTS_END = 0;
 }
 
-bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size) {
+bool SpiMaster::Write(uint8_t pinCsn,
+                      Priorities priority,
+                      const uint8_t* data,
+                      size_t size,
+                      TransferCompletedCallback onCompleted,
+                      void* onCompletedContext) {
   if (data == nullptr)
     return false;
-  auto ok = xSemaphoreTake(mutex, portMAX_DELAY);
-  ASSERT(ok == true);
+  AcquireBus(priority);
   taskToNotify = xTaskGetCurrentTaskHandle();
+  transferCompletedCallback = onCompleted;
+  transferCompletedContext = onCompletedContext;
 
   this->pinCsn = pinCsn;
 
@@ -193,57 +337,144 @@ bool SpiMaster::Write(uint8_t pinCsn, const uint8_t* data, size_t size) {
 
   nrf_gpio_pin_clear(this->pinCsn);
 
-  currentBufferAddr = (uint32_t) data;
+  statistics.transfers++;
+  statistics.bytes += size;
+
+  if (size > maxChunkSize) {
+    auto chunkSize = ChainChunkSize(size);
+    auto chunkCount = size / chunkSize;
+    currentBufferAddr = ToAddress(data) + (chunkSize * chunkCount);
+    currentBufferSize = size - (chunkSize * chunkCount);
+    StartChainedTx(ToAddress(data), chunkSize, chunkCount);
+    return true;
+  }
+
+  currentBufferAddr = ToAddress(data);
   currentBufferSize = size;
 
-  auto currentSize = std::min((size_t) 255, (size_t) currentBufferSize);
+  auto currentSize = std::min(maxChunkSize, (size_t) currentBufferSize);
   PrepareTx(currentBufferAddr, currentSize);
   currentBufferSize -= currentSize;
   currentBufferAddr += currentSize;
-  spiBaseAddress->TASKS_START = 1;
+  StartTransaction();
 
   if (size == 1) {
-    while (spiBaseAddress->EVENTS_END == 0)
-      ;
+    WaitForEndEvent();
     nrf_gpio_pin_set(this->pinCsn);
     currentBufferAddr = 0;
-    xSemaphoreGive(mutex);
+    transferCompletedCallback = nullptr;
+    ReleaseBus();
+    if (onCompleted != nullptr) {
+      onCompleted(onCompletedContext);
+    }
   }
 
   return true;
 }
 
-bool SpiMaster::Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
+bool SpiMaster::Read(uint8_t pinCsn, Priorities priority, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize) {
+  auto onCompleted = [](void* context) {
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(static_cast<SemaphoreHandle_t>(context), &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+  };
+
+  // Each blocking read waits on its own semaphore: with a shared one, a reader could take the completion of
+  // another read and return while its own data is still being received.
+  uint8_t slot = AcquireReadCompleted();
+  SemaphoreHandle_t completed = slot < maxBlockingReads ? readCompleted[slot] : xSemaphoreCreateBinary();
+  ASSERT(completed != nullptr);
+
+  bool started = ReadAsync(pinCsn, priority, cmd, cmdSize, data, dataSize, onCompleted, completed);
+  if (started) {
+    xSemaphoreTake(completed, portMAX_DELAY);
+  }
+
+  if (slot < maxBlockingReads) {
+    ReleaseReadCompleted(slot);
+  } else {
+    vSemaphoreDelete(completed);
+  }
+  return started;
+}
+
+uint8_t SpiMaster::AcquireReadCompleted() {
+  taskENTER_CRITICAL();
+  uint8_t slot = 0;
+  while (slot < maxBlockingReads && (readCompletedInUse & (1U << slot)) != 0) {
+    slot++;
+  }
+  if (slot < maxBlockingReads) {
+    readCompletedInUse |= (1U << slot);
+  }
+  taskEXIT_CRITICAL();
+  return slot;
+}
+
+void SpiMaster::ReleaseReadCompleted(uint8_t slot) {
+  taskENTER_CRITICAL();
+  readCompletedInUse &= ~(1U << slot);
+  taskEXIT_CRITICAL();
+}
+
+bool SpiMaster::ReadAsync(uint8_t pinCsn,
+                          Priorities priority,
+                          uint8_t* cmd,
+                          size_t cmdSize,
+                          uint8_t* data,
+                          size_t dataSize,
+                          TransferCompletedCallback onCompleted,
+                          void* onCompletedContext) {
+  if (cmd == nullptr || cmdSize == 0)
+    return false;
+  AcquireBus(priority);
 
   taskToNotify = nullptr;
+  transferCompletedCallback = onCompleted;
+  transferCompletedContext = onCompletedContext;
 
   this->pinCsn = pinCsn;
   DisableWorkaroundForFtpan58(spiBaseAddress, 0, 0);
-  spiBaseAddress->INTENCLR = (1 << 6);
-  spiBaseAddress->INTENCLR = (1 << 1);
-  spiBaseAddress->INTENCLR = (1 << 19);
 
   nrf_gpio_pin_clear(this->pinCsn);
 
-  currentBufferAddr = 0;
+  statistics.transfers++;
+  statistics.bytes += cmdSize + dataSize;
+
+  // The data is received in OnEndEvent(), once the command is sent
+  currentRxBufferAddr = ToAddress(data);
+  currentRxBufferSize = dataSize;
+  readInProgress = true;
+  currentBufferAddr = ToAddress(cmd) + cmdSize;
   currentBufferSize = 0;
 
-  PrepareTx((uint32_t) cmd, cmdSize);
-  spiBaseAddress->TASKS_START = 1;
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
+  PrepareTx(ToAddress(cmd), cmdSize);
+  StartTransaction();
 
-  PrepareRx((uint32_t) cmd, cmdSize, (uint32_t) data, dataSize);
-  spiBaseAddress->TASKS_START = 1;
+  return true;
+}
 
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
-  nrf_gpio_pin_set(this->pinCsn);
+void SpiMaster::OnReadEndEvent() {
+  auto s = currentRxBufferSize;
+  if (s > 0) {
+    auto currentSize = std::min(maxChunkSize, s);
+    PrepareRx(0, 0, currentRxBufferAddr, currentSize);
+    currentRxBufferAddr += currentSize;
+    currentRxBufferSize -= currentSize;
 
-  xSemaphoreGive(mutex);
+    StartTransaction();
+  } else {
+    readInProgress = false;
+    EndTransfer();
+  }
+}
 
-  return true;
+void SpiMaster::WaitForEndEvent() {
+  uint32_t spinStartCycleCount = DWT->CYCCNT;
+  while (spiBaseAddress->EVENTS_END == 0)
+    ;
+  statistics.spinWaits++;
+  statistics.spinCycles += DWT->CYCCNT - spinStartCycleCount;
 }
 
 void SpiMaster::Sleep() {
@@ -262,8 +493,9 @@ void SpiMaster::Wakeup() {
   NRF_LOG_INFO("[SPIMASTER] Wakeup");
 }
 
-bool SpiMaster::WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
+bool SpiMaster::WriteCmdAndBuffer(
+  uint8_t pinCsn, Priorities priority, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize) {
+  AcquireBus(priority);
 
   taskToNotify = nullptr;
 
@@ -275,22 +507,120 @@ bool SpiMaster::WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmd
 
   nrf_gpio_pin_clear(this->pinCsn);
 
+  statistics.transfers++;
+  statistics.bytes += cmdSize + dataSize;
+
   currentBufferAddr = 0;
   currentBufferSize = 0;
 
-  PrepareTx((uint32_t) cmd, cmdSize);
-  spiBaseAddress->TASKS_START = 1;
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
+  PrepareTx(ToAddress(cmd), cmdSize);
+  StartTransaction();
+  WaitForEndEvent();
 
-  PrepareTx((uint32_t) data, dataSize);
-  spiBaseAddress->TASKS_START = 1;
+  PrepareTx(ToAddress(data), dataSize);
+  StartTransaction();
 
-  while (spiBaseAddress->EVENTS_END == 0)
-    ;
+  WaitForEndEvent();
   nrf_gpio_pin_set(this->pinCsn);
 
-  xSemaphoreGive(mutex);
+  ReleaseBus();
 
   return true;
 }
+
+bool SpiMaster::WriteCommandSequence(uint8_t pinCsn,
+                                     Priorities priority,
+                                     uint8_t pinDataCommand,
+                                     const uint8_t* data,
+                                     const uint8_t* runSizes,
+                                     size_t nbRuns) {
+  AcquireBus(priority);
+
+  taskToNotify = nullptr;
+
+  this->pinCsn = pinCsn;
+  DisableWorkaroundForFtpan58(spiBaseAddress, 0, 0);
+  spiBaseAddress->INTENCLR = (1 << 6);
+  spiBaseAddress->INTENCLR = (1 << 1);
+  spiBaseAddress->INTENCLR = (1 << 19);
+
+  nrf_gpio_pin_clear(this->pinCsn);
+
+  currentBufferAddr = 0;
+  currentBufferSize = 0;
+
+  size_t totalSize = 0;
+  for (size_t i = 0; i < nbRuns; i++) {
+    // The D/C pin can only be toggled between 2 DMA transactions
+    nrf_gpio_pin_clear(pinDataCommand);
+    PrepareTx(ToAddress(data), 1);
+    StartTransaction();
+    WaitForEndEvent();
+
+    if (runSizes[i] > 1) {
+      nrf_gpio_pin_set(pinDataCommand);
+      PrepareTx(ToAddress(data + 1), runSizes[i] - 1);
+      StartTransaction();
+      WaitForEndEvent();
+    }
+    data += runSizes[i];
+    totalSize += runSizes[i];
+  }
+  nrf_gpio_pin_set(this->pinCsn);
+
+  statistics.transfers++;
+  statistics.bytes += totalSize;
+
+  ReleaseBus();
+
+  return true;
+}
+
+void SpiMaster::AcquireBus(Priorities priority) {
+  auto index = static_cast<uint8_t>(priority);
+
+  taskENTER_CRITICAL();
+  if (!busBusy) {
+    busBusy = true;
+    taskEXIT_CRITICAL();
+    return;
+  }
+  busWaiting[index]++;
+  taskEXIT_CRITICAL();
+
+  // The bus is handed over directly by ReleaseBus(), to the highest priority client first
+  uint32_t waitStartCycleCount = DWT->CYCCNT;
+  xSemaphoreTake(busGranted[index], portMAX_DELAY);
+  uint32_t waitCycles = DWT->CYCCNT - waitStartCycleCount;
+  if (priority == Priorities::High && waitCycles > statistics.maxHighPriorityWaitCycles) {
+    statistics.maxHighPriorityWaitCycles = waitCycles;
+  }
+}
+
+void SpiMaster::ReleaseBus() {
+  taskENTER_CRITICAL();
+  for (int8_t index = nbPriorities - 1; index >= 0; index--) {
+    if (busWaiting[index] > 0) {
+      busWaiting[index]--;
+      xSemaphoreGive(busGranted[index]);
+      taskEXIT_CRITICAL();
+      return;
+    }
+  }
+  busBusy = false;
+  taskEXIT_CRITICAL();
+}
+
+void SpiMaster::ReleaseBusFromISR(BaseType_t* xHigherPriorityTaskWoken) {
+  auto interruptStatus = taskENTER_CRITICAL_FROM_ISR();
+  for (int8_t index = nbPriorities - 1; index >= 0; index--) {
+    if (busWaiting[index] > 0) {
+      busWaiting[index]--;
+      xSemaphoreGiveFromISR(busGranted[index], xHigherPriorityTaskWoken);
+      taskEXIT_CRITICAL_FROM_ISR(interruptStatus);
+      return;
+    }
+  }
+  busBusy = false;
+  taskEXIT_CRITICAL_FROM_ISR(interruptStatus);
+}
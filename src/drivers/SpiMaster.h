@@ -14,6 +14,23 @@ namespace Pinetime {
       enum class BitOrder : uint8_t { Msb_Lsb, Lsb_Msb };
       enum class Modes : uint8_t { Mode0, Mode1, Mode2, Mode3 };
       enum class Frequencies : uint8_t { Freq8Mhz };
+      // Clients waiting for the bus are served by priority. The bus is only handed over at the end of a transaction,
+      // so clients with long operations must split them in bounded transactions.
+      enum class Priorities : uint8_t { Low, High };
+      using TransferCompletedCallback = void (*)(void* context);
+      struct Statistics {
+        // Calls to Write(), Read(), ReadAsync(), WriteCmdAndBuffer() and WriteCommandSequence()
+        uint32_t transfers;
+        // EasyDMA transactions: a transfer takes several when it is larger than maxChunkSize or when the D/C pin
+        // changes. Those restarted by the PPI in a chain are included.
+        uint32_t dmaTransactions;
+        uint32_t interrupts;
+        uint32_t bytes;
+        // DMA transactions the CPU waited for in a busy loop, and the cycles spent in these loops
+        uint32_t spinWaits;
+        uint32_t spinCycles;
+        uint32_t maxHighPriorityWaitCycles;
+      };
       struct Parameters {
         BitOrder bitOrder;
         Modes mode;
@@ -30,17 +47,49 @@ namespace Pinetime {
       SpiMaster& operator=(SpiMaster&&) = delete;
 
       bool Init();
-      bool Write(uint8_t pinCsn, const uint8_t* data, size_t size);
-      bool Read(uint8_t pinCsn, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize);
+      bool Write(uint8_t pinCsn,
+                 Priorities priority,
+                 const uint8_t* data,
+                 size_t size,
+                 TransferCompletedCallback onCompleted = nullptr,
+                 void* onCompletedContext = nullptr);
+      /** Sends cmd and receives dataSize bytes in data. Blocks the calling task (without spinning) until the transfer is done. */
+      bool Read(uint8_t pinCsn, Priorities priority, uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize);
+      /** Starts the same transfer as Read() and returns immediately. onCompleted is called from the SPI interrupt
+       * once data has been received. cmd and data must remain valid until then. */
+      bool ReadAsync(uint8_t pinCsn,
+                     Priorities priority,
+                     uint8_t* cmd,
+                     size_t cmdSize,
+                     uint8_t* data,
+                     size_t dataSize,
+                     TransferCompletedCallback onCompleted,
+                     void* onCompletedContext);
+
+      bool WriteCmdAndBuffer(
+        uint8_t pinCsn, Priorities priority, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize);
 
-      bool WriteCmdAndBuffer(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, const uint8_t* data, size_t dataSize);
+      /** Sends a sequence of commands in a single transaction (the bus is taken and CS is asserted only once).
+       * data contains nbRuns runs of runSizes[i] bytes. The first byte of each run (the command) is sent with
+       * pinDataCommand low, the following bytes (the parameters) are sent with pinDataCommand high. */
+      bool WriteCommandSequence(uint8_t pinCsn,
+                                Priorities priority,
+                                uint8_t pinDataCommand,
+                                const uint8_t* data,
+                                const uint8_t* runSizes,
+                                size_t nbRuns);
 
       void OnStartedEvent();
       void OnEndEvent();
+      void OnChainEndEvent();
 
       void Sleep();
       void Wakeup();
 
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
     private:
       void SetupWorkaroundForFtpan58(NRF_SPIM_Type* spim, uint32_t ppi_channel, uint32_t gpiote_channel);
       void DisableWorkaroundForFtpan58(NRF_SPIM_Type* spim, uint32_t ppi_channel, uint32_t gpiote_channel);
@@ -49,6 +98,29 @@ namespace Pinetime {
                      const volatile size_t cmdSize,
                      const volatile uint32_t bufferAddress,
                      const volatile size_t size);
+      void SetupChain();
+      void StartChainedTx(uint32_t bufferAddress, size_t chunkSize, size_t chunkCount);
+      void StopChain();
+      void StartTransaction();
+      uint8_t AcquireReadCompleted();
+      void ReleaseReadCompleted(uint8_t slot);
+      void EndTransfer();
+      void AcquireBus(Priorities priority);
+      void ReleaseBus();
+      void ReleaseBusFromISR(BaseType_t* xHigherPriorityTaskWoken);
+      void OnReadEndEvent();
+      void WaitForEndEvent();
+      static size_t ChainChunkSize(size_t size);
+
+      // Transfers larger than a single EasyDMA transaction are split in chunks that are chained in hardware:
+      // the END event restarts the SPIM (ArrayList mode advances TXD.PTR) and increments a TIMER in counter mode.
+      // The TIMER disables the restart channel before the last chunk and raises a single interrupt when it is done.
+      static constexpr size_t maxChunkSize = 255;
+      static constexpr size_t minChainChunkSize = 64;
+      static constexpr uint32_t chainPpiChannel = 1;
+      static constexpr uint32_t chainCountPpiChannel = 2;
+      static constexpr uint32_t chainStopPpiChannel = 3;
+      static constexpr uint32_t chainPpiGroup = 0;
 
       NRF_SPIM_Type* spiBaseAddress;
       uint8_t pinCsn;
@@ -58,8 +130,23 @@ namespace Pinetime {
 
       volatile uint32_t currentBufferAddr = 0;
       volatile size_t currentBufferSize = 0;
+      volatile bool chainRunning = false;
+      volatile uint32_t currentRxBufferAddr = 0;
+      volatile size_t currentRxBufferSize = 0;
+      volatile bool readInProgress = false;
+      Statistics statistics {};
       volatile TaskHandle_t taskToNotify;
-      SemaphoreHandle_t mutex = nullptr;
+      volatile TransferCompletedCallback transferCompletedCallback = nullptr;
+      void* volatile transferCompletedContext = nullptr;
+      static constexpr uint8_t nbPriorities = 2;
+      static constexpr UBaseType_t maxBusWaiters = 8;
+      volatile bool busBusy = false;
+      volatile uint8_t busWaiting[nbPriorities] = {};
+      SemaphoreHandle_t busGranted[nbPriorities] = {};
+      // Completion of the blocking reads in progress, a temporary semaphore is created if they are all in use
+      static constexpr uint8_t maxBlockingReads = 4;
+      SemaphoreHandle_t readCompleted[maxBlockingReads] = {};
+      volatile uint8_t readCompletedInUse = 0;
     };
   }
 }
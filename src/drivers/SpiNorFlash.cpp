@@ -72,11 +72,19 @@ uint8_t SpiNorFlash::ReadConfigurationRegister() {
 
 void SpiNorFlash::Read(uint32_t address, uint8_t* buffer, size_t size) {
   static constexpr uint8_t cmdSize = 4;
-  uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::Read),
-                          static_cast<uint8_t>(address >> 16U),
-                          static_cast<uint8_t>(address >> 8U),
-                          static_cast<uint8_t>(address)};
-  spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, buffer, size);
+
+  // Large reads are split so that the display does not wait for the bus for more than one slice
+  while (size > 0) {
+    size_t toRead = size > maxReadSliceSize ? maxReadSliceSize : size;
+    uint8_t cmd[cmdSize] = {static_cast<uint8_t>(Commands::Read),
+                            static_cast<uint8_t>(address >> 16U),
+                            static_cast<uint8_t>(address >> 8U),
+                            static_cast<uint8_t>(address)};
+    spi.Read(reinterpret_cast<uint8_t*>(&cmd), cmdSize, buffer, toRead);
+    address += toRead;
+    buffer += toRead;
+    size -= toRead;
+  }
 }
 
 void SpiNorFlash::WriteEnable() {
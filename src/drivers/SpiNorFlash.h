@@ -52,6 +52,7 @@ namespace Pinetime {
         DeepPowerDown = 0xB9
       };
       static constexpr uint16_t pageSize = 256;
+      static constexpr size_t maxReadSliceSize = 256;
 
       Spi& spi;
       Identification device_id;
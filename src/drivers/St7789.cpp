@@ -1,4 +1,5 @@
 #include "drivers/St7789.h"
+#include <cstring>
 #include <hal/nrf_gpio.h>
 #include <libraries/delay/nrf_delay.h>
 #include <nrfx_log.h>
@@ -25,6 +26,7 @@ void St7789::Init() {
   NormalModeOn();
   SetVdv();
   DisplayOn();
+  InvalidateAddrWindow();
 }
 
 void St7789::WriteCommand(uint8_t cmd) {
@@ -32,13 +34,19 @@ void St7789::WriteCommand(uint8_t cmd) {
   WriteSpi(&cmd, 1);
 }
 
+void St7789::WriteCommand(uint8_t cmd, const uint8_t* parameters, size_t size) {
+  CommandSequence sequence;
+  sequence.Add(static_cast<Commands>(cmd), parameters, size);
+  sequence.Send(spi, pinDataCommand);
+}
+
 void St7789::WriteData(uint8_t data) {
   nrf_gpio_pin_set(pinDataCommand);
   WriteSpi(&data, 1);
 }
 
-void St7789::WriteSpi(const uint8_t* data, size_t size) {
-  spi.Write(data, size);
+void St7789::WriteSpi(const uint8_t* data, size_t size, TransferCompletedCallback onCompleted, void* onCompletedContext) {
+  spi.Write(data, size, onCompleted, onCompletedContext);
 }
 
 void St7789::SoftwareReset() {
@@ -56,29 +64,69 @@ void St7789::SleepIn() {
 
 void St7789::ColMod() {
   WriteCommand(static_cast<uint8_t>(Commands::ColMod));
-  WriteData(0x55);
+  WriteData(static_cast<uint8_t>(pixelFormat));
   nrf_delay_ms(10);
 }
 
+void St7789::SetPixelFormat(PixelFormats format) {
+  if (format == pixelFormat) {
+    return;
+  }
+  pixelFormat = format;
+  uint8_t parameter = static_cast<uint8_t>(pixelFormat);
+  WriteCommand(static_cast<uint8_t>(Commands::ColMod), &parameter, 1);
+}
+
+size_t St7789::PackRgb444(uint8_t* buffer, size_t nbPixels) {
+  // 2 pixels are converted at once in a 32 bits word: once byte-swapped, each half word is an RGB565 pixel,
+  // and the 4 MSB of each component are moved to their RGB444 position in both half words with the same shifts and
+  // masks. The output never overtakes the input (3 bytes written for 4 bytes read), so the conversion can be done
+  // in place.
+  const uint8_t* src = buffer;
+  uint8_t* dst = buffer;
+  for (size_t i = 0; i < nbPixels / 2; i++) {
+    uint32_t word;
+    std::memcpy(&word, src, sizeof(word));
+    src += sizeof(word);
+#if defined(__ARM_ARCH)
+    word = __REV16(word);
+#else
+    word = ((word & 0x00ff00ffu) << 8) | ((word & 0xff00ff00u) >> 8);
+#endif
+    uint32_t rgb444 = ((word >> 4) & 0x0f000f00u) | ((word >> 3) & 0x00f000f0u) | ((word >> 1) & 0x000f000fu);
+    // First pixel in the 12 MSB of the 24 bits sent, second pixel in the 12 LSB
+    uint32_t packed = ((rgb444 & 0x0fffu) << 12) | (rgb444 >> 16);
+    dst[0] = static_cast<uint8_t>(packed >> 16);
+    dst[1] = static_cast<uint8_t>(packed >> 8);
+    dst[2] = static_cast<uint8_t>(packed);
+    dst += 3;
+  }
+
+  if ((nbPixels % 2) != 0) {
+    uint16_t pixel = (static_cast<uint16_t>(src[0]) << 8) | src[1];
+    uint16_t rgb444 = ((pixel >> 4) & 0x0f00u) | ((pixel >> 3) & 0x00f0u) | ((pixel >> 1) & 0x000fu);
+    dst[0] = static_cast<uint8_t>(rgb444 >> 4);
+    dst[1] = static_cast<uint8_t>(rgb444 << 4);
+  }
+
+  return BufferSize(nbPixels, PixelFormats::Rgb444);
+}
+
 void St7789::MemoryDataAccessControl() {
   WriteCommand(static_cast<uint8_t>(Commands::MemoryDataAccessControl));
   WriteData(0x00);
 }
 
 void St7789::ColumnAddressSet() {
-  WriteCommand(static_cast<uint8_t>(Commands::ColumnAddressSet));
-  WriteData(0x00);
-  WriteData(0x00);
-  WriteData(Width >> 8u);
-  WriteData(Width & 0xffu);
+  CommandSequence sequence;
+  sequence.Add(Commands::ColumnAddressSet, 0, Width);
+  sequence.Send(spi, pinDataCommand);
 }
 
 void St7789::RowAddressSet() {
-  WriteCommand(static_cast<uint8_t>(Commands::RowAddressSet));
-  WriteData(0x00);
-  WriteData(0x00);
-  WriteData(320u >> 8u);
-  WriteData(320u & 0xffu);
+  CommandSequence sequence;
+  sequence.Add(Commands::RowAddressSet, 0, Height);
+  sequence.Send(spi, pinDataCommand);
 }
 
 void St7789::DisplayInversionOn() {
@@ -95,20 +143,29 @@ void St7789::DisplayOn() {
   WriteCommand(static_cast<uint8_t>(Commands::DisplayOn));
 }
 
-void St7789::SetAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
-  WriteCommand(static_cast<uint8_t>(Commands::ColumnAddressSet));
-  WriteData(x0 >> 8);
-  WriteData(x0 & 0xff);
-  WriteData(x1 >> 8);
-  WriteData(x1 & 0xff);
+void St7789::SetAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1) {
+  CommandSequence sequence;
+  bool sameColumns = addrWindowValid && (x0 == addrWindowX0) && (x1 == addrWindowX1);
+
+  if (sameColumns && (y0 == nextWriteRow)) {
+    // The RAM pointer is already at the beginning of this area
+    sequence.Add(Commands::WriteToRamContinue);
+  } else {
+    if (!sameColumns) {
+      sequence.Add(Commands::ColumnAddressSet, x0, x1);
+    }
+    sequence.Add(Commands::RowAddressSet, y0, Height - 1);
+    sequence.Add(Commands::WriteToRam);
+  }
+  sequence.Send(spi, pinDataCommand);
 
-  WriteCommand(static_cast<uint8_t>(Commands::RowAddressSet));
-  WriteData(y0 >> 8);
-  WriteData(y0 & 0xff);
-  WriteData(y1 >> 8);
-  WriteData(y1 & 0xff);
+  addrWindowValid = true;
+  addrWindowX0 = x0;
+  addrWindowX1 = x1;
+}
 
-  WriteToRam();
+void St7789::InvalidateAddrWindow() {
+  addrWindowValid = false;
 }
 
 void St7789::WriteToRam() {
@@ -128,20 +185,19 @@ void St7789::DisplayOff() {
 }
 
 void St7789::VerticalScrollDefinition(uint16_t topFixedLines, uint16_t scrollLines, uint16_t bottomFixedLines) {
-  WriteCommand(static_cast<uint8_t>(Commands::VerticalScrollDefinition));
-  WriteData(topFixedLines >> 8u);
-  WriteData(topFixedLines & 0x00ffu);
-  WriteData(scrollLines >> 8u);
-  WriteData(scrollLines & 0x00ffu);
-  WriteData(bottomFixedLines >> 8u);
-  WriteData(bottomFixedLines & 0x00ffu);
+  uint8_t parameters[] = {static_cast<uint8_t>(topFixedLines >> 8u),
+                          static_cast<uint8_t>(topFixedLines & 0x00ffu),
+                          static_cast<uint8_t>(scrollLines >> 8u),
+                          static_cast<uint8_t>(scrollLines & 0x00ffu),
+                          static_cast<uint8_t>(bottomFixedLines >> 8u),
+                          static_cast<uint8_t>(bottomFixedLines & 0x00ffu)};
+  WriteCommand(static_cast<uint8_t>(Commands::VerticalScrollDefinition), parameters, sizeof(parameters));
 }
 
 void St7789::VerticalScrollStartAddress(uint16_t line) {
   verticalScrollingStartAddress = line;
-  WriteCommand(static_cast<uint8_t>(Commands::VerticalScrollStartAddress));
-  WriteData(line >> 8u);
-  WriteData(line & 0x00ffu);
+  uint8_t parameters[] = {static_cast<uint8_t>(line >> 8u), static_cast<uint8_t>(line & 0x00ffu)};
+  WriteCommand(static_cast<uint8_t>(Commands::VerticalScrollStartAddress), parameters, sizeof(parameters));
 }
 
 void St7789::Uninit() {
@@ -152,16 +208,33 @@ void St7789::DrawPixel(uint16_t x, uint16_t y, uint32_t color) {
     return;
   }
 
-  SetAddrWindow(x, y, x + 1, y + 1);
+  SetAddrWindow(x, y, x);
+  InvalidateAddrWindow();
 
   nrf_gpio_pin_set(pinDataCommand);
   WriteSpi(reinterpret_cast<const uint8_t*>(&color), 2);
 }
 
-void St7789::DrawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t size) {
-  SetAddrWindow(x, y, x + width - 1, y + height - 1);
+void St7789::DrawBuffer(uint16_t x,
+                        uint16_t y,
+                        uint16_t width,
+                        uint16_t height,
+                        const uint8_t* data,
+                        size_t size,
+                        TransferCompletedCallback onCompleted,
+                        void* onCompletedContext) {
+  SetAddrWindow(x, y, x + width - 1);
+
+  size_t nbPixels = (pixelFormat == PixelFormats::Rgb444) ? (size * 2) / 3 : size / 2;
+  // An empty area (a progress bar at 0%) leaves the RAM pointer where the window starts
+  if (width != 0 && (nbPixels % width) == 0) {
+    nextWriteRow = y + (nbPixels / width);
+  } else {
+    InvalidateAddrWindow();
+  }
+
   nrf_gpio_pin_set(pinDataCommand);
-  WriteSpi(data, size);
+  WriteSpi(data, size, onCompleted, onCompletedContext);
 }
 
 void St7789::HardwareReset() {
@@ -170,8 +243,26 @@ void St7789::HardwareReset() {
   nrf_gpio_pin_set(26);
 }
 
+void St7789::LowPowerOn(uint16_t startRow, uint16_t endRow) {
+  CommandSequence sequence;
+  sequence.Add(Commands::PartialArea, startRow, endRow);
+  sequence.Add(Commands::PartialModeOn);
+  sequence.Add(Commands::IdleModeOn);
+  sequence.Send(spi, pinDataCommand);
+  NRF_LOG_INFO("[LCD] Low power on");
+}
+
+void St7789::LowPowerOff() {
+  CommandSequence sequence;
+  sequence.Add(Commands::IdleModeOff);
+  sequence.Add(Commands::NormalModeOn);
+  sequence.Send(spi, pinDataCommand);
+  NRF_LOG_INFO("[LCD] Low power off");
+}
+
 void St7789::Sleep() {
   SleepIn();
+  InvalidateAddrWindow();
   nrf_gpio_cfg_default(pinDataCommand);
   NRF_LOG_INFO("[LCD] Sleep");
 }
@@ -181,5 +272,31 @@ void St7789::Wakeup() {
   SleepOut();
   VerticalScrollStartAddress(verticalScrollingStartAddress);
   DisplayOn();
+  InvalidateAddrWindow();
   NRF_LOG_INFO("[LCD] Wakeup")
 }
+
+void St7789::CommandSequence::Add(Commands command) {
+  Add(command, nullptr, 0);
+}
+
+void St7789::CommandSequence::Add(Commands command, const uint8_t* parameters, size_t size) {
+  ASSERT((this->size + 1 + size) <= maxSize && nbRuns < maxRuns);
+  data[this->size++] = static_cast<uint8_t>(command);
+  for (size_t i = 0; i < size; i++) {
+    data[this->size++] = parameters[i];
+  }
+  runSizes[nbRuns++] = 1 + size;
+}
+
+void St7789::CommandSequence::Add(Commands command, uint16_t start, uint16_t end) {
+  uint8_t parameters[] = {static_cast<uint8_t>(start >> 8u),
+                          static_cast<uint8_t>(start & 0xffu),
+                          static_cast<uint8_t>(end >> 8u),
+                          static_cast<uint8_t>(end & 0xffu)};
+  Add(command, parameters, sizeof(parameters));
+}
+
+void St7789::CommandSequence::Send(Spi& spi, uint8_t pinDataCommand) const {
+  spi.WriteCommandSequence(pinDataCommand, data, runSizes, nbRuns);
+}
@@ -7,6 +7,11 @@ namespace Pinetime {
     class Spi;
     class St7789 {
     public:
+      using TransferCompletedCallback = void (*)(void* context);
+
+      // Interface pixel formats (COLMOD). Rgb444 packs 2 pixels in 3 bytes.
+      enum class PixelFormats : uint8_t { Rgb444 = 0x53, Rgb565 = 0x55 };
+
       explicit St7789(Spi& spi, uint8_t pinDataCommand);
       St7789(const St7789&) = delete;
       St7789& operator=(const St7789&) = delete;
@@ -20,15 +25,50 @@ namespace Pinetime {
       void VerticalScrollDefinition(uint16_t topFixedLines, uint16_t scrollLines, uint16_t bottomFixedLines);
       void VerticalScrollStartAddress(uint16_t line);
 
-      void DrawBuffer(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* data, size_t size);
+      /** Starts sending the buffer to the display and returns without waiting for the transfer to finish.
+       * onCompleted is called (from the SPI interrupt) once the whole buffer has been sent. */
+      void DrawBuffer(uint16_t x,
+                      uint16_t y,
+                      uint16_t width,
+                      uint16_t height,
+                      const uint8_t* data,
+                      size_t size,
+                      TransferCompletedCallback onCompleted = nullptr,
+                      void* onCompletedContext = nullptr);
 
       void Sleep();
       void Wakeup();
 
+      /** Only displays the frame memory rows from startRow to endRow (inclusive, the area wraps around if
+       * endRow < startRow) with 8 colours, the rest of the panel is black. */
+      void LowPowerOn(uint16_t startRow, uint16_t endRow);
+      void LowPowerOff();
+
+      /** Must not be called while a DrawBuffer() transfer is in progress.
+       * The frame memory is not converted: the next buffers must be sent in the new format. */
+      void SetPixelFormat(PixelFormats format);
+      PixelFormats GetPixelFormat() const {
+        return pixelFormat;
+      }
+
+      static constexpr size_t BufferSize(size_t nbPixels, PixelFormats format) {
+        // An odd last pixel of an Rgb444 buffer takes 2 bytes
+        return (format == PixelFormats::Rgb444) ? (nbPixels * 3 + 1) / 2 : nbPixels * 2;
+      }
+
+      /** Converts nbPixels RGB565 pixels (big endian, as sent to the display) to packed RGB444, in place.
+       * @return the size of the packed buffer */
+      static size_t PackRgb444(uint8_t* buffer, size_t nbPixels);
+
+      // Bytes sent to set up the address window of a DrawBuffer() call in the worst case
+      // (CASET and RASET with their 4 parameters, then RAMWR).
+      static constexpr size_t AddrWindowSetupSize = (1 + 4) + (1 + 4) + 1;
+
     private:
       Spi& spi;
       uint8_t pinDataCommand;
       uint8_t verticalScrollingStartAddress = 0;
+      PixelFormats pixelFormat = PixelFormats::Rgb565;
 
       void HardwareReset();
       void SoftwareReset();
@@ -42,15 +82,21 @@ namespace Pinetime {
       void DisplayOn();
       void DisplayOff();
 
-      void SetAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+      void SetAddrWindow(uint16_t x0, uint16_t y0, uint16_t x1);
+      void InvalidateAddrWindow();
       void SetVdv();
       void WriteCommand(uint8_t cmd);
-      void WriteSpi(const uint8_t* data, size_t size);
+      void WriteCommand(uint8_t cmd, const uint8_t* parameters, size_t size);
+      void WriteSpi(const uint8_t* data,
+                    size_t size,
+                    TransferCompletedCallback onCompleted = nullptr,
+                    void* onCompletedContext = nullptr);
 
       enum class Commands : uint8_t {
         SoftwareReset = 0x01,
         SleepIn = 0x10,
         SleepOut = 0x11,
+        PartialModeOn = 0x12,
         NormalModeOn = 0x13,
         DisplayInversionOn = 0x21,
         DisplayOff = 0x28,
@@ -58,9 +104,13 @@ namespace Pinetime {
         ColumnAddressSet = 0x2a,
         RowAddressSet = 0x2b,
         WriteToRam = 0x2c,
+        PartialArea = 0x30,
+        WriteToRamContinue = 0x3c,
         MemoryDataAccessControl = 0x36,
         VerticalScrollDefinition = 0x33,
         VerticalScrollStartAddress = 0x37,
+        IdleModeOff = 0x38,
+        IdleModeOn = 0x39,
         ColMod = 0x3a,
         VdvSet = 0xc4,
       };
@@ -70,6 +120,30 @@ namespace Pinetime {
       static constexpr uint16_t Width = 240;
       static constexpr uint16_t Height = 320;
       void RowAddressSet();
+
+      // Commands and their parameters packed in a single buffer so that they are sent in a single SPI transaction
+      class CommandSequence {
+      public:
+        void Add(Commands command);
+        void Add(Commands command, const uint8_t* parameters, size_t size);
+        void Add(Commands command, uint16_t start, uint16_t end);
+        void Send(Spi& spi, uint8_t pinDataCommand) const;
+
+      private:
+        static constexpr size_t maxSize = 16;
+        static constexpr size_t maxRuns = 4;
+        uint8_t data[maxSize];
+        uint8_t runSizes[maxRuns];
+        uint8_t size = 0;
+        uint8_t nbRuns = 0;
+      };
+
+      // Address window of the last write to the RAM. The row range always extends to the bottom of the frame memory
+      // so that the next band can be written with WriteToRamContinue if it starts on the next row.
+      bool addrWindowValid = false;
+      uint16_t addrWindowX0 = 0;
+      uint16_t addrWindowX1 = 0;
+      uint16_t nextWriteRow = 0;
     };
   }
 }
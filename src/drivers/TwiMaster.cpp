@@ -2,11 +2,16 @@
 #include <cstring>
 #include <hal/nrf_gpio.h>
 #include <nrfx_log.h>
+#include <task.h>
 
 using namespace Pinetime::Drivers;
 
-// TODO use shortcut to automatically send STOP when receive LastTX, for example
-// TODO use DMA/IRQ
+namespace {
+  // EasyDMA takes 32 bits addresses
+  uint32_t ToAddress(const volatile void* pointer) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer));
+  }
+}
 
 TwiMaster::TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl)
   : module {module}, frequency {frequency}, pinSda {pinSda}, pinScl {pinScl} {
@@ -26,6 +31,9 @@ void TwiMaster::Init() {
   if (mutex == nullptr) {
     mutex = xSemaphoreCreateBinary();
   }
+  if (transactionCompleted == nullptr) {
+    transactionCompleted = xSemaphoreCreateBinary();
+  }
 
   ConfigurePins();
 
@@ -43,116 +51,233 @@ void TwiMaster::Init() {
   twiBaseAddress->EVENTS_SUSPENDED = 0;
   twiBaseAddress->EVENTS_TXSTARTED = 0;
 
-  twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
+  twiBaseAddress->INTEN = TWIM_INTEN_STOPPED_Msk | TWIM_INTEN_ERROR_Msk;
 
-  xSemaphoreGive(mutex);
-}
+  NRFX_IRQ_PRIORITY_SET(nrfx_get_irq_number(twiBaseAddress), 2);
+  NRFX_IRQ_ENABLE(nrfx_get_irq_number(twiBaseAddress));
 
-TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* data, size_t size) {
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  Wakeup();
-  auto ret = Write(deviceAddress, &registerAddress, 1, false);
-  ret = Read(deviceAddress, data, size, true);
+  // The TWIM is enabled while transactions are queued
   Sleep();
+
   xSemaphoreGive(mutex);
-  return ret;
+}
+
+TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* buffer, size_t size) {
+  Transaction transaction;
+  PrepareRead(transaction, deviceAddress, registerAddress, buffer, size, OnBlockingTransactionCompleted, this);
+  return Execute(transaction);
 }
 
 TwiMaster::ErrorCodes TwiMaster::Write(uint8_t deviceAddress, uint8_t registerAddress, const uint8_t* data, size_t size) {
-  ASSERT(size <= maxDataSize);
-  xSemaphoreTake(mutex, portMAX_DELAY);
-  Wakeup();
-  internalBuffer[0] = registerAddress;
-  std::memcpy(internalBuffer + 1, data, size);
-  auto ret = Write(deviceAddress, internalBuffer, size + 1, true);
-  Sleep();
-  xSemaphoreGive(mutex);
-  return ret;
+  Transaction transaction;
+  PrepareWrite(transaction, deviceAddress, registerAddress, data, size, OnBlockingTransactionCompleted, this);
+  return Execute(transaction);
 }
 
-TwiMaster::ErrorCodes TwiMaster::Read(uint8_t deviceAddress, uint8_t* buffer, size_t size, bool stop) {
-  twiBaseAddress->ADDRESS = deviceAddress;
-  twiBaseAddress->TASKS_RESUME = 0x1UL;
-  twiBaseAddress->RXD.PTR = (uint32_t) buffer;
-  twiBaseAddress->RXD.MAXCNT = size;
+bool TwiMaster::ReadAsync(Transaction& transaction,
+                          uint8_t deviceAddress,
+                          uint8_t registerAddress,
+                          uint8_t* buffer,
+                          size_t size,
+                          TransactionCompletedCallback onCompleted,
+                          void* onCompletedContext) {
+  PrepareRead(transaction, deviceAddress, registerAddress, buffer, size, onCompleted, onCompletedContext);
+  return Submit(transaction);
+}
 
-  twiBaseAddress->TASKS_STARTRX = 1;
+bool TwiMaster::WriteAsync(Transaction& transaction,
+                           uint8_t deviceAddress,
+                           uint8_t registerAddress,
+                           const uint8_t* data,
+                           size_t size,
+                           TransactionCompletedCallback onCompleted,
+                           void* onCompletedContext) {
+  PrepareWrite(transaction, deviceAddress, registerAddress, data, size, onCompleted, onCompletedContext);
+  return Submit(transaction);
+}
 
-  while (!twiBaseAddress->EVENTS_RXSTARTED && !twiBaseAddress->EVENTS_ERROR)
-    ;
-  twiBaseAddress->EVENTS_RXSTARTED = 0x0UL;
+void TwiMaster::PrepareRead(Transaction& transaction,
+                            uint8_t deviceAddress,
+                            uint8_t registerAddress,
+                            uint8_t* buffer,
+                            size_t size,
+                            TransactionCompletedCallback onCompleted,
+                            void* onCompletedContext) {
+  // RXD.MAXCNT is 8 bits wide
+  ASSERT(size <= UINT8_MAX);
+  transaction.deviceAddress = deviceAddress;
+  transaction.txBuffer[0] = registerAddress;
+  transaction.txSize = registerSize;
+  transaction.rxBuffer = buffer;
+  transaction.rxSize = size;
+  transaction.onCompleted = onCompleted;
+  transaction.onCompletedContext = onCompletedContext;
+}
 
-  txStartedCycleCount = DWT->CYCCNT;
-  uint32_t currentCycleCount;
-  while (!twiBaseAddress->EVENTS_LASTRX && !twiBaseAddress->EVENTS_ERROR) {
-    currentCycleCount = DWT->CYCCNT;
-    if ((currentCycleCount - txStartedCycleCount) > HwFreezedDelay) {
-      FixHwFreezed();
-      return ErrorCodes::TransactionFailed;
-    }
+void TwiMaster::PrepareWrite(Transaction& transaction,
+                             uint8_t deviceAddress,
+                             uint8_t registerAddress,
+                             const uint8_t* data,
+                             size_t size,
+                             TransactionCompletedCallback onCompleted,
+                             void* onCompletedContext) {
+  ASSERT(size <= maxDataSize);
+  transaction.deviceAddress = deviceAddress;
+  transaction.txBuffer[0] = registerAddress;
+  std::memcpy(transaction.txBuffer + registerSize, data, size);
+  transaction.txSize = registerSize + size;
+  transaction.rxBuffer = nullptr;
+  transaction.rxSize = 0;
+  transaction.onCompleted = onCompleted;
+  transaction.onCompletedContext = onCompletedContext;
+}
+
+bool TwiMaster::Submit(Transaction& transaction) {
+  transaction.result = ErrorCodes::NoError;
+
+  taskENTER_CRITICAL();
+  uint32_t startCycleCount = DWT->CYCCNT;
+  if (queueLength == queueSize) {
+    taskEXIT_CRITICAL();
+    return false;
+  }
+  transaction.pending = true;
+  queue[(queueHead + queueLength) % queueSize] = &transaction;
+  queueLength++;
+  if (queueLength > statistics.maxPending) {
+    statistics.maxPending = queueLength;
   }
-  twiBaseAddress->EVENTS_LASTRX = 0x0UL;
 
-  if (stop || twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->TASKS_STOP = 0x1UL;
-    while (!twiBaseAddress->EVENTS_STOPPED)
-      ;
-    twiBaseAddress->EVENTS_STOPPED = 0x0UL;
-  } else {
-    twiBaseAddress->TASKS_SUSPEND = 0x1UL;
-    while (!twiBaseAddress->EVENTS_SUSPENDED)
-      ;
-    twiBaseAddress->EVENTS_SUSPENDED = 0x0UL;
+  if (queueLength == 1) {
+    Wakeup();
+    Start(transaction);
   }
+  statistics.cpuCycles += DWT->CYCCNT - startCycleCount;
+  taskEXIT_CRITICAL();
+  return true;
+}
 
-  if (twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->EVENTS_ERROR = 0x0UL;
+TwiMaster::ErrorCodes TwiMaster::Execute(Transaction& transaction) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  if (!Submit(transaction)) {
+    xSemaphoreGive(mutex);
+    return ErrorCodes::TransactionFailed;
+  }
+  if (xSemaphoreTake(transactionCompleted, transactionTimeout) == pdFALSE) {
+    Abort(transaction);
+    // In case it completed just after the timeout
+    xSemaphoreTake(transactionCompleted, 0);
   }
-  return ErrorCodes::NoError;
+  xSemaphoreGive(mutex);
+  return transaction.result;
+}
+
+void TwiMaster::OnBlockingTransactionCompleted(void* context) {
+  auto* twiMaster = static_cast<TwiMaster*>(context);
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  xSemaphoreGiveFromISR(twiMaster->transactionCompleted, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
-TwiMaster::ErrorCodes TwiMaster::Write(uint8_t deviceAddress, const uint8_t* data, size_t size, bool stop) {
-  twiBaseAddress->ADDRESS = deviceAddress;
-  twiBaseAddress->TASKS_RESUME = 0x1UL;
-  twiBaseAddress->TXD.PTR = (uint32_t) data;
-  twiBaseAddress->TXD.MAXCNT = size;
+void TwiMaster::Start(Transaction& transaction) {
+  twiBaseAddress->ADDRESS = transaction.deviceAddress;
+  twiBaseAddress->TXD.PTR = ToAddress(transaction.txBuffer);
+  twiBaseAddress->TXD.MAXCNT = transaction.txSize;
+  if (transaction.rxSize > 0) {
+    // Repeated start to receive the data once the register address is sent, then STOP once it is received
+    twiBaseAddress->RXD.PTR = ToAddress(transaction.rxBuffer);
+    twiBaseAddress->RXD.MAXCNT = transaction.rxSize;
+    twiBaseAddress->SHORTS = TWIM_SHORTS_LASTTX_STARTRX_Msk | TWIM_SHORTS_LASTRX_STOP_Msk;
+  } else {
+    twiBaseAddress->SHORTS = TWIM_SHORTS_LASTTX_STOP_Msk;
+  }
+  twiBaseAddress->EVENTS_STOPPED = 0;
+  twiBaseAddress->EVENTS_ERROR = 0;
+  error = false;
 
   twiBaseAddress->TASKS_STARTTX = 1;
+  txStartedCycleCount = DWT->CYCCNT;
+}
 
-  while (!twiBaseAddress->EVENTS_TXSTARTED && !twiBaseAddress->EVENTS_ERROR)
-    ;
-  twiBaseAddress->EVENTS_TXSTARTED = 0x0UL;
+void TwiMaster::OnInterrupt() {
+  uint32_t startCycleCount = DWT->CYCCNT;
+  statistics.interrupts++;
 
-  txStartedCycleCount = DWT->CYCCNT;
-  uint32_t currentCycleCount;
-  while (!twiBaseAddress->EVENTS_LASTTX && !twiBaseAddress->EVENTS_ERROR) {
-    currentCycleCount = DWT->CYCCNT;
-    if ((currentCycleCount - txStartedCycleCount) > HwFreezedDelay) {
-      FixHwFreezed();
-      return ErrorCodes::TransactionFailed;
+  if (twiBaseAddress->EVENTS_ERROR) {
+    twiBaseAddress->EVENTS_ERROR = 0;
+    uint32_t errorSource = twiBaseAddress->ERRORSRC;
+    twiBaseAddress->ERRORSRC = errorSource;
+    error = true;
+    if (!twiBaseAddress->EVENTS_STOPPED) {
+      // The TWIM is suspended after a NACK, it must be resumed to send the STOP condition
+      twiBaseAddress->TASKS_RESUME = 1;
+      twiBaseAddress->TASKS_STOP = 1;
     }
   }
-  twiBaseAddress->EVENTS_LASTTX = 0x0UL;
 
-  if (stop || twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->TASKS_STOP = 0x1UL;
-    while (!twiBaseAddress->EVENTS_STOPPED)
-      ;
-    twiBaseAddress->EVENTS_STOPPED = 0x0UL;
+  if (twiBaseAddress->EVENTS_STOPPED) {
+    twiBaseAddress->EVENTS_STOPPED = 0;
+    statistics.busCycles += startCycleCount - txStartedCycleCount;
+    if (queueLength > 0) {
+      CompleteCurrent(error ? ErrorCodes::TransactionFailed : ErrorCodes::NoError);
+    }
+  }
+
+  statistics.cpuCycles += DWT->CYCCNT - startCycleCount;
+}
+
+void TwiMaster::CompleteCurrent(ErrorCodes result) {
+  Transaction* transaction = queue[queueHead];
+  queueHead = (queueHead + 1) % queueSize;
+  queueLength--;
+
+  statistics.transactions++;
+  if (result != ErrorCodes::NoError) {
+    statistics.errors++;
+  }
+
+  // The bus is given to the next transaction before the client is notified
+  if (queueLength > 0) {
+    Start(*queue[queueHead]);
   } else {
-    twiBaseAddress->TASKS_SUSPEND = 0x1UL;
-    while (!twiBaseAddress->EVENTS_SUSPENDED)
-      ;
-    twiBaseAddress->EVENTS_SUSPENDED = 0x0UL;
+    Sleep();
   }
 
-  if (twiBaseAddress->EVENTS_ERROR) {
-    twiBaseAddress->EVENTS_ERROR = 0x0UL;
-    uint32_t error = twiBaseAddress->ERRORSRC;
-    twiBaseAddress->ERRORSRC = error;
+  transaction->result = result;
+  transaction->pending = false;
+  if (transaction->onCompleted != nullptr) {
+    transaction->onCompleted(transaction->onCompletedContext);
+  }
+}
+
+void TwiMaster::Abort(Transaction& transaction) {
+  taskENTER_CRITICAL();
+  if (!transaction.pending) {
+    taskEXIT_CRITICAL();
+    return;
   }
 
-  return ErrorCodes::NoError;
+  statistics.timeouts++;
+  transaction.onCompleted = nullptr;
+  if (queue[queueHead] == &transaction) {
+    FixHwFreezed();
+    CompleteCurrent(ErrorCodes::TransactionFailed);
+  } else {
+    // Still waiting behind the transaction in progress
+    for (uint8_t i = 1; i < queueLength; i++) {
+      if (queue[(queueHead + i) % queueSize] == &transaction) {
+        for (uint8_t j = i + 1; j < queueLength; j++) {
+          queue[(queueHead + j - 1) % queueSize] = queue[(queueHead + j) % queueSize];
+        }
+        queueLength--;
+        break;
+      }
+    }
+    transaction.result = ErrorCodes::TransactionFailed;
+    transaction.pending = false;
+  }
+  taskEXIT_CRITICAL();
+  NRF_LOG_INFO("I2C transaction timed out (device 0x%02x)", transaction.deviceAddress);
 }
 
 void TwiMaster::Sleep() {
@@ -163,17 +288,17 @@ void TwiMaster::Wakeup() {
   twiBaseAddress->ENABLE = (TWIM_ENABLE_ENABLE_Enabled << TWIM_ENABLE_ENABLE_Pos);
 }
 
-/* Sometimes, the TWIM device just freeze and never set the event EVENTS_LASTTX.
+/* Sometimes, the TWIM device just freeze and never set the event EVENTS_STOPPED.
  * This method disable and re-enable the peripheral so that it works again.
  * This is just a workaround, and it would be better if we could find a way to prevent
  * this issue from happening.
  * */
 void TwiMaster::FixHwFreezed() {
-  NRF_LOG_INFO("I2C device frozen, reinitializing it!");
-
-  uint32_t twi_state = NRF_TWI1->ENABLE;
+  uint32_t twi_state = twiBaseAddress->ENABLE;
 
   Sleep();
+  twiBaseAddress->EVENTS_STOPPED = 0;
+  twiBaseAddress->EVENTS_ERROR = 0;
 
   twiBaseAddress->ENABLE = twi_state;
 }
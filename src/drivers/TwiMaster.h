@@ -2,40 +2,126 @@
 #include <FreeRTOS.h>
 #include <semphr.h>
 #include <drivers/include/nrfx_twi.h> // NRF_TWIM_Type
+#include <cstddef>
 #include <cstdint>
 
 namespace Pinetime {
   namespace Drivers {
+    /* Transactions are queued and executed by the TWIM (EasyDMA) from its interrupt: a register read is a single
+     * transaction (the register address is sent, then the data is received after a repeated start and the STOP
+     * condition is sent by the shortcuts of the TWIM), the CPU is only involved to start it and when it is done.
+     */
     class TwiMaster {
     public:
       enum class ErrorCodes { NoError, TransactionFailed };
+      using TransactionCompletedCallback = void (*)(void* context);
+
+      static constexpr uint8_t maxDataSize {16};
+      static constexpr uint8_t registerSize {1};
+
+      // Owned by the client, must remain valid until it is completed
+      struct Transaction {
+        uint8_t deviceAddress;
+        // Register address, followed by the data to write
+        uint8_t txBuffer[registerSize + maxDataSize];
+        uint8_t txSize;
+        uint8_t* rxBuffer;
+        uint8_t rxSize;
+        TransactionCompletedCallback onCompleted;
+        void* onCompletedContext;
+        volatile bool pending;
+        volatile ErrorCodes result;
+      };
+
+      struct Statistics {
+        uint32_t transactions;
+        uint32_t errors;
+        uint32_t timeouts;
+        uint32_t interrupts;
+        // CPU cycles spent to start the transactions and to handle their interrupts
+        uint32_t cpuCycles;
+        // Cycles between the start of the transactions and their end, during which the CPU is free
+        uint32_t busCycles;
+        uint8_t maxPending;
+      };
 
       TwiMaster(NRF_TWIM_Type* module, uint32_t frequency, uint8_t pinSda, uint8_t pinScl);
 
       void Init();
+      /** Blocks the calling task (without spinning) until the data is received */
       ErrorCodes Read(uint8_t deviceAddress, uint8_t registerAddress, uint8_t* buffer, size_t size);
       ErrorCodes Write(uint8_t deviceAddress, uint8_t registerAddress, const uint8_t* data, size_t size);
 
+      /** Queue the same transactions as Read() and Write(), and return immediately. onCompleted is called from the
+       * TWIM interrupt once the transaction is done, with its result in transaction.result. Must be called from a
+       * task. Return false if the queue is full. */
+      bool ReadAsync(Transaction& transaction,
+                     uint8_t deviceAddress,
+                     uint8_t registerAddress,
+                     uint8_t* buffer,
+                     size_t size,
+                     TransactionCompletedCallback onCompleted,
+                     void* onCompletedContext);
+      bool WriteAsync(Transaction& transaction,
+                      uint8_t deviceAddress,
+                      uint8_t registerAddress,
+                      const uint8_t* data,
+                      size_t size,
+                      TransactionCompletedCallback onCompleted,
+                      void* onCompletedContext);
+
+      void OnInterrupt();
+
       void Sleep();
       void Wakeup();
 
+      const Statistics& GetStatistics() const {
+        return statistics;
+      }
+
     private:
-      ErrorCodes Read(uint8_t deviceAddress, uint8_t* buffer, size_t size, bool stop);
-      ErrorCodes Write(uint8_t deviceAddress, const uint8_t* data, size_t size, bool stop);
+      bool Submit(Transaction& transaction);
+      ErrorCodes Execute(Transaction& transaction);
+      void Abort(Transaction& transaction);
+      void Start(Transaction& transaction);
+      void CompleteCurrent(ErrorCodes result);
       void FixHwFreezed();
       void ConfigurePins() const;
+      static void OnBlockingTransactionCompleted(void* context);
+      static void PrepareRead(Transaction& transaction,
+                              uint8_t deviceAddress,
+                              uint8_t registerAddress,
+                              uint8_t* buffer,
+                              size_t size,
+                              TransactionCompletedCallback onCompleted,
+                              void* onCompletedContext);
+      static void PrepareWrite(Transaction& transaction,
+                               uint8_t deviceAddress,
+                               uint8_t registerAddress,
+                               const uint8_t* data,
+                               size_t size,
+                               TransactionCompletedCallback onCompleted,
+                               void* onCompletedContext);
+
+      static constexpr uint8_t queueSize {8};
+      // Transactions are at most 17 bytes long (400µs at 400KHz), including the ones queued before
+      static constexpr TickType_t transactionTimeout {pdMS_TO_TICKS(20)};
 
       NRF_TWIM_Type* twiBaseAddress;
       SemaphoreHandle_t mutex = nullptr;
+      SemaphoreHandle_t transactionCompleted = nullptr;
       NRF_TWIM_Type* module;
       uint32_t frequency;
       uint8_t pinSda;
       uint8_t pinScl;
-      static constexpr uint8_t maxDataSize {16};
-      static constexpr uint8_t registerSize {1};
-      uint8_t internalBuffer[maxDataSize + registerSize];
-      uint32_t txStartedCycleCount = 0;
-      static constexpr uint32_t HwFreezedDelay {161000};
+
+      // The first transaction of the queue is the one in progress
+      Transaction* queue[queueSize];
+      volatile uint8_t queueHead = 0;
+      volatile uint8_t queueLength = 0;
+      volatile uint32_t txStartedCycleCount = 0;
+      volatile bool error = false;
+      Statistics statistics = {};
     };
   }
 }
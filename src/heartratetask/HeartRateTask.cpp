@@ -1,12 +1,21 @@
 #include "heartratetask/HeartRateTask.h"
+#include <hal/nrf_rtc.h>
 #include <drivers/Hrs3300.h>
 #include <components/heartrate/HeartRateController.h>
 #include <nrf_log.h>
 
 using namespace Pinetime::Applications;
 
+namespace {
+  // The samples are taken on the COMPARE[0] events of RTC2 (32768Hz), at the rate of the filters of Ppg (24Hz)
+  constexpr uint32_t samplePeriod = 32768 / 24;
+  constexpr uint32_t rtcCounterMask = 0xffffff;
+  // In case an event is missed
+  constexpr TickType_t sampleTimeout = 2 * samplePeriod * configTICK_RATE_HZ / 32768;
+}
+
 HeartRateTask::HeartRateTask(Drivers::Hrs3300& heartRateSensor, Controllers::HeartRateController& controller)
-  : heartRateSensor {heartRateSensor}, controller {controller}, ppg {} {
+  : heartRateSensor {heartRateSensor}, controller {controller}, ppg {configTICK_RATE_HZ} {
 }
 
 void HeartRateTask::Start() {
@@ -28,9 +37,11 @@ void HeartRateTask::Work() {
     Messages msg;
     uint32_t delay;
     if (state == States::Running) {
-      if (measurementStarted)
-        delay = 40;
-      else
+      if (measurementStarted) {
+        // The messages are handled between the samples, which are paced by the sample timer
+        ulTaskNotifyTake(pdTRUE, sampleTimeout);
+        delay = 0;
+      } else
         delay = 100;
     } else
       delay = portMAX_DELAY;
@@ -64,8 +75,9 @@ void HeartRateTask::Work() {
       }
     }
 
-    if (measurementStarted) {
-      ppg.Preprocess(static_cast<float>(heartRateSensor.ReadHrs()));
+    Drivers::Hrs3300::Sample sample;
+    if (measurementStarted && heartRateSensor.ReadSample(sample)) {
+      ppg.Preprocess(sample.hrs, sample.timestamp);
       auto bpm = ppg.HeartRate();
 
       if (lastBpm == 0 && bpm == 0)
@@ -88,13 +100,57 @@ void HeartRateTask::PushMessage(HeartRateTask::Messages msg) {
   }
 }
 
+void HeartRateTask::OnSampleTimerEvent() {
+  NRF_RTC2->CC[0] = (NRF_RTC2->CC[0] + samplePeriod) & rtcCounterMask;
+
+  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+  vTaskNotifyGiveFromISR(taskHandle, &xHigherPriorityTaskWoken);
+  portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
 void HeartRateTask::StartMeasurement() {
   heartRateSensor.Enable();
   vTaskDelay(100);
-  ppg.SetOffset(static_cast<float>(heartRateSensor.ReadHrs()));
+  Drivers::Hrs3300::Sample sample;
+  if (heartRateSensor.ReadSample(sample)) {
+    ppg.SetOffset(sample.hrs);
+  }
+  StartSampleTimer();
 }
 
 void HeartRateTask::StopMeasurement() {
+  StopSampleTimer();
   heartRateSensor.Disable();
   vTaskDelay(100);
+
+  const auto& statistics = heartRateSensor.GetStatistics();
+  if (statistics.samples > 0) {
+    NRF_LOG_INFO("[HeartRateTask] %d samples, %d I2C transactions, latency %d us (max %d us)",
+                 statistics.samples,
+                 statistics.transactions,
+                 statistics.totalLatency / statistics.samples / (SystemCoreClock / 1000000),
+                 statistics.maxLatency / (SystemCoreClock / 1000000));
+  }
+}
+
+void HeartRateTask::StartSampleTimer() {
+  NRF_RTC2->TASKS_STOP = 1;
+  NRF_RTC2->TASKS_CLEAR = 1;
+  NRF_RTC2->PRESCALER = 0;
+  NRF_RTC2->CC[0] = samplePeriod;
+  NRF_RTC2->EVENTS_COMPARE[0] = 0;
+  NRF_RTC2->INTENSET = RTC_INTENSET_COMPARE0_Msk;
+
+  NRFX_IRQ_PRIORITY_SET(RTC2_IRQn, 2);
+  NRFX_IRQ_ENABLE(RTC2_IRQn);
+
+  // Samples taken before are not paced by the timer
+  ulTaskNotifyTake(pdTRUE, 0);
+  NRF_RTC2->TASKS_START = 1;
+}
+
+void HeartRateTask::StopSampleTimer() {
+  NRF_RTC2->TASKS_STOP = 1;
+  NRF_RTC2->INTENCLR = RTC_INTENCLR_COMPARE0_Msk;
+  NRFX_IRQ_DISABLE(RTC2_IRQn);
 }
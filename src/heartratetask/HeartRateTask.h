@@ -21,11 +21,14 @@ namespace Pinetime {
       void Start();
       void Work();
       void PushMessage(Messages msg);
+      void OnSampleTimerEvent();
 
     private:
       static void Process(void* instance);
       void StartMeasurement();
       void StopMeasurement();
+      void StartSampleTimer();
+      void StopSampleTimer();
 
       TaskHandle_t taskHandle;
       QueueHandle_t messageQueue;
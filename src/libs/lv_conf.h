@@ -70,12 +70,13 @@ typedef int16_t lv_coord_t;
 /* LittelvGL's internal memory manager's settings.
  * The graphical objects and other related data are stored here. */
 
-/* 1: use custom malloc/free, 0: use the built-in `lv_mem_alloc` and `lv_mem_free` */
-#define LV_MEM_CUSTOM      0
-#if LV_MEM_CUSTOM == 0
 /* Size of the memory used by `lv_mem_alloc` in bytes (>= 2kB)*/
 #define LV_MEM_SIZE    (14U * 1024U)
 
+/* 1: use custom malloc/free, 0: use the built-in `lv_mem_alloc` and `lv_mem_free`
+ * The custom allocator is the TLSF allocator of displayapp/LvglMemory.h, in a pool of LV_MEM_SIZE bytes too */
+#define LV_MEM_CUSTOM      1
+#if LV_MEM_CUSTOM == 0
 /* Complier prefix for a big array declaration */
 #define LV_MEM_ATTR
 
@@ -86,9 +87,9 @@ typedef int16_t lv_coord_t;
 /* Automatically defrag. on free. Defrag. means joining the adjacent free cells. */
 #define LV_MEM_AUTO_DEFRAG  1
 #else       /*LV_MEM_CUSTOM*/
-#define LV_MEM_CUSTOM_INCLUDE <stdlib.h>   /*Header for the dynamic memory function*/
-#define LV_MEM_CUSTOM_ALLOC   malloc       /*Wrapper to malloc*/
-#define LV_MEM_CUSTOM_FREE    free         /*Wrapper to free*/
+#define LV_MEM_CUSTOM_INCLUDE "displayapp/LvglMemory.h"   /*Header for the dynamic memory function*/
+#define LV_MEM_CUSTOM_ALLOC   lv_pinetime_mem_alloc        /*Wrapper to malloc*/
+#define LV_MEM_CUSTOM_FREE    lv_pinetime_mem_free         /*Wrapper to free*/
 #endif     /*LV_MEM_CUSTOM*/
 
 /* Use the standard memcpy and memset instead of LVGL's own functions.
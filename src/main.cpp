@@ -69,7 +69,7 @@ Pinetime::Drivers::SpiMaster spi {Pinetime::Drivers::SpiMaster::SpiModule::SPI0,
                                    Pinetime::PinMap::SpiMosi,
                                    Pinetime::PinMap::SpiMiso}};
 
-Pinetime::Drivers::Spi lcdSpi {spi, Pinetime::PinMap::SpiLcdCsn};
+Pinetime::Drivers::Spi lcdSpi {spi, Pinetime::PinMap::SpiLcdCsn, Pinetime::Drivers::SpiMaster::Priorities::High};
 Pinetime::Drivers::St7789 lcd {lcdSpi, Pinetime::PinMap::LcdDataCommand};
 
 Pinetime::Drivers::Spi flashSpi {spi, Pinetime::PinMap::SpiFlashCsn};
@@ -131,7 +131,8 @@ Pinetime::Applications::DisplayApp displayApp(lcd,
                                               timerController,
                                               alarmController,
                                               brightnessController,
-                                              touchHandler);
+                                              touchHandler,
+                                              fs);
 
 Pinetime::System::SystemTask systemTask(spi,
                                         lcd,
@@ -209,6 +210,24 @@ void SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQHandler(void) {
   }
 }
 
+void SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQHandler(void) {
+  twiMaster.OnInterrupt();
+}
+
+void RTC2_IRQHandler(void) {
+  if (NRF_RTC2->EVENTS_COMPARE[0] == 1) {
+    NRF_RTC2->EVENTS_COMPARE[0] = 0;
+    heartRateApp.OnSampleTimerEvent();
+  }
+}
+
+void TIMER3_IRQHandler(void) {
+  if (NRF_TIMER3->EVENTS_COMPARE[0] == 1) {
+    NRF_TIMER3->EVENTS_COMPARE[0] = 0;
+    spi.OnChainEndEvent();
+  }
+}
+
 static void (*radio_isr_addr)(void);
 static void (*rng_isr_addr)(void);
 static void (*rtc0_isr_addr)(void);
@@ -303,6 +322,11 @@ void nimble_port_ll_task_func(void* args) {
 int main(void) {
   logger.Init();
 
+  // The cycle counter is used to measure the performance of the drivers and of the display, it is disabled at reset
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
   nrf_drv_clock_init();
 
   // Unblock i2c?
@@ -19,6 +19,7 @@ namespace Pinetime {
       HandleButtonEvent,
       HandleButtonTimerEvent,
       OnDisplayTaskSleeping,
+      OnDisplayTaskAlwaysOn,
       EnableSleeping,
       DisableSleeping,
       OnNewDay,
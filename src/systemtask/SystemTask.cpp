@@ -227,7 +227,9 @@ void SystemTask::Work() {
           xTimerChangePeriod(dimTimer, pdMS_TO_TICKS(settingsController.GetScreenTimeOut() - 2000), 0);
           break;
         case Messages::GoToRunning:
-          spi.Wakeup();
+          if (!isDisplayAlwaysOn) {
+            spi.Wakeup();
+          }
 
           // Double Tap needs the touch screen to be in normal mode
           if (!settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::DoubleTap)) {
@@ -236,7 +238,10 @@ void SystemTask::Work() {
 
           xTimerStart(dimTimer, 0);
           spiNorFlash.Wakeup();
-          lcd.Wakeup();
+          if (!isDisplayAlwaysOn) {
+            lcd.Wakeup();
+          }
+          isDisplayAlwaysOn = false;
 
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::GoToRunning);
           heartRateApp.PushMessage(Pinetime::Applications::HeartRateTask::Messages::WakeUp);
@@ -267,6 +272,11 @@ void SystemTask::Work() {
           }
           state = SystemTaskState::GoingToSleep; // Already set in PushMessage()
           NRF_LOG_INFO("[systemtask] Going to sleep");
+          NRF_LOG_INFO("[systemtask] I2C : %d transactions, %d errors, CPU %d cycles, bus %d cycles",
+                       twiMaster.GetStatistics().transactions,
+                       twiMaster.GetStatistics().errors,
+                       twiMaster.GetStatistics().cpuCycles,
+                       twiMaster.GetStatistics().busCycles);
           xTimerStop(idleTimer, 0);
           xTimerStop(dimTimer, 0);
           displayApp.PushMessage(Pinetime::Applications::Display::Messages::GoToSleep);
@@ -372,13 +382,18 @@ void SystemTask::Work() {
           HandleButtonAction(action);
         } break;
         case Messages::OnDisplayTaskSleeping:
+        case Messages::OnDisplayTaskAlwaysOn:
           if (BootloaderVersion::IsValid()) {
             // First versions of the bootloader do not expose their version and cannot initialize the SPI NOR FLASH
             // if it's in sleep mode. Avoid bricked device by disabling sleep mode on these versions.
             spiNorFlash.Sleep();
           }
-          lcd.Sleep();
-          spi.Sleep();
+          // The display (and the SPI bus) stay on in always on mode
+          isDisplayAlwaysOn = (message == Messages::OnDisplayTaskAlwaysOn);
+          if (!isDisplayAlwaysOn) {
+            lcd.Sleep();
+            spi.Sleep();
+          }
 
           // Double Tap needs the touch screen to be in normal mode
           if (!settingsController.isWakeUpModeOn(Pinetime::Controllers::Settings::WakeUpMode::DoubleTap)) {
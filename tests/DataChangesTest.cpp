@@ -0,0 +1,213 @@
+// Host test of the data changes published to the display task, on the emulated kernel:
+// - the controllers publish their topics at the rates of the watch (the time every second, the steps while walking,
+//   the heart rate while it is measured, a few battery and BLE changes).
+// - a display task modeled on DisplayApp::Refresh() subscribes to the topics of each watch face and sleeps until it
+//   is told that one of them changed, or for at most 1 s. Redrawing the screen takes some time, during which the
+//   topics published are coalesced in a single wake up.
+// Checks that every change of a subscribed topic reaches the display task, that the other topics never wake it up,
+// and that nothing wakes it up while the display sleeps. Reports the wake ups per second of each watch face, against
+// the 50 wake ups per second of the 20 ms refresh tasks they replace.
+#include "components/datachanges/DataChanges.h"
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <task.h>
+#include <cstdint>
+#include <cstdio>
+#include "HostStubs.h"
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  constexpr TickType_t scenarioDuration = 10 * 60 * configTICK_RATE_HZ;
+  constexpr Topics topics[] = {Topics::DateTime, Topics::Battery, Topics::Ble, Topics::HeartRate, Topics::Motion};
+  constexpr size_t nbTopics = sizeof(topics) / sizeof(topics[0]);
+
+  size_t IndexOf(Topics topic) {
+    for (size_t i = 0; i < nbTopics; i++) {
+      if (topics[i] == topic) {
+        return i;
+      }
+    }
+    return 0;
+  }
+
+  struct Counters {
+    uint32_t published[nbTopics];
+    uint32_t delivered[nbTopics];
+    // Last change of the topic, and last time the display task took it
+    TickType_t lastPublished[nbTopics];
+    TickType_t lastDelivered[nbTopics];
+    uint32_t wakeUps;
+    uint32_t dataWakeUps;
+  };
+
+  Counters counters;
+  QueueHandle_t msgQueue;
+  bool running;
+  bool displayOn;
+
+  void Publish(Topics topic) {
+    size_t index = IndexOf(topic);
+    counters.published[index]++;
+    counters.lastPublished[index] = xTaskGetTickCount();
+    DataChanges::Publish(topic);
+  }
+
+  // Same as DisplayApp::OnDataChanged()
+  void OnDataChanged(void*) {
+    uint8_t msg = 1;
+    xQueueSend(msgQueue, &msg, 0);
+  }
+
+  void DisplayTask(void* parameter) {
+    auto subscriptions = *static_cast<TopicSet*>(parameter);
+    DataChanges::Subscribe(subscriptions);
+    while (running) {
+      uint8_t msg;
+      // LVGL is idle between the changes: the task sleeps for at most 1 s, forever while the display sleeps
+      bool received = xQueueReceive(msgQueue, &msg, displayOn ? configTICK_RATE_HZ : portMAX_DELAY);
+      counters.wakeUps++;
+      counters.dataWakeUps += received ? 1 : 0;
+      TopicSet changed = DataChanges::TakePending();
+      for (size_t i = 0; i < nbTopics; i++) {
+        if ((changed & static_cast<TopicSet>(topics[i])) != 0) {
+          counters.delivered[i]++;
+          counters.lastDelivered[i] = xTaskGetTickCount();
+        }
+      }
+      if (changed != 0) {
+        // Refreshes the screen: 10 ms of rendering and flushing
+        vTaskDelay(pdMS_TO_TICKS(10));
+      }
+    }
+    vTaskDelete(nullptr);
+  }
+
+  // SystemTask: the time every second, the steps read every 100 ms while walking (2 steps per second, for half of the
+  // scenario), a battery percentage change and the BLE connection.
+  void SystemTask(void*) {
+    TickType_t start = xTaskGetTickCount();
+    uint32_t steps = 0;
+    for (TickType_t elapsed = 0; elapsed < scenarioDuration; elapsed = xTaskGetTickCount() - start) {
+      vTaskDelay(pdMS_TO_TICKS(100));
+      TickType_t now = xTaskGetTickCount() - start;
+      if (now / configTICK_RATE_HZ != elapsed / configTICK_RATE_HZ) {
+        Publish(Topics::DateTime);
+      }
+      bool walking = (now / (60 * configTICK_RATE_HZ)) % 2 == 1;
+      uint32_t newSteps = walking ? now * 2 / configTICK_RATE_HZ : steps;
+      if (newSteps != steps) {
+        steps = newSteps;
+        Publish(Topics::Motion);
+      }
+      if (now / configTICK_RATE_HZ == 300 && elapsed / configTICK_RATE_HZ != 300) {
+        Publish(Topics::Battery);
+      }
+      if (now / configTICK_RATE_HZ % 200 == 100 && elapsed / configTICK_RATE_HZ % 200 != 100) {
+        Publish(Topics::Ble);
+      }
+    }
+    vTaskDelete(nullptr);
+  }
+
+  // HeartRateTask: a new estimate every 2 s while measuring (the first 5 minutes), with a new value every other time
+  void HeartRateTask(void*) {
+    for (int i = 0; i < 150; i++) {
+      vTaskDelay(2 * configTICK_RATE_HZ);
+      if (i % 2 == 0) {
+        Publish(Topics::HeartRate);
+      }
+    }
+    vTaskDelete(nullptr);
+  }
+
+  struct WatchFace {
+    const char* name;
+    TopicSet subscriptions;
+  };
+
+  // Subscriptions() of the watch faces
+  constexpr WatchFace watchFaces[] = {
+    {"digital", Topics::DateTime | Topics::Battery | Topics::Ble | Topics::HeartRate | Topics::Motion},
+    {"analog", Topics::DateTime | Topics::Battery},
+    {"pinetimestyle", Topics::DateTime | Topics::Battery | Topics::Ble | Topics::Motion},
+    {"terminal", Topics::DateTime | Topics::Battery | Topics::Ble | Topics::HeartRate | Topics::Motion},
+  };
+
+  void Stop(void*) {
+    vTaskDelay(scenarioDuration + configTICK_RATE_HZ);
+    running = false;
+    // Wakes the display task up one last time
+    OnDataChanged(nullptr);
+    vTaskDelete(nullptr);
+  }
+
+  void RunScenario(const WatchFace& watchFace, bool on) {
+    counters = {};
+    uint8_t msg;
+    while (xQueueReceive(msgQueue, &msg, 0) == pdPASS) {
+    }
+    DataChanges::TakePending();
+    running = true;
+    displayOn = on;
+    TopicSet subscriptions = on ? watchFace.subscriptions : 0;
+    xTaskCreate(DisplayTask, "display", configMINIMAL_STACK_SIZE, &subscriptions, 2, nullptr);
+    xTaskCreate(SystemTask, "system", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+    xTaskCreate(HeartRateTask, "heartrate", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+    xTaskCreate(Stop, "stop", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+    vTaskStartScheduler();
+
+    if (!on) {
+      // Only the last message of Stop()
+      Check(counters.wakeUps == 1, watchFace.name, "display task woken up while the display sleeps");
+      return;
+    }
+
+    uint32_t subscribedChanges = 0;
+    for (size_t i = 0; i < nbTopics; i++) {
+      if ((subscriptions & static_cast<TopicSet>(topics[i])) == 0) {
+        Check(counters.delivered[i] == 0, watchFace.name, "topic delivered without subscription");
+        continue;
+      }
+      subscribedChanges += counters.published[i];
+      Check(counters.published[i] == 0 || counters.lastDelivered[i] >= counters.lastPublished[i],
+            watchFace.name,
+            "last change of a topic not delivered");
+      Check(counters.delivered[i] <= counters.published[i], watchFace.name, "topic delivered without change");
+    }
+    // The last wake up is the one of Stop()
+    Check(counters.dataWakeUps - 1 <= subscribedChanges, watchFace.name, "woken up by a topic without subscription");
+
+    double seconds = static_cast<double>(scenarioDuration) / configTICK_RATE_HZ;
+    std::printf("%s: %.2f wake ups/s (%u for %u changes of the subscribed topics, %u timeouts), 50/s when polling\n",
+                watchFace.name,
+                counters.wakeUps / seconds,
+                counters.wakeUps,
+                subscribedChanges,
+                counters.wakeUps - counters.dataWakeUps);
+  }
+}
+
+int main() {
+  msgQueue = xQueueCreate(8, 1);
+  DataChanges::SetListener(OnDataChanged, nullptr);
+
+  for (const auto& watchFace : watchFaces) {
+    RunScenario(watchFace, true);
+  }
+  RunScenario(watchFaces[0], false);
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+// Host test of the fixed-point preprocessing of the heart rate samples: runs the same synthetic PPG signals through the
+// fixed-point filters and through the float filters of the original algorithm, and compares the int8_t samples given
+// to the heart rate estimator.
+#include "components/heartrate/Biquad.h"
+#include "components/heartrate/FixedPointFilters.h"
+#include "components/heartrate/Ptagc.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  constexpr int offset = 30000;
+  constexpr int nbSamples = 5000;
+  // The outputs are rounded to integers in [-100, 100]
+  constexpr int maxDifference = 1;
+  constexpr double maxMeanDifference = 0.05;
+}
+
+int main() {
+  int failures = 0;
+
+  for (int seed = 1; seed <= 5; seed++) {
+    srand(seed);
+    // Same coefficients as in Ppg
+    Biquad hpf {0.87033078, -1.74066156, 0.87033078, -1.72377617, 0.75754694};
+    Ptagc agc {20, 0.971, 2};
+    Biquad lpf {0.11595249, 0.23190498, 0.11595249, -0.72168143, 0.18549138};
+    FixedPoint::Biquad32 fixedHpf {0.87033078, -1.74066156, 0.87033078, -1.72377617, 0.75754694};
+    FixedPoint::Ptagc fixedAgc {20, 0.971, 2};
+    FixedPoint::Biquad16 fixedLpf {0.11595249, 0.23190498, 0.11595249, -0.72168143, 0.18549138};
+
+    // From a weak to a strong signal, with a motion artifact large enough to be clipped by the AGC
+    double amplitude = 50.0 * seed * seed;
+    int maxDiff = 0;
+    long sumDiff = 0;
+    for (int i = 0; i < nbSamples; i++) {
+      double t = i / 24.0;
+      auto raw = static_cast<uint32_t>(30500 + amplitude * std::sin(2 * M_PI * (1 + 0.1 * seed) * t) +
+                                       0.3 * amplitude * std::sin(2 * M_PI * 2.4 * t) + 200 * std::sin(2 * M_PI * 0.05 * t) +
+                                       (rand() % 41 - 20) + (i > 2000 && i < 2100 ? 3000 : 0));
+
+      auto value = static_cast<float>(static_cast<int32_t>(raw) - offset);
+      value = hpf.Step(value);
+      value = agc.Step(value);
+      value = lpf.Step(value);
+      auto expected = static_cast<int8_t>(value);
+
+      int32_t fixedValue = (static_cast<int32_t>(raw) - offset) * 256;
+      fixedValue = fixedHpf.Step(fixedValue);
+      fixedValue = fixedAgc.Step(fixedValue);
+      fixedValue = fixedLpf.Step(static_cast<int16_t>(fixedValue));
+      auto actual = static_cast<int8_t>(fixedValue / 256);
+
+      int diff = std::abs(expected - actual);
+      maxDiff = diff > maxDiff ? diff : maxDiff;
+      sumDiff += diff;
+    }
+
+    double meanDiff = static_cast<double>(sumDiff) / nbSamples;
+    bool ok = maxDiff <= maxDifference && meanDiff <= maxMeanDifference;
+    std::printf("%s amplitude %5.0f: max difference %d, mean difference %.3f\n", ok ? "OK  " : "FAIL", amplitude, maxDiff, meanDiff);
+    failures += ok ? 0 : 1;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,441 @@
+// Host test of the fonts loaded from the filesystem and of the glyph cache:
+// - the GlyphCache against a reference LRU model: random lookups, insertions and removals of bitmaps of random sizes,
+//   checking the hits, the evictions and the content of the bitmaps moved by the compaction of the pool.
+// - FsFont on a font file in the LVGL binary format with the character ranges of the notification font (20px, 1 bpp),
+//   written by this test: every glyph descriptor and bitmap read through the cache is compared with what was written.
+// - the flash reads done to render a notification, with a cold cache and then with a warm one (the screen is redrawn).
+#include "displayapp/FsFont.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "HostFs.h"
+#include "displayapp/GlyphCache.h"
+#include "drivers/Spi.h"
+#include "drivers/SpiMaster.h"
+#include "drivers/SpiNorFlash.h"
+
+using namespace Pinetime::Components;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  uint8_t Pattern(const void* owner, uint16_t glyphId, size_t index) {
+    return static_cast<uint8_t>(reinterpret_cast<uintptr_t>(owner) * 7 + glyphId * 13 + index);
+  }
+
+  // Same replacement policy as GlyphCache, without the pool
+  struct ModelEntry {
+    const void* owner;
+    uint16_t glyphId;
+    size_t size;
+    uint32_t lastUse;
+  };
+
+  void TestGlyphCache() {
+    static GlyphCache cache;
+    std::vector<ModelEntry> model;
+    uint32_t useCounter = 0;
+    GlyphCache::Statistics expected {};
+    const void* owners[] = {&model, &expected};
+
+    auto used = [&model]() {
+      size_t total = 0;
+      for (const auto& entry : model) {
+        total += entry.size;
+      }
+      return total;
+    };
+
+    srand(1);
+    for (int i = 0; i < 200000; i++) {
+      const void* owner = owners[rand() % 2];
+      auto glyphId = static_cast<uint16_t>(rand() % 80);
+      int operation = rand() % 100;
+
+      auto found = std::find_if(model.begin(), model.end(), [owner, glyphId](const ModelEntry& entry) {
+        return entry.owner == owner && entry.glyphId == glyphId;
+      });
+      if (operation < 2) {
+        cache.Remove(owner);
+        model.erase(std::remove_if(model.begin(),
+                                   model.end(),
+                                   [owner](const ModelEntry& entry) {
+                                     return entry.owner == owner;
+                                   }),
+                    model.end());
+        continue;
+      }
+      if (operation < 10) {
+        cache.Remove(owner, glyphId);
+        if (found != model.end()) {
+          model.erase(found);
+        }
+        continue;
+      }
+
+      // As FsFont does: look the bitmap up, read it on a miss
+      const uint8_t* bitmap = cache.Find(owner, glyphId);
+      if (found != model.end()) {
+        expected.hits++;
+        found->lastUse = ++useCounter;
+        if (bitmap == nullptr) {
+          Check(false, "glyph cache", "bitmap evicted too early");
+          return;
+        }
+        for (size_t j = 0; j < found->size; j++) {
+          if (bitmap[j] != Pattern(owner, glyphId, j)) {
+            Check(false, "glyph cache", "bitmap corrupted");
+            return;
+          }
+        }
+        continue;
+      }
+      expected.misses++;
+      if (bitmap != nullptr) {
+        Check(false, "glyph cache", "bitmap not evicted");
+        return;
+      }
+
+      // Mostly the size of the glyphs of a 20px font, sometimes a large one
+      size_t size = (rand() % 20 == 0) ? 100 + rand() % 300 : 8 + rand() % 30;
+      while (model.size() == GlyphCache::maxEntries || used() + size > GlyphCache::poolSize) {
+        auto oldest = std::min_element(model.begin(), model.end(), [](const ModelEntry& a, const ModelEntry& b) {
+          return a.lastUse < b.lastUse;
+        });
+        model.erase(oldest);
+        expected.evictions++;
+      }
+      uint8_t* inserted = cache.Insert(owner, glyphId, size);
+      if (inserted == nullptr) {
+        Check(false, "glyph cache", "insertion failed");
+        return;
+      }
+      for (size_t j = 0; j < size; j++) {
+        inserted[j] = Pattern(owner, glyphId, j);
+      }
+      model.push_back({owner, glyphId, size, ++useCounter});
+    }
+
+    const auto& statistics = cache.GetStatistics();
+    Check(statistics.hits == expected.hits, "glyph cache", "hits");
+    Check(statistics.misses == expected.misses, "glyph cache", "misses");
+    Check(statistics.evictions == expected.evictions, "glyph cache", "evictions");
+    Check(cache.Insert(owners[0], 0, GlyphCache::poolSize + 1) == nullptr, "glyph cache", "bitmap larger than the pool");
+    std::printf("glyph cache: %u hits, %u misses, %u evictions\n", statistics.hits, statistics.misses, statistics.evictions);
+  }
+
+  // Writes bit fields, most significant bit first
+  class BitWriter {
+  public:
+    void Write(uint32_t value, uint8_t nbBits) {
+      for (int i = nbBits - 1; i >= 0; i--, position++) {
+        if (position % 8 == 0) {
+          data.push_back(0);
+        }
+        data.back() |= ((value >> i) & 1) << (7 - position % 8);
+      }
+    }
+
+    std::vector<uint8_t> data;
+
+  private:
+    size_t position = 0;
+  };
+
+  struct Glyph {
+    uint32_t letter;
+    uint8_t advanceWidth;
+    int8_t offsetX;
+    int8_t offsetY;
+    uint8_t boxWidth;
+    uint8_t boxHeight;
+    std::vector<uint8_t> bitmap;
+  };
+
+  struct Range {
+    uint32_t first;
+    uint32_t last;
+    lv_font_fmt_txt_cmap_type_t type;
+    // Letters missing from the sparse ranges
+    uint32_t gap;
+  };
+
+  // Character ranges of the notification font (see src/displayapp/fonts/fonts.json), with the 4 kinds of maps. The
+  // lookup of LVGL 7 also matches the letter that follows a range: the ranges are not adjacent.
+  const Range ranges[] = {
+    {0x20, 0x7e, LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY, 0},
+    {0xa0, 0x17f, LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY, 0},
+    {0x370, 0x3fe, LV_FONT_FMT_TXT_CMAP_SPARSE_TINY, 5},
+    {0x400, 0x4ff, LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL, 0},
+    {0x2010, 0x2027, LV_FONT_FMT_TXT_CMAP_SPARSE_FULL, 3},
+  };
+
+  constexpr uint8_t advanceWidthBits = 5;
+  constexpr uint8_t xyBits = 4;
+  constexpr uint8_t whBits = 5;
+
+  template <typename T>
+  void Put(std::vector<uint8_t>& data, size_t position, T value) {
+    if (data.size() < position + sizeof(T)) {
+      data.resize(position + sizeof(T));
+    }
+    std::memcpy(&data[position], &value, sizeof(T));
+  }
+
+  void PutSectionHeader(std::vector<uint8_t>& data, size_t start, const char* label) {
+    Put<uint32_t>(data, start, data.size() - start);
+    std::memcpy(&data[start + 4], label, 4);
+  }
+
+  // A font file in the LVGL binary format, as written by lv_font_conv --format bin --bpp 1 --no-compress, with random
+  // glyphs of the size of those of a 20px font. glyphs[0] is the "missing glyph".
+  std::vector<uint8_t> WriteFont(std::vector<Glyph>& glyphs) {
+    glyphs.push_back({});
+    for (const auto& range : ranges) {
+      for (uint32_t letter = range.first; letter <= range.last; letter++) {
+        if (range.gap != 0 && letter % range.gap == 0) {
+          continue;
+        }
+        Glyph glyph {};
+        glyph.letter = letter;
+        glyph.advanceWidth = 12;
+        glyph.offsetX = rand() % 3 - 1;
+        glyph.offsetY = rand() % 8 - 4;
+        if (letter != ' ') {
+          glyph.boxWidth = 8 + rand() % 4;
+          glyph.boxHeight = 10 + rand() % 7;
+        }
+        BitWriter bits;
+        for (int i = 0; i < glyph.boxWidth * glyph.boxHeight; i++) {
+          bits.Write(rand() & 1, 1);
+        }
+        glyph.bitmap = bits.data;
+        glyphs.push_back(glyph);
+      }
+    }
+
+    std::vector<uint8_t> file(8 + 36);
+    Put<uint16_t>(file, 8 + 6, 20);
+    Put<uint16_t>(file, 8 + 8, 16);
+    Put<int16_t>(file, 8 + 10, -4);
+    Put<uint16_t>(file, 8 + 22, 12);
+    file[8 + 29] = 1;
+    file[8 + 30] = xyBits;
+    file[8 + 31] = whBits;
+    file[8 + 32] = advanceWidthBits;
+    PutSectionHeader(file, 0, "head");
+
+    size_t cmapStart = file.size();
+    constexpr size_t nbRanges = sizeof(ranges) / sizeof(ranges[0]);
+    Put<uint32_t>(file, cmapStart + 8, nbRanges);
+    file.resize(cmapStart + 12 + nbRanges * 16);
+    uint16_t glyphId = 1;
+    for (size_t i = 0; i < nbRanges; i++) {
+      const Range& range = ranges[i];
+      std::vector<uint16_t> letters;
+      for (uint32_t letter = range.first; letter <= range.last; letter++) {
+        if (range.gap == 0 || letter % range.gap != 0) {
+          letters.push_back(letter - range.first);
+        }
+      }
+      size_t record = cmapStart + 12 + i * 16;
+      Put<uint32_t>(file, record, file.size() - cmapStart);
+      Put<uint32_t>(file, record + 4, range.first);
+      Put<uint16_t>(file, record + 8, range.last - range.first + 1);
+      Put<uint16_t>(file, record + 10, glyphId);
+      file[record + 14] = range.type;
+      switch (range.type) {
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY:
+          break;
+        case LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL:
+          Put<uint16_t>(file, record + 12, letters.size());
+          for (size_t j = 0; j < letters.size(); j++) {
+            file.push_back(j);
+          }
+          break;
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_TINY:
+        case LV_FONT_FMT_TXT_CMAP_SPARSE_FULL:
+          Put<uint16_t>(file, record + 12, letters.size());
+          for (auto letter : letters) {
+            Put<uint16_t>(file, file.size(), letter);
+          }
+          if (range.type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL) {
+            for (size_t j = 0; j < letters.size(); j++) {
+              Put<uint16_t>(file, file.size(), j);
+            }
+          }
+          break;
+      }
+      glyphId += letters.size();
+    }
+    while (file.size() % 4 != 0) {
+      file.push_back(0);
+    }
+    PutSectionHeader(file, cmapStart, "cmap");
+
+    // The glyph records are aligned on a byte, their bitmap follows the fields without padding
+    std::vector<uint8_t> glyf(8);
+    std::vector<uint16_t> offsets;
+    for (const auto& glyph : glyphs) {
+      offsets.push_back(glyf.size());
+      if (glyph.letter == 0) {
+        continue;
+      }
+      BitWriter bits;
+      bits.Write(glyph.advanceWidth, advanceWidthBits);
+      bits.Write(glyph.offsetX & ((1 << xyBits) - 1), xyBits);
+      bits.Write(glyph.offsetY & ((1 << xyBits) - 1), xyBits);
+      bits.Write(glyph.boxWidth, whBits);
+      bits.Write(glyph.boxHeight, whBits);
+      for (int i = 0; i < glyph.boxWidth * glyph.boxHeight; i++) {
+        bits.Write((glyph.bitmap[i / 8] >> (7 - i % 8)) & 1, 1);
+      }
+      glyf.insert(glyf.end(), bits.data.begin(), bits.data.end());
+    }
+    PutSectionHeader(glyf, 0, "glyf");
+
+    size_t locaStart = file.size();
+    Put<uint32_t>(file, locaStart + 8, offsets.size());
+    for (auto offset : offsets) {
+      Put<uint16_t>(file, file.size(), offset);
+    }
+    while (file.size() % 4 != 0) {
+      file.push_back(0);
+    }
+    PutSectionHeader(file, locaStart, "loca");
+
+    file.insert(file.end(), glyf.begin(), glyf.end());
+    return file;
+  }
+
+  bool SameBits(const uint8_t* bitmap, const std::vector<uint8_t>& expected, size_t nbBits) {
+    for (size_t i = 0; i < nbBits; i++) {
+      if (((bitmap[i / 8] ^ expected[i / 8]) >> (7 - i % 8)) & 1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void TestGlyphs(const lv_font_t* font, const std::vector<Glyph>& glyphs) {
+    for (size_t i = 1; i < glyphs.size(); i++) {
+      const Glyph& glyph = glyphs[i];
+      lv_font_glyph_dsc_t dsc;
+      if (!font->get_glyph_dsc(font, &dsc, glyph.letter, 0)) {
+        Check(false, "font", "glyph not found");
+        return;
+      }
+      Check(dsc.adv_w == glyph.advanceWidth && dsc.ofs_x == glyph.offsetX && dsc.ofs_y == glyph.offsetY &&
+              dsc.box_w == glyph.boxWidth && dsc.box_h == glyph.boxHeight && dsc.bpp == 1,
+            "font",
+            "glyph descriptor");
+      const uint8_t* bitmap = font->get_glyph_bitmap(font, glyph.letter);
+      if (glyph.bitmap.empty()) {
+        Check(bitmap == nullptr, "font", "empty glyph");
+      } else {
+        Check(bitmap != nullptr && SameBits(bitmap, glyph.bitmap, glyph.boxWidth * glyph.boxHeight), "font", "glyph bitmap");
+      }
+    }
+
+    lv_font_glyph_dsc_t dsc;
+    Check(!font->get_glyph_dsc(font, &dsc, 0x375, 0), "font", "letter missing from a sparse range");
+    Check(!font->get_glyph_dsc(font, &dsc, 0x3000, 0), "font", "letter out of the ranges");
+  }
+
+  uint32_t Decode(const char*& text) {
+    auto byte = static_cast<uint8_t>(*text++);
+    if (byte < 0x80) {
+      return byte;
+    }
+    int length = byte >= 0xf0 ? 3 : (byte >= 0xe0 ? 2 : 1);
+    uint32_t letter = byte & (0x3f >> length);
+    for (int i = 0; i < length; i++) {
+      letter = (letter << 6) | (static_cast<uint8_t>(*text++) & 0x3f);
+    }
+    return letter;
+  }
+
+  // What LVGL asks to the font to draw a label: the descriptors when the text is laid out, then the descriptor and
+  // the bitmap of each letter when it is drawn.
+  void Render(const lv_font_t* font, const char* text) {
+    lv_font_glyph_dsc_t dsc;
+    for (const char* c = text; *c != '\0';) {
+      font->get_glyph_dsc(font, &dsc, Decode(c), 0);
+    }
+    for (const char* c = text; *c != '\0';) {
+      uint32_t letter = Decode(c);
+      if (font->get_glyph_dsc(font, &dsc, letter, 0)) {
+        font->get_glyph_bitmap(font, letter);
+      }
+    }
+  }
+
+  void TestNotification(const lv_font_t* font, const char* name, const char* text) {
+    auto& cache = FsFont::GetGlyphCache();
+    for (int i = 0; i < 2; i++) {
+      HostFs::statistics = {};
+      auto before = cache.GetStatistics();
+      Render(font, text);
+      const auto& after = cache.GetStatistics();
+      std::printf("%s notification, %s cache: %u flash reads (%u bytes), %u glyph misses, %u evictions\n",
+                  name,
+                  i == 0 ? "cold" : "warm",
+                  HostFs::statistics.reads,
+                  HostFs::statistics.bytesRead,
+                  after.misses - before.misses,
+                  after.evictions - before.evictions);
+      if (i == 1) {
+        Check(HostFs::statistics.reads == 0, name, "flash read when the notification is redrawn");
+        Check(after.misses == before.misses, name, "glyph evicted when the notification is redrawn");
+      }
+    }
+  }
+}
+
+int main() {
+  TestGlyphCache();
+
+  srand(2);
+  std::vector<Glyph> glyphs;
+  HostFs::files["/fonts/notifications.bin"] = WriteFont(glyphs);
+
+  Pinetime::Drivers::SpiMaster spi {Pinetime::Drivers::SpiMaster::SpiModule::SPI0, {}};
+  Pinetime::Drivers::Spi flashSpi {spi, 5};
+  Pinetime::Drivers::SpiNorFlash flash {flashSpi};
+  Pinetime::Controllers::FS fs {flash};
+  FsFont notificationFont {fs};
+  if (!notificationFont.Load("/fonts/notifications.bin")) {
+    std::printf("FAIL: font not loaded\n");
+    return 1;
+  }
+  const lv_font_t* font = notificationFont.GetFont();
+  std::printf("%zu glyphs, %zu bytes\n", glyphs.size(), HostFs::files["/fonts/notifications.bin"].size());
+
+  // Twice: the second pass reads the bitmaps evicted by the first one
+  TestGlyphs(font, glyphs);
+  TestGlyphs(font, glyphs);
+
+  FsFont::GetGlyphCache().Clear();
+  TestNotification(font, "latin", "Alice: Are we still on for lunch tomorrow? I booked a table at 12:30, see you there!");
+  FsFont::GetGlyphCache().Clear();
+  TestNotification(font, "greek", "Μαρία: Θα είμαι εκεί στις 8. Φέρε το βιβλίο – ευχαριστώ!");
+
+  notificationFont.Unload();
+  Check(notificationFont.GetFont() == nullptr, "font", "unloaded");
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
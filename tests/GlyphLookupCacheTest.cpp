@@ -0,0 +1,238 @@
+// Host test and benchmark of the glyph lookup cache, on fonts with the character maps of jetbrains_mono_bold_20
+// (see src/displayapp/fonts/fonts.json):
+// - random lookups of letters in and out of the fonts, through the cache and directly with the lookup of LVGL, in
+//   2 fonts whose letters collide in the cache: the descriptors and the glyph ids must be the same.
+// - the removal of a font, whose memory is then reused by another font.
+// - the fonts with kerning, which are not cached.
+// - the number of lookups per second, with and without the cache, for the texts of AppBenchmark, and that the letters
+//   of each text do not evict each other. The ratio on the host is only indicative: the watch runs them on a
+//   Cortex-M4 without data cache.
+#include "displayapp/GlyphLookupCache.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <set>
+#include <vector>
+
+using namespace Pinetime::Components;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  // FontAwesome symbols of jetbrains_mono_bold_20, sorted
+  const uint32_t symbols[] = {0xf001, 0xf015, 0xf017, 0xf024, 0xf027, 0xf028, 0xf03a, 0xf048, 0xf04b, 0xf04c, 0xf04d, 0xf051,
+                              0xf06e, 0xf095, 0xf129, 0xf185, 0xf1e6, 0xf1ec, 0xf1fc, 0xf201, 0xf21e, 0xf242, 0xf252, 0xf294,
+                              0xf2f2, 0xf3dd, 0xf3fd, 0xf45d, 0xf54b, 0xf560, 0xf569, 0xf59f, 0xf5a0, 0xf6a9};
+  constexpr size_t nbSymbols = sizeof(symbols) / sizeof(symbols[0]);
+
+  class TestFont {
+  public:
+    explicit TestFont(uint32_t seed) {
+      symbolOffsets.reserve(nbSymbols);
+      for (auto symbol : symbols) {
+        symbolOffsets.push_back(symbol - symbols[0]);
+      }
+      cmaps[0] = {0x20, 0x7e - 0x20 + 1, 1, nullptr, nullptr, 0, LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY};
+      cmaps[1] = {0x410, 0x44f - 0x410 + 1, 96, nullptr, nullptr, 0, LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY};
+      cmaps[2] = {symbols[0],
+                  static_cast<uint16_t>(symbols[nbSymbols - 1] - symbols[0] + 1),
+                  160,
+                  symbolOffsets.data(),
+                  nullptr,
+                  static_cast<uint16_t>(nbSymbols),
+                  LV_FONT_FMT_TXT_CMAP_SPARSE_TINY};
+
+      glyphs.resize(160 + nbSymbols);
+      for (auto& glyph : glyphs) {
+        seed = seed * 1103515245 + 12345;
+        glyph.adv_w = 16 * (8 + (seed >> 16) % 8) + (seed >> 8) % 16;
+        glyph.box_w = 5 + (seed >> 20) % 12;
+        glyph.box_h = 8 + (seed >> 24) % 12;
+        glyph.ofs_x = static_cast<int8_t>((seed >> 12) % 5) - 2;
+        glyph.ofs_y = static_cast<int8_t>((seed >> 4) % 9) - 4;
+      }
+
+      dsc.glyph_dsc = glyphs.data();
+      dsc.cmaps = cmaps;
+      dsc.cmap_num = 3;
+      dsc.bpp = 1;
+      font.get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt;
+      font.line_height = 24;
+      font.dsc = &dsc;
+    }
+
+    lv_font_t font {};
+    lv_font_fmt_txt_dsc_t dsc {};
+
+  private:
+    lv_font_fmt_txt_cmap_t cmaps[3];
+    std::vector<uint16_t> symbolOffsets;
+    std::vector<lv_font_fmt_txt_glyph_dsc_t> glyphs;
+  };
+
+  uint32_t RandomLetter() {
+    switch (rand() % 4) {
+      case 0:
+        // LVGL draws the tabulations as 2 spaces
+        return rand() % 50 == 0 ? '\t' : 0x20 + rand() % 0x60;
+      case 1:
+        return 0x40c + rand() % 0x48;
+      case 2:
+        return symbols[rand() % nbSymbols] + rand() % 2;
+      default:
+        // Not in the fonts
+        return rand() % 0x10000;
+    }
+  }
+
+  void CheckLookup(TestFont& testFont, uint32_t letter, const char* test) {
+    const lv_font_t& font = testFont.font;
+    lv_font_glyph_dsc_t cached {};
+    bool foundCached = font.get_glyph_dsc(&font, &cached, letter, 0);
+    uint32_t cachedGlyphId = testFont.dsc.last_glyph_id;
+
+    // Resets the 1-entry cache of LVGL
+    testFont.dsc.last_letter = 0;
+    lv_font_glyph_dsc_t expected {};
+    bool found = lv_font_get_glyph_dsc_fmt_txt(&font, &expected, letter, 0);
+
+    Check(foundCached == found, test, "letter found");
+    if (found && foundCached) {
+      Check(cached.adv_w == expected.adv_w && cached.box_w == expected.box_w && cached.box_h == expected.box_h &&
+              cached.ofs_x == expected.ofs_x && cached.ofs_y == expected.ofs_y && cached.bpp == expected.bpp,
+            test,
+            "glyph descriptor");
+      // FsFont reads the bitmap of this glyph next
+      Check(cachedGlyphId == testFont.dsc.last_glyph_id, test, "glyph id");
+    }
+  }
+
+  void TestLookups() {
+    std::optional<TestFont> first {std::in_place, 1};
+    TestFont second {2};
+    GlyphLookupCache::Install(first->font);
+    GlyphLookupCache::Install(second.font);
+    Check(first->font.get_glyph_dsc != lv_font_get_glyph_dsc_fmt_txt, "install", "font without kerning not cached");
+
+    srand(1);
+    for (int i = 0; i < 200000; i++) {
+      CheckLookup(rand() % 2 == 0 ? *first : second, RandomLetter(), "lookups");
+    }
+
+    // A font is unloaded, and another one is loaded at the same address
+    for (uint32_t letter = 0x20; letter < 0x7f; letter++) {
+      CheckLookup(*first, letter, "removal");
+    }
+    GlyphLookupCache::Remove(&first->font);
+    first.emplace(3);
+    GlyphLookupCache::Install(first->font);
+    for (uint32_t letter = 0x20; letter < 0x7f; letter++) {
+      CheckLookup(*first, letter, "removal");
+    }
+    GlyphLookupCache::Remove(&first->font);
+    GlyphLookupCache::Remove(&second.font);
+
+    TestFont kerned {4};
+    uint8_t kerning = 0;
+    kerned.dsc.kern_dsc = &kerning;
+    GlyphLookupCache::Install(kerned.font);
+    Check(kerned.font.get_glyph_dsc == lv_font_get_glyph_dsc_fmt_txt, "install", "font with kerning cached");
+  }
+
+  uint32_t Decode(const char*& text) {
+    auto byte = static_cast<uint8_t>(*text++);
+    if (byte < 0x80) {
+      return byte;
+    }
+    int length = byte >= 0xf0 ? 3 : (byte >= 0xe0 ? 2 : 1);
+    uint32_t letter = byte & (0x3f >> length);
+    for (int i = 0; i < length; i++) {
+      letter = (letter << 6) | (static_cast<uint8_t>(*text++) & 0x3f);
+    }
+    return letter;
+  }
+
+  // Same texts as AppBenchmark
+  struct Text {
+    const char* name;
+    const char* text;
+  };
+
+  constexpr Text texts[] = {
+    {"ascii", "The quick brown fox jumps over the lazy dog 0123456789"},
+    {"cyrillic", "\xD0\xA1\xD1\x8A\xD0\xB5\xD1\x88\xD1\x8C \xD0\xB6\xD0\xB5 \xD1\x8D\xD1\x82\xD0\xB8\xD1\x85 "
+                 "\xD0\xBC\xD1\x8F\xD0\xB3\xD0\xBA\xD0\xB8\xD1\x85 \xD0\xB1\xD1\x83\xD0\xBB\xD0\xBE\xD0\xBA"},
+    {"symbols", "\xEF\x89\x82\xEF\x88\x9E\xEF\x8A\x94\xEF\x87\xA6\xEF\x95\x8B\xEF\x80\x97\xEF\x84\xA9\xEF\x80\xBA"
+                "\xEF\x86\x85\xEF\x95\xA0\xEF\x80\x81\xEF\x8F\xBD"},
+  };
+
+  // Returns the number of glyph descriptors looked up per second
+  double LookupRate(const lv_font_t& font, const std::vector<uint32_t>& letters, bool cached) {
+    constexpr int repeats = 20000;
+    lv_font_glyph_dsc_t dsc;
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; i++) {
+      for (auto letter : letters) {
+        if (cached) {
+          font.get_glyph_dsc(&font, &dsc, letter, 0);
+        } else {
+          lv_font_get_glyph_dsc_fmt_txt(&font, &dsc, letter, 0);
+        }
+        sum += dsc.adv_w;
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    // Keeps the lookups from being optimized out
+    if (sum == 0) {
+      std::printf("no glyph\n");
+    }
+    return repeats * letters.size() / elapsed.count();
+  }
+
+  void Benchmark() {
+    TestFont testFont {5};
+    GlyphLookupCache::Install(testFont.font);
+    for (const auto& text : texts) {
+      std::vector<uint32_t> letters;
+      for (const char* c = text.text; *c != '\0';) {
+        letters.push_back(Decode(c));
+      }
+      GlyphLookupCache::Remove(&testFont.font);
+      auto before = GlyphLookupCache::GetStatistics();
+      double uncached = LookupRate(testFont.font, letters, false);
+      double cached = LookupRate(testFont.font, letters, true);
+      const auto& after = GlyphLookupCache::GetStatistics();
+      std::printf("glyph lookups (%s): %.1fM/s, %.1fM/s with the cache (%u misses)\n",
+                  text.name,
+                  uncached / 1e6,
+                  cached / 1e6,
+                  after.misses - before.misses);
+      // The letters of each text fit in the cache together
+      std::set<uint32_t> distinct(letters.begin(), letters.end());
+      Check(after.misses - before.misses == distinct.size(), text.name, "letters evicted by the other letters of the text");
+    }
+    GlyphLookupCache::Remove(&testFont.font);
+  }
+}
+
+int main() {
+  TestLookups();
+  Benchmark();
+
+  const auto& statistics = GlyphLookupCache::GetStatistics();
+  std::printf("%u hits, %u misses\n", statistics.hits, statistics.misses);
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
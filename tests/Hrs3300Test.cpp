@@ -0,0 +1,155 @@
+// Host test of the sample reads of the Hrs3300 driver, against the emulated TWIM (tests/emulation) and a sensor that
+// changes its HRS and ALS values between the samples: checks that ReadSample() decodes both channels as the former
+// ReadHrs() and ReadAls() did, with their 6 register reads, in a single bus transaction. Reports the bus transactions,
+// the bus time and the latency of a sample with both.
+#include "drivers/Hrs3300.h"
+#include <task.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "emulation/Twim.h"
+
+using namespace Pinetime::Drivers;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  // Same as main.cpp
+  TwiMaster twiMaster {NRF_TWIM1, 0x06200000, 6, 7};
+  constexpr uint8_t sensorAddress = 0x44;
+  Hrs3300 heartRateSensor {twiMaster, sensorAddress};
+
+  void TwimIrqHandler() {
+    twiMaster.OnInterrupt();
+  }
+
+  Emulation::Twim twim {*NRF_TWIM1, TwimIrqHandler};
+  bool completed = false;
+
+  // The 18 bits of HRS and 17 bits of ALS, spread over the data registers as described in the datasheet
+  class Sensor : public Emulation::RegisterDevice {
+  public:
+    void SetSample(uint32_t hrs, uint32_t als) {
+      registers[static_cast<uint8_t>(Hrs3300::Registers::C0DataM)] = (hrs >> 8) & 0xff;
+      registers[static_cast<uint8_t>(Hrs3300::Registers::C0DataH)] = (rand() & 0xf0) | ((hrs >> 4) & 0x0f);
+      registers[static_cast<uint8_t>(Hrs3300::Registers::C0dataL)] = (rand() & 0xc0) | ((hrs >> 12) & 0x30) | (hrs & 0x0f);
+      registers[static_cast<uint8_t>(Hrs3300::Registers::C1dataM)] = (als >> 3) & 0xff;
+      registers[static_cast<uint8_t>(Hrs3300::Registers::C1dataH)] = (rand() & 0xc0) | ((als >> 11) & 0x3f);
+      registers[static_cast<uint8_t>(Hrs3300::Registers::C1dataL)] = (rand() & 0xf8) | (als & 0x07);
+    }
+  };
+
+  Sensor sensor;
+
+  uint8_t ReadRegister(Hrs3300::Registers reg) {
+    uint8_t value = 0;
+    twiMaster.Read(sensorAddress, static_cast<uint8_t>(reg), &value, 1);
+    return value;
+  }
+
+  // Hrs3300::ReadHrs() and Hrs3300::ReadAls() before ReadSample()
+  void BaselineReadSample(uint32_t& hrs, uint32_t& als) {
+    auto m = ReadRegister(Hrs3300::Registers::C0DataM);
+    auto h = ReadRegister(Hrs3300::Registers::C0DataH);
+    auto l = ReadRegister(Hrs3300::Registers::C0dataL);
+    hrs = ((l & 0x30) << 12) | (m << 8) | ((h & 0x0f) << 4) | (l & 0x0f);
+    m = ReadRegister(Hrs3300::Registers::C1dataM);
+    h = ReadRegister(Hrs3300::Registers::C1dataH);
+    l = ReadRegister(Hrs3300::Registers::C1dataL);
+    als = ((h & 0x3f) << 11) | (m << 3) | (l & 0x07);
+  }
+
+  void TestSamples() {
+    const char* test = "samples";
+    constexpr uint32_t nbSamples = 100;
+    uint64_t busCycles = 0;
+    uint64_t baselineBusCycles = 0;
+    uint32_t baselineTransactions = 0;
+    uint32_t baselineLatency = 0;
+    auto before = heartRateSensor.GetStatistics();
+
+    srand(1);
+    for (uint32_t i = 0; i < nbSamples; i++) {
+      uint32_t hrs = rand() % (1 << 18);
+      uint32_t als = rand() % (1 << 17);
+      sensor.SetSample(hrs, als);
+
+      twim.Reset();
+      Hrs3300::Sample sample;
+      TickType_t now = xTaskGetTickCount();
+      Check(heartRateSensor.ReadSample(sample), test, "read failed");
+      Check(sample.hrs == hrs && sample.als == als, test, "wrong sample");
+      Check(sample.timestamp == now, test, "wrong timestamp");
+      Check(twim.transactions.size() == 1, test, "not a single bus transaction per sample");
+      busCycles += twim.BusyCycles();
+
+      twim.Reset();
+      uint32_t baselineHrs;
+      uint32_t baselineAls;
+      uint32_t startCycleCount = DWT->CYCCNT;
+      BaselineReadSample(baselineHrs, baselineAls);
+      baselineLatency += DWT->CYCCNT - startCycleCount;
+      Check(baselineHrs == sample.hrs && baselineAls == sample.als, test, "not the same sample as ReadHrs() and ReadAls()");
+      baselineTransactions += twim.transactions.size();
+      baselineBusCycles += twim.BusyCycles();
+
+      vTaskDelay(pdMS_TO_TICKS(40));
+    }
+
+    const auto& after = heartRateSensor.GetStatistics();
+    uint32_t samples = after.samples - before.samples;
+    uint32_t transactions = after.transactions - before.transactions;
+    uint32_t latency = (after.totalLatency - before.totalLatency) / samples;
+    Check(samples == nbSamples, test, "samples not counted");
+    Check(transactions == nbSamples, test, "transactions not counted");
+    Check(baselineTransactions == 6 * nbSamples, test, "the baseline does not read the registers one by one");
+    Check(latency < baselineLatency / nbSamples, test, "the latency is not lower than with the baseline");
+    std::printf("%s: %.1f transactions, %lu bus cycles, latency %u cycles (max %u) per sample, "
+                "baseline: %.1f transactions, %lu bus cycles, latency %u cycles\n",
+                test,
+                static_cast<double>(transactions) / samples,
+                static_cast<unsigned long>(busCycles / nbSamples),
+                latency,
+                after.maxLatency,
+                static_cast<double>(baselineTransactions) / nbSamples,
+                static_cast<unsigned long>(baselineBusCycles / nbSamples),
+                baselineLatency / nbSamples);
+  }
+
+  // The sensor does not answer: the sample is not counted
+  void TestFailure() {
+    const char* test = "failure";
+    Hrs3300 absentSensor {twiMaster, 0x45};
+    Hrs3300::Sample sample;
+    Check(!absentSensor.ReadSample(sample), test, "read did not fail");
+    Check(absentSensor.GetStatistics().samples == 0, test, "sample counted");
+    Check(absentSensor.GetStatistics().transactions == 1, test, "transaction not counted");
+  }
+
+  void RunTests(void* /*parameters*/) {
+    twiMaster.Init();
+    TestSamples();
+    TestFailure();
+    completed = true;
+    vTaskDelete(nullptr);
+  }
+}
+
+int main() {
+  twim.Connect(sensorAddress, sensor);
+  xTaskCreate(RunTests, "tests", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+  vTaskStartScheduler();
+  Check(completed, "tests", "the test task is blocked forever");
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
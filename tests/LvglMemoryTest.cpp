@@ -0,0 +1,97 @@
+// Host test of the TLSF allocator of LVGL: random allocations and releases of LVGL-like objects, checking that the
+// blocks are aligned, do not overlap and are not corrupted, and that the memory is entirely free again at the end.
+#include "displayapp/LvglMemory.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Pinetime::Components;
+
+namespace {
+  struct Allocation {
+    uint8_t* data;
+    size_t size;
+    uint8_t pattern;
+  };
+
+  bool Overlaps(const std::vector<Allocation>& allocations, const uint8_t* data, size_t size) {
+    for (const auto& allocation : allocations) {
+      if (data < allocation.data + allocation.size && allocation.data < data + size) {
+        return true;
+      }
+    }
+    return false;
+  }
+}
+
+int main() {
+  constexpr int nbOperations = 500000;
+  // Around 10KB are used, as with a screen with many objects
+  constexpr size_t targetUsed = 9000;
+
+  srand(1);
+  std::vector<Allocation> allocations;
+  size_t allocated = 0;
+  uint32_t failedAllocations = 0;
+  uint32_t nbAllocations = 0;
+
+  for (int i = 0; i < nbOperations; i++) {
+    bool allocate = allocations.empty() || (rand() % 100) < (allocated < targetUsed ? 60 : 40);
+    if (allocate) {
+      // Mostly small objects (styles, labels), sometimes a larger one (tables, text buffers)
+      size_t size = (rand() % 10 == 0) ? 100 + rand() % 1500 : 1 + rand() % 120;
+      auto* data = static_cast<uint8_t*>(LvglMemory::Allocate(size));
+      nbAllocations++;
+      if (data == nullptr) {
+        failedAllocations++;
+        continue;
+      }
+      if ((reinterpret_cast<uintptr_t>(data) & 3) != 0) {
+        std::printf("FAIL: block not aligned on 4 bytes\n");
+        return 1;
+      }
+      if (Overlaps(allocations, data, size)) {
+        std::printf("FAIL: blocks overlap\n");
+        return 1;
+      }
+      auto pattern = static_cast<uint8_t>(rand());
+      std::memset(data, pattern, size);
+      allocations.push_back({data, size, pattern});
+      allocated += size;
+    } else {
+      size_t index = rand() % allocations.size();
+      auto allocation = allocations[index];
+      for (size_t j = 0; j < allocation.size; j++) {
+        if (allocation.data[j] != allocation.pattern) {
+          std::printf("FAIL: block corrupted\n");
+          return 1;
+        }
+      }
+      LvglMemory::Free(allocation.data);
+      allocations[index] = allocations.back();
+      allocations.pop_back();
+      allocated -= allocation.size;
+    }
+  }
+
+  auto statistics = LvglMemory::GetStatistics();
+  std::printf("%u allocations, %u failed, max used %u/%u bytes\n", nbAllocations, failedAllocations, statistics.maxUsed, statistics.total);
+
+  for (const auto& allocation : allocations) {
+    LvglMemory::Free(allocation.data);
+  }
+  statistics = LvglMemory::GetStatistics();
+  std::printf("After releasing everything: %u bytes used, %u free, largest free block %u, fragmentation %u%%\n",
+              statistics.used,
+              statistics.free,
+              statistics.largestFree,
+              statistics.fragmentation);
+
+  // All the free blocks must have been merged back
+  bool ok = statistics.used == 0 && statistics.fragmentation == 0 && statistics.largestFree == statistics.free &&
+            failedAllocations == statistics.failures;
+  std::printf(ok ? "OK\n" : "FAIL\n");
+  return ok ? 0 : 1;
+}
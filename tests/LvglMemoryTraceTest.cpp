@@ -0,0 +1,299 @@
+// Host benchmark of the LVGL memory: replays the allocations of opening every app 1000 times, with the TLSF allocator
+// (LvglMemory) and with a model of the first fit allocator of LVGL 7 (lv_mem.c with LV_MEM_AUTO_DEFRAG), in pools of
+// LV_MEM_SIZE bytes. The watch face stays in memory the whole time, as it does in the screen cache.
+//
+// The trace of an app is generated from its number of objects and its largest buffers (button matrix maps, chart
+// points, text buffers), the same for every opening: the objects and their styles and texts are allocated when the app
+// is created, its labels are updated while it is open, and everything is released in the reverse order when it is
+// closed, as lv_obj_clean() does. Meanwhile, the watch face updates its labels and a notification is replaced from time
+// to time: these blocks outlive the app and land in the middle of its memory, which is what fragments the pool.
+//
+// Checks that no allocation of the TLSF allocator fails, and that the pool is entirely free again at the end. Reports
+// the failed allocations, the maximum memory used and the worst fragmentation of both allocators.
+#include "displayapp/LvglMemory.h"
+#include <lvgl/lvgl.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Pinetime::Components;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  constexpr uint32_t poolSize = LV_MEM_SIZE & ~3U;
+
+  // lv_mem.c of LVGL 7: a list of blocks with a 4 bytes header, the first free block large enough is split. A released
+  // block is merged with the free blocks that follow it.
+  class FirstFit {
+  public:
+    FirstFit() {
+      SetHeader(0, false, poolSize - headerSize);
+    }
+
+    void* Allocate(size_t size) {
+      uint32_t dataSize = (size + 3) & ~3U;
+      for (uint32_t block = 0; block < poolSize; block = Next(block)) {
+        if (IsUsed(block) || Size(block) < dataSize) {
+          continue;
+        }
+        if (Size(block) - dataSize > headerSize) {
+          SetHeader(block + headerSize + dataSize, false, Size(block) - dataSize - headerSize);
+          SetHeader(block, true, dataSize);
+        } else {
+          SetHeader(block, true, Size(block));
+        }
+        used += Size(block);
+        maxUsed = std::max(maxUsed, used);
+        return pool + block + headerSize;
+      }
+      nbFailures++;
+      return nullptr;
+    }
+
+    void Free(void* data) {
+      uint32_t block = static_cast<uint8_t*>(data) - pool - headerSize;
+      used -= Size(block);
+      uint32_t size = Size(block);
+      for (uint32_t next = Next(block); next < poolSize && !IsUsed(next); next = Next(next)) {
+        size += headerSize + Size(next);
+      }
+      SetHeader(block, false, size);
+    }
+
+    uint32_t LargestFree() const {
+      uint32_t largest = 0;
+      for (uint32_t block = 0; block < poolSize; block = Next(block)) {
+        if (!IsUsed(block)) {
+          largest = std::max(largest, Size(block));
+        }
+      }
+      return largest;
+    }
+
+    uint32_t Free() const {
+      uint32_t free = 0;
+      for (uint32_t block = 0; block < poolSize; block = Next(block)) {
+        free += IsUsed(block) ? 0 : Size(block);
+      }
+      return free;
+    }
+
+    uint32_t used = 0;
+    uint32_t maxUsed = 0;
+    uint32_t nbFailures = 0;
+
+  private:
+    static constexpr uint32_t headerSize = 4;
+
+    void SetHeader(uint32_t block, bool isUsed, uint32_t size) {
+      headers[block / 4] = (size << 1) | (isUsed ? 1 : 0);
+    }
+
+    bool IsUsed(uint32_t block) const {
+      return (headers[block / 4] & 1) != 0;
+    }
+
+    uint32_t Size(uint32_t block) const {
+      return headers[block / 4] >> 1;
+    }
+
+    uint32_t Next(uint32_t block) const {
+      return block + headerSize + Size(block);
+    }
+
+    // The headers are kept beside the pool, which is only used for its addresses
+    uint8_t pool[poolSize];
+    uint32_t headers[poolSize / 4];
+  };
+
+  // LvglMemory, through lv_mem_alloc(): LVGL prepends the size of the block with a custom allocator
+  class Tlsf {
+  public:
+    void* Allocate(size_t size) {
+      void* data = LvglMemory::Allocate(size + 4);
+      nbFailures += data == nullptr ? 1 : 0;
+      return data;
+    }
+
+    void Free(void* data) {
+      LvglMemory::Free(data);
+    }
+
+    uint32_t LargestFree() const {
+      return LvglMemory::GetStatistics().largestFree;
+    }
+
+    uint32_t Free() const {
+      return LvglMemory::GetStatistics().free;
+    }
+
+    uint32_t nbFailures = 0;
+  };
+
+  struct App {
+    const char* name;
+    uint16_t nbObjects;
+    // Largest buffers of the app
+    uint16_t largestSize;
+    uint8_t nbLargest;
+    // Label updates while the app is open
+    uint16_t nbUpdates;
+  };
+
+  constexpr App apps[] = {
+    {"launcher", 12, 300, 2, 4},     {"twos", 22, 520, 2, 60},       {"settings", 40, 220, 2, 6},
+    {"sysinfo", 28, 640, 1, 30},     {"music", 30, 160, 1, 40},      {"paint", 4, 0, 0, 0},
+    {"stopwatch", 24, 180, 1, 120},  {"notifications", 26, 420, 2, 8}, {"heartrate", 14, 0, 0, 40},
+    {"metronome", 18, 240, 1, 30},   {"steps", 16, 960, 1, 10},     {"timer", 20, 200, 1, 60},
+    {"alarm", 26, 200, 1, 10},       {"weather", 22, 480, 1, 4},    {"calculator", 28, 560, 1, 40},
+  };
+
+  struct Block {
+    void* data;
+    uint16_t size;
+  };
+
+  uint16_t ObjectSize(uint32_t& seed) {
+    seed = seed * 1103515245 + 12345;
+    // lv_obj_t and the extended data of the object type
+    return 60 + (seed >> 16) % 64;
+  }
+
+  template <class Allocator> struct Replay {
+    Allocator& allocator;
+    uint32_t worstFragmentation = 0;
+    uint32_t minLargestFree = poolSize;
+
+    // The blocks that failed to allocate are kept as nullptr, so that the texts keep their index
+    void Allocate(std::vector<Block>& blocks, uint16_t size) {
+      blocks.push_back({allocator.Allocate(size), size});
+    }
+
+    void Free(const Block& block) {
+      if (block.data != nullptr) {
+        allocator.Free(block.data);
+      }
+    }
+
+    // Frees a block of blocks and allocates a new one of size, as lv_label_set_text() does
+    void Update(std::vector<Block>& blocks, size_t index, uint16_t size) {
+      if (index < blocks.size()) {
+        Free(blocks[index]);
+        blocks.erase(blocks.begin() + index);
+      }
+      Allocate(blocks, size);
+    }
+
+    void Run(int nbOpenings) {
+      srand(1);
+      // The watch face, its labels, and a notification
+      std::vector<Block> resident;
+      uint32_t watchFaceSeed = 1;
+      for (int i = 0; i < 30; i++) {
+        Allocate(resident, ObjectSize(watchFaceSeed));
+      }
+      std::vector<Block> labels;
+      for (int i = 0; i < 6; i++) {
+        Allocate(labels, 12 + rand() % 12);
+      }
+      std::vector<Block> notification;
+
+      for (int opening = 0; opening < nbOpenings; opening++) {
+        for (size_t appIndex = 0; appIndex < sizeof(apps) / sizeof(apps[0]); appIndex++) {
+          const App& app = apps[appIndex];
+          std::vector<Block> blocks;
+          std::vector<size_t> texts;
+          uint32_t seed = appIndex + 1;
+          for (uint16_t i = 0; i < app.nbObjects; i++) {
+            Allocate(blocks, ObjectSize(seed));
+            // Style list
+            Allocate(blocks, 16);
+            if (i % 2 == 0) {
+              texts.push_back(blocks.size());
+              Allocate(blocks, 8 + i % 5 * 8);
+            }
+          }
+          for (uint8_t i = 0; i < app.nbLargest; i++) {
+            Allocate(blocks, app.largestSize);
+          }
+
+          for (uint16_t i = 0; i < app.nbUpdates; i++) {
+            if (!texts.empty()) {
+              size_t text = texts[rand() % texts.size()];
+              // The texts keep their place in the list, only their block changes
+              Free(blocks[text]);
+              blocks[text].data = allocator.Allocate(8 + rand() % 32);
+            }
+            if (i % 4 == 0) {
+              Update(labels, rand() % labels.size(), 12 + rand() % 12);
+            }
+          }
+          if ((opening * 15 + appIndex) % 50 == 0) {
+            Update(notification, 0, 100 + rand() % 200);
+          }
+
+          for (auto block = blocks.rbegin(); block != blocks.rend(); ++block) {
+            Free(*block);
+          }
+
+          uint32_t free = allocator.Free();
+          uint32_t largestFree = allocator.LargestFree();
+          minLargestFree = std::min(minLargestFree, largestFree);
+          worstFragmentation = std::max(worstFragmentation, free > 0 ? 100 - largestFree * 100 / free : 0);
+        }
+      }
+
+      for (auto* list : {&resident, &labels, &notification}) {
+        for (const auto& block : *list) {
+          Free(block);
+        }
+      }
+    }
+  };
+}
+
+int main() {
+  constexpr int nbOpenings = 1000;
+
+  FirstFit firstFit;
+  Replay<FirstFit> firstFitReplay {firstFit};
+  firstFitReplay.Run(nbOpenings);
+  std::printf("first fit: %u failed allocations, max used %u/%u bytes, between the apps: largest free block %u bytes at "
+              "least, fragmentation %u%% at most\n",
+              firstFit.nbFailures,
+              firstFit.maxUsed,
+              poolSize,
+              firstFitReplay.minLargestFree,
+              firstFitReplay.worstFragmentation);
+
+  Tlsf tlsf;
+  Replay<Tlsf> tlsfReplay {tlsf};
+  tlsfReplay.Run(nbOpenings);
+  auto statistics = LvglMemory::GetStatistics();
+  std::printf("TLSF: %u failed allocations, max used %u/%u bytes, between the apps: largest free block %u bytes at least, "
+              "fragmentation %u%% at most\n",
+              tlsf.nbFailures,
+              statistics.maxUsed,
+              statistics.total,
+              tlsfReplay.minLargestFree,
+              tlsfReplay.worstFragmentation);
+
+  Check(tlsf.nbFailures == 0 && statistics.failures == 0, "tlsf", "allocation failed");
+  Check(statistics.used == 0 && statistics.largestFree == statistics.free, "tlsf", "pool not entirely free at the end");
+  // The free blocks of the first fit allocator are only merged with the ones after them: they stay split
+  Check(firstFit.used == 0, "first fit", "memory used at the end");
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+// Host test of the streaming heart rate estimator: for each sample, Ppg::HeartRate() must give the same result as the
+// original algorithm (wasp-os), which computes the differences of all the lags again on the last 200 samples.
+// Then replays the same signals sampled as HeartRateTask used to (the 40 ticks timeout of its queue, delayed by the
+// handling of the sample and cut short by the messages, and the BPM computed for 24Hz) and as it does now (on the
+// COMPARE events of RTC2, timestamped with the tick count): the BPM error must be lower with the RTC.
+#include "components/heartrate/Ppg.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+using namespace Pinetime::Controllers;
+
+namespace {
+  // Original implementation, with the sample rate of 24Hz it assumes
+  int Compare(const int8_t* d1, const int8_t* d2, size_t count) {
+    int e = 0;
+    for (size_t i = 0; i < count; i++) {
+      auto d = d1[i] - d2[i];
+      e += d * d;
+    }
+    return e;
+  }
+
+  int CompareShift(const int8_t* d, int shift, size_t count) {
+    return Compare(d + shift, d, count - shift);
+  }
+
+  int Trough(const int8_t* d, size_t size, int mn, int mx) {
+    if (mx > static_cast<int>(size) - 1)
+      return -1;
+    auto z2 = CompareShift(d, mn - 2, size);
+    auto z1 = CompareShift(d, mn - 1, size);
+    for (int i = mn; i < mx + 1; i++) {
+      auto z = CompareShift(d, i, size);
+      if (z2 > z1 && z1 < z)
+        return i;
+      z2 = z1;
+      z1 = z;
+    }
+    return -1;
+  }
+
+  float ReferenceHeartRate(const int8_t* data, size_t size) {
+    auto t0 = Trough(data, size, 7, 48);
+    if (t0 < 0)
+      return 0;
+
+    float t1 = t0 * 2;
+    t1 = Trough(data, size, t1 - 5, t1 + 5);
+    if (t1 < 0)
+      return 0;
+
+    float t2 = static_cast<int>(t1 * 3) / 2;
+    t2 = Trough(data, size, t2 - 5, t2 + 5);
+    if (t2 < 0)
+      return 0;
+
+    float t3 = static_cast<int>(t2 * 4) / 3;
+    t3 = Trough(data, size, t3 - 4, t3 + 4);
+    if (t3 < 0)
+      return static_cast<int>(60 * 24 * 3) / static_cast<int>(t2);
+
+    return static_cast<int>(60 * 24 * 4) / static_cast<int>(t3);
+  }
+
+  uint32_t Signal(int bpm, double t) {
+    return static_cast<uint32_t>(30500 + 300 * std::sin(2 * M_PI * bpm / 60 * t) + 90 * std::sin(2 * M_PI * 2 * bpm / 60 * t) +
+                                 (rand() % 61 - 30));
+  }
+
+  constexpr uint32_t tickRate = 1024;
+
+  // Time of the next sample of HeartRateTask before the RTC: the 40 ticks timeout of xQueueReceive() starts once the
+  // sample is read and processed (0.5 to 3ms), and a message (5% of the samples) makes it return before the timeout
+  double NextQueueTimeoutSample(double t) {
+    double period = 40.0 / tickRate + (0.5 + (rand() % 251) / 100.0) / 1000;
+    if (rand() % 20 == 0) {
+      period *= (rand() % 100) / 100.0;
+    }
+    return t + period;
+  }
+
+  // Mean absolute error of the estimates, once the window is full
+  struct TimingResult {
+    double meanError;
+    int nbEstimates;
+  };
+
+  TimingResult ReplayTiming(int bpm, bool rtc) {
+    constexpr double duration = 120;
+    constexpr uint32_t rtcFrequency = 32768;
+    constexpr uint32_t rtcPeriod = rtcFrequency / 24;
+    // Before, the lags were converted with the 24Hz the filters are designed for: the timestamps count the samples
+    Ppg ppg {rtc ? tickRate : 24};
+    ppg.SetOffset(30000);
+    double errors = 0;
+    int nbEstimates = 0;
+    double t = 0;
+    for (uint32_t i = 0; t < duration; i++) {
+      // The sample is read within 0.3ms of the RTC event, the tick count is read just before
+      t = rtc ? static_cast<double>(i) * rtcPeriod / rtcFrequency + (rand() % 30) / 100000.0 : NextQueueTimeoutSample(t);
+      uint32_t timestamp = rtc ? static_cast<uint32_t>(t * tickRate) : i;
+      ppg.Preprocess(Signal(bpm, t), timestamp);
+      float heartRate = ppg.HeartRate();
+      if (heartRate != 0) {
+        errors += std::abs(heartRate - bpm);
+        nbEstimates++;
+      }
+    }
+    return {nbEstimates > 0 ? errors / nbEstimates : 0, nbEstimates};
+  }
+
+  int TestSampleTiming() {
+    int failures = 0;
+    double queueErrors = 0;
+    double rtcErrors = 0;
+    int nbRates = 0;
+    for (int bpm = 50; bpm <= 140; bpm += 15) {
+      srand(bpm);
+      auto queue = ReplayTiming(bpm, false);
+      auto rtc = ReplayTiming(bpm, true);
+      bool ok = rtc.nbEstimates > 0 && rtc.meanError <= queue.meanError;
+      std::printf("%s %d BPM: mean error %.1f BPM with the queue timeout (%d estimates), %.1f BPM with the RTC (%d estimates)\n",
+                  ok ? "OK  " : "FAIL",
+                  bpm,
+                  queue.meanError,
+                  queue.nbEstimates,
+                  rtc.meanError,
+                  rtc.nbEstimates);
+      failures += ok ? 0 : 1;
+      queueErrors += queue.meanError;
+      rtcErrors += rtc.meanError;
+      nbRates++;
+    }
+    bool ok = rtcErrors < queueErrors / 2;
+    std::printf("%s mean error: %.1f BPM with the queue timeout, %.1f BPM with the RTC\n",
+                ok ? "OK  " : "FAIL",
+                queueErrors / nbRates,
+                rtcErrors / nbRates);
+    return failures + (ok ? 0 : 1);
+  }
+}
+
+int main() {
+  constexpr size_t windowSize = 200;
+  constexpr int nbSamples = 3000;
+  int failures = 0;
+
+  for (int seed = 1; seed <= 6; seed++) {
+    srand(seed);
+    // The timestamps are counted at the sample rate: 24Hz, as assumed by the original algorithm
+    Ppg ppg {24};
+    ppg.SetOffset(30000);
+    std::deque<int8_t> window;
+    int bpm = 45 + 15 * seed;
+    int nbEstimates = 0;
+    int nbMismatches = 0;
+    float heartRate = 0;
+
+    for (int i = 0; i < nbSamples; i++) {
+      double t = i / 24.0;
+      auto raw = static_cast<uint32_t>(30500 + 300 * std::sin(2 * M_PI * bpm / 60 * t) + 90 * std::sin(2 * M_PI * 2 * bpm / 60 * t) +
+                                       (rand() % 61 - 30));
+      window.push_back(ppg.Preprocess(raw, i));
+      if (window.size() > windowSize) {
+        window.pop_front();
+      }
+
+      heartRate = ppg.HeartRate();
+      if (window.size() == windowSize) {
+        std::vector<int8_t> data(window.begin(), window.end());
+        nbEstimates++;
+        nbMismatches += (heartRate != ReferenceHeartRate(data.data(), data.size())) ? 1 : 0;
+      } else if (heartRate != 0) {
+        nbMismatches++;
+      }
+    }
+
+    // The estimate is only as precise as the lag (1/24s) allows
+    bool ok = nbMismatches == 0 && std::abs(heartRate - bpm) <= bpm / 10;
+    std::printf("%s %d BPM: estimated %.0f BPM, %d estimates, %d different from the original algorithm\n",
+                ok ? "OK  " : "FAIL",
+                bpm,
+                heartRate,
+                nbEstimates,
+                nbMismatches);
+    failures += ok ? 0 : 1;
+  }
+
+  failures += TestSampleTiming();
+  return failures == 0 ? 0 : 1;
+}
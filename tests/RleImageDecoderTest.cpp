@@ -0,0 +1,223 @@
+// Host test and benchmark of the RLE image decoder: the images are decoded line by line, as LVGL does, and compared
+// with a reference decoding of the whole image. The decoding throughput is compared with a copy of the same image in
+// true colour, which is what LVGL does for the images stored in true colour.
+#include "displayapp/RleImageDecoder.h"
+#include "displayapp/icons/music/disc.c"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace Pinetime::Components;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  // Same as encode() in tools/rle_encode.py, pixels are 0 (black) or 1 (white)
+  std::vector<uint8_t> Encode1Bit(const std::vector<uint8_t>& pixels) {
+    std::vector<uint8_t> rle;
+    auto emit = [&rle](uint32_t runLength) {
+      while (runLength > 255) {
+        rle.push_back(255);
+        rle.push_back(0);
+        runLength -= 255;
+      }
+      rle.push_back(runLength);
+    };
+    uint8_t color = 0;
+    uint32_t runLength = 0;
+    for (auto pixel : pixels) {
+      if (pixel == color) {
+        runLength++;
+        continue;
+      }
+      emit(runLength);
+      color = pixel;
+      runLength = 1;
+    }
+    emit(runLength);
+    return rle;
+  }
+
+  lv_color_t Clut8(uint8_t index) {
+    // clut8_rgb888() in tools/rle_encode.py
+    uint32_t rgb888;
+    if (index < 216) {
+      rgb888 = (index % 6) * 0x33 + ((index / 6) % 6) * 0x3300 + (index / 36) * 0x330000;
+    } else if (index < 252) {
+      index -= 216;
+      rgb888 = 0x7f + (index % 3) * 0x33 + 0x4c00 + ((index / 3) % 4) * 0x3300 + 0x7f0000 + (index / 12) * 0x330000;
+    } else {
+      rgb888 = 0x2c2c2c + 0x101010 * (index - 252);
+    }
+    return LV_COLOR_MAKE((rgb888 >> 16) & 0xff, (rgb888 >> 8) & 0xff, rgb888 & 0xff);
+  }
+
+  // Whole image decoding of the 2-bit format, as the wasp-os decoder does
+  std::vector<uint16_t> Reference2Bit(const lv_img_dsc_t& image) {
+    std::vector<uint16_t> pixels;
+    uint8_t palette[4] = {0, 254, 219, 215};
+    const uint8_t* data = image.data;
+    size_t i = 3;
+    while (i < image.data_size) {
+      uint8_t code = data[i++];
+      uint32_t runLength = code & 0x3f;
+      if (runLength == 0) {
+        palette[code >> 6] = data[i++];
+        continue;
+      }
+      if (runLength == 0x3f) {
+        uint8_t extension;
+        do {
+          extension = data[i++];
+          runLength += extension;
+        } while (extension == 255);
+      }
+      pixels.insert(pixels.end(), runLength, Clut8(palette[code >> 6]).full);
+    }
+    return pixels;
+  }
+
+  std::vector<uint16_t> Reference1Bit(const std::vector<uint8_t>& pixels) {
+    std::vector<uint16_t> colors;
+    for (auto pixel : pixels) {
+      colors.push_back(pixel != 0 ? LV_COLOR_WHITE.full : LV_COLOR_BLACK.full);
+    }
+    return colors;
+  }
+
+  // Reads all the lines from top to bottom, and some parts of lines in random order
+  void TestImage(const char* test, const lv_img_dsc_t& image, const std::vector<uint16_t>& expected) {
+    uint16_t width = image.header.w;
+    uint16_t height = image.header.h;
+    Check(expected.size() == static_cast<size_t>(width) * height, test, "wrong reference size");
+
+    RleImageDecoder::Cursor cursor;
+    Check(RleImageDecoder::Reset(cursor, image), test, "Reset() failed");
+    // +1: unaligned lines
+    std::vector<lv_color_t> line(width + 1);
+    bool ok = true;
+    for (uint16_t y = 0; y < height; y++) {
+      lv_color_t* buffer = line.data() + (y & 1);
+      ok = ok && RleImageDecoder::ReadLine(cursor, 0, y, width, buffer);
+      ok = ok && std::memcmp(buffer, &expected[y * width], width * sizeof(lv_color_t)) == 0;
+    }
+    Check(ok, test, "wrong lines");
+    Check(!RleImageDecoder::ReadLine(cursor, 0, height, width, line.data()), test, "read after the end of the image");
+
+    ok = true;
+    srand(height);
+    for (int i = 0; i < 100; i++) {
+      auto y = static_cast<uint16_t>(rand() % height);
+      auto x = static_cast<uint16_t>(rand() % width);
+      auto len = static_cast<uint16_t>(1 + rand() % (width - x));
+      // As decoder_read_line(): the decoder is reset when a previous line is read
+      if (y < cursor.row) {
+        RleImageDecoder::Reset(cursor, image);
+      }
+      ok = ok && RleImageDecoder::ReadLine(cursor, x, y, len, line.data());
+      ok = ok && std::memcmp(line.data(), &expected[y * width + x], len * sizeof(lv_color_t)) == 0;
+    }
+    Check(ok, test, "wrong parts of lines");
+  }
+
+  // Decodes the image as LVGL does when it is drawn, and returns the throughput in MB/s of decoded pixels
+  double Benchmark(const lv_img_dsc_t& image, int nbRepeats) {
+    uint16_t width = image.header.w;
+    std::vector<lv_color_t> line(width);
+    RleImageDecoder::Cursor cursor;
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nbRepeats; i++) {
+      RleImageDecoder::Reset(cursor, image);
+      for (uint16_t y = 0; y < image.header.h; y++) {
+        RleImageDecoder::ReadLine(cursor, 0, y, width, line.data());
+        checksum += line[y % width].full;
+      }
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    double bytes = static_cast<double>(nbRepeats) * width * image.header.h * sizeof(lv_color_t);
+    return checksum == 1 ? 0 : bytes / duration.count() / 1e6;
+  }
+
+  double BenchmarkTrueColor(const std::vector<uint16_t>& pixels, uint16_t width, int nbRepeats) {
+    std::vector<lv_color_t> line(width);
+    uint32_t checksum = 0;
+    size_t height = pixels.size() / width;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nbRepeats; i++) {
+      for (size_t y = 0; y < height; y++) {
+        std::memcpy(line.data(), &pixels[y * width], width * sizeof(lv_color_t));
+        checksum += line[y % width].full;
+      }
+    }
+    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+    double bytes = static_cast<double>(nbRepeats) * pixels.size() * sizeof(lv_color_t);
+    return checksum == 1 ? 0 : bytes / duration.count() / 1e6;
+  }
+}
+
+int main() {
+  // 1-bit: a 240x240 splash screen like image, with runs longer than 255 pixels
+  constexpr uint16_t width = 240;
+  constexpr uint16_t height = 240;
+  std::vector<uint8_t> pixels(width * height);
+  for (uint16_t y = 0; y < height; y++) {
+    for (uint16_t x = 0; x < width; x++) {
+      int dx = x - 120;
+      int dy = y - 120;
+      bool ring = dx * dx + dy * dy < 100 * 100 && dx * dx + dy * dy > 80 * 80;
+      bool bar = y > 100 && y < 140 && x > 60 && x < 180 && (x / 8) % 2 == 0;
+      pixels[y * width + x] = (ring || bar) ? 1 : 0;
+    }
+  }
+  auto rle = Encode1Bit(pixels);
+  lv_img_dsc_t splash {};
+  splash.header.cf = RleImageDecoder::Rle1Bit;
+  splash.header.w = width;
+  splash.header.h = height;
+  splash.data_size = rle.size();
+  splash.data = rle.data();
+  TestImage("1-bit 240x240", splash, Reference1Bit(pixels));
+
+  // 2-bit: icon of the music app
+  auto discPixels = Reference2Bit(disc_img);
+  TestImage("2-bit disc icon", disc_img, discPixels);
+
+  // Truncated image
+  lv_img_dsc_t truncated = splash;
+  truncated.data_size = rle.size() / 2;
+  RleImageDecoder::Cursor cursor;
+  RleImageDecoder::Reset(cursor, truncated);
+  std::vector<lv_color_t> line(width);
+  bool ok = true;
+  for (uint16_t y = 0; y < height && ok; y++) {
+    ok = RleImageDecoder::ReadLine(cursor, 0, y, width, line.data());
+  }
+  Check(!ok, "truncated image", "no error at the end of the data");
+
+  std::printf("1-bit 240x240: %u bytes (%u in true colour), decoded at %.0f MB/s, true colour copied at %.0f MB/s\n",
+              splash.data_size,
+              width * height * 2,
+              Benchmark(splash, 2000),
+              BenchmarkTrueColor(Reference1Bit(pixels), width, 2000));
+  std::printf("2-bit disc icon 64x64: %u bytes (%u in true colour), decoded at %.0f MB/s, true colour copied at %.0f MB/s\n",
+              disc_img.data_size,
+              64 * 64 * 2,
+              Benchmark(disc_img, 20000),
+              BenchmarkTrueColor(discPixels, 64, 20000));
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+// Host test of the screen cache, with screens that create their objects on the active LVGL screen and allocate their
+// memory in the LVGL memory, like the screens of the apps:
+// - a scripted sequence of app switches, loaded the same way as DisplayApp::LoadApp(): the watch face and the launcher
+//   are restored instead of being created again, the other apps are always created and destroyed.
+// - a watch face changed in the settings while it is retained: it is destroyed and created again.
+// - a larger watch face, which does not fit in the budget with the launcher: the screen retained first is destroyed.
+// - 20000 random app switches, checking after each one that the retained memory fits in the budget, that the active
+//   LVGL screen only holds the objects of the current screen, and that no screen and no LVGL object leaks.
+// The screens are destroyed on their own LVGL screen. Reports the number of screens created with and without the
+// cache; the time it takes to create them on the watch is not measured here.
+#include "displayapp/ScreenCache.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "displayapp/LvglMemory.h"
+#include "HostLvgl.h"
+
+using namespace Pinetime::Applications;
+using Pinetime::Components::LvglMemory;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  // Watch face selected in the settings
+  uint8_t clockFace = 0;
+  uint32_t nbCreated = 0;
+  uint32_t nbAlive = 0;
+
+  class FakeScreen : public Screens::Screen {
+  public:
+    FakeScreen(Apps app, uint16_t nbObjects, uint16_t objectSize) : Screen(nullptr), app {app}, face {clockFace} {
+      lvglScreen = lv_scr_act();
+      for (uint16_t i = 0; i < nbObjects; i++) {
+        lv_obj_create(lvglScreen, nullptr);
+        memory.push_back(LvglMemory::Allocate(objectSize));
+      }
+      nbCreated++;
+      nbAlive++;
+    }
+
+    ~FakeScreen() override {
+      Check(lv_scr_act() == lvglScreen, "destroy", "screen destroyed on another LVGL screen");
+      Check(lv_obj_count_children(lv_scr_act()) == memory.size(), "destroy", "objects of the screen not on the active screen");
+      for (void* block : memory) {
+        LvglMemory::Free(block);
+      }
+      lv_obj_clean(lv_scr_act());
+      nbAlive--;
+    }
+
+    bool CanBeRestored() const override {
+      return running && (app != Apps::Clock || face == clockFace);
+    }
+
+    bool IsShown() const {
+      return lv_scr_act() == lvglScreen && lv_obj_count_children(lvglScreen) == memory.size();
+    }
+
+  private:
+    Apps app;
+    uint8_t face;
+    lv_obj_t* lvglScreen;
+    std::vector<void*> memory;
+  };
+
+  // Number of objects of the screen of app, and their size. The analog watch face is larger than the others.
+  FakeScreen* CreateScreen(Apps app) {
+    switch (app) {
+      case Apps::Clock:
+        return clockFace == 1 ? new FakeScreen(app, 100, 28) : new FakeScreen(app, 50, 28);
+      case Apps::Launcher:
+        return new FakeScreen(app, 40, 24);
+      default:
+        return new FakeScreen(app, 20 + static_cast<uint16_t>(app) * 3, 32);
+    }
+  }
+
+  // DisplayApp::LoadApp(), without the arena
+  class Display {
+  public:
+    // Returns true if the screen of app was restored
+    bool LoadApp(Apps app) {
+      if (currentScreen != nullptr && !screenCache.Retain(currentApp, currentScreen, currentScreenMemory)) {
+        currentScreen.reset(nullptr);
+      }
+      uint32_t lvglMemory = ScreenCache::UsedLvglMemory();
+      bool restored = false;
+      if (ScreenCache::IsCacheable(app)) {
+        currentScreen = screenCache.Restore(app, currentScreenMemory);
+        restored = currentScreen != nullptr;
+      }
+      if (!restored) {
+        currentScreen.reset(CreateScreen(app));
+        currentScreenMemory = ScreenCache::UsedLvglMemory() - lvglMemory;
+      }
+      currentApp = app;
+      return restored;
+    }
+
+    void Clear() {
+      currentScreen.reset(nullptr);
+      screenCache.Clear();
+    }
+
+    bool IsCurrentScreenShown() const {
+      return static_cast<const FakeScreen*>(currentScreen.get())->IsShown();
+    }
+
+    ScreenCache screenCache;
+
+  private:
+    ScreenPtr currentScreen;
+    Apps currentApp = Apps::None;
+    uint32_t currentScreenMemory = 0;
+  };
+
+  struct Step {
+    Apps app;
+    bool restored;
+  };
+
+  void RunSteps(Display& display, const Step* steps, size_t nbSteps, const char* test) {
+    for (size_t i = 0; i < nbSteps; i++) {
+      uint32_t created = nbCreated;
+      bool restored = display.LoadApp(steps[i].app);
+      Check(restored == steps[i].restored, test, steps[i].restored ? "screen not restored" : "screen restored");
+      Check((nbCreated == created) == restored, test, "screen created");
+      Check(display.IsCurrentScreenShown(), test, "objects of the current screen not on the active LVGL screen");
+      Check(display.screenCache.GetMemory() <= ScreenCache::budget, test, "budget exceeded");
+    }
+  }
+
+  void TestScript() {
+    Display display;
+    const Step steps[] = {
+      {Apps::Clock, false},
+      {Apps::Launcher, false},
+      {Apps::StopWatch, false},
+      {Apps::Launcher, true},
+      {Apps::Music, false},
+      {Apps::Clock, true},
+      {Apps::Notifications, false},
+      {Apps::Clock, true},
+      {Apps::Launcher, true},
+      {Apps::Clock, true},
+    };
+    RunSteps(display, steps, sizeof(steps) / sizeof(steps[0]), "script");
+    // The current screen and the launcher
+    Check(nbAlive == 2, "script", "number of screens alive");
+    display.Clear();
+  }
+
+  void TestFaceChange() {
+    Display display;
+    const Step before[] = {{Apps::Clock, false}, {Apps::Launcher, false}, {Apps::Settings, false}};
+    RunSteps(display, before, sizeof(before) / sizeof(before[0]), "face change");
+    clockFace = 3;
+    const Step after[] = {{Apps::Clock, false}, {Apps::Launcher, true}};
+    RunSteps(display, after, sizeof(after) / sizeof(after[0]), "face change");
+    Check(nbAlive == 2, "face change", "screen of the previous watch face not destroyed");
+    display.Clear();
+    clockFace = 0;
+  }
+
+  void TestBudget() {
+    Display display;
+    clockFace = 1;
+    // The launcher is retained while the watch face is: the watch face is destroyed
+    const Step steps[] = {
+      {Apps::Clock, false},
+      {Apps::Launcher, false},
+      {Apps::Paint, false},
+      {Apps::Launcher, true},
+      {Apps::Clock, false},
+    };
+    RunSteps(display, steps, sizeof(steps) / sizeof(steps[0]), "budget");
+    display.Clear();
+    clockFace = 0;
+  }
+
+  Apps RandomApp() {
+    constexpr Apps apps[] = {
+      Apps::StopWatch, Apps::Music, Apps::Paint, Apps::Timer, Apps::HeartRate, Apps::Steps, Apps::Settings, Apps::Notifications};
+    return apps[rand() % (sizeof(apps) / sizeof(apps[0]))];
+  }
+
+  void TestRandomSwitches() {
+    constexpr int nbSwitches = 20000;
+    Display display;
+    uint32_t created = nbCreated;
+    Apps app = Apps::Clock;
+    srand(1);
+    for (int i = 0; i < nbSwitches; i++) {
+      display.LoadApp(app);
+      Check(display.IsCurrentScreenShown(), "random", "objects of the current screen not on the active LVGL screen");
+      Check(display.screenCache.GetMemory() <= ScreenCache::budget, "random", "budget exceeded");
+      Check(nbAlive <= 1 + ScreenCache::maxScreens, "random", "too many screens alive");
+
+      // The watch face opens the launcher or the notifications, the launcher opens the apps, and the apps go back to
+      // the launcher or the watch face
+      if (rand() % 200 == 0) {
+        clockFace = rand() % 4;
+      }
+      if (app == Apps::Clock) {
+        app = rand() % 4 == 0 ? Apps::Notifications : Apps::Launcher;
+      } else if (app == Apps::Launcher) {
+        app = rand() % 5 == 0 ? Apps::Clock : RandomApp();
+      } else {
+        app = rand() % 2 == 0 ? Apps::Clock : Apps::Launcher;
+      }
+    }
+    std::printf("%d app switches: %u screens created, %d without the cache\n", nbSwitches, nbCreated - created, nbSwitches);
+    display.Clear();
+  }
+}
+
+void ScreenDeleter::operator()(Screens::Screen* screen) const {
+  delete screen;
+}
+
+int main() {
+  // The default LVGL screen, and the memory used outside of the screens
+  lv_scr_act();
+  uint32_t objects = HostLvgl::nbObjects;
+  uint32_t memory = ScreenCache::UsedLvglMemory();
+
+  TestScript();
+  TestFaceChange();
+  TestBudget();
+  TestRandomSwitches();
+
+  Check(nbAlive == 0, "leaks", "screens alive after the cache is cleared");
+  Check(HostLvgl::nbObjects == objects, "leaks", "LVGL objects alive after the cache is cleared");
+  Check(ScreenCache::UsedLvglMemory() == memory, "leaks", "LVGL memory used after the cache is cleared");
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,347 @@
+// Headless host simulator of the recovery firmware: the DisplayApp of the recovery (DisplayAppRecovery.cpp), which
+// draws without LVGL, runs in its task on the emulated kernel with the St7789 driver on the emulated SPIM and 240x320
+// panel, and the Cst816S driver and the TouchHandler on the emulated TWIM with a touch controller.
+// A script sends the messages SystemTask sends to the display (BLE connection, firmware update and its progress) and
+// the touch reports of a few gestures. After each step, the frame memory of the panel is dumped as a PPM image
+// (<prefix>-<step>.ppm, the prefix is the first argument) and the timings are reported: when the first and the last
+// pixels reached the panel, the pixels flushed and the SPI transfers. The touch reads report their TWI bus time.
+// Checks the frames (the logo and its color, the width of the progress bar) and the gestures decoded.
+//
+// The code runs in zero emulated time: the timings are those of the SPI bus and of the waits of the display task,
+// not of the CPU. The firmware with LVGL (DisplayApp.cpp, LittleVgl and the screens of the apps) is not simulated:
+// LVGL is not in the tree of the host tests, and neither are the render time or the heap high-water of the apps.
+#include "displayapp/DisplayAppRecovery.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+#include "HostStubs.h"
+#include "components/ble/BleController.h"
+#include "drivers/Cst816s.h"
+#include "drivers/Spi.h"
+#include "drivers/SpiMaster.h"
+#include "drivers/St7789.h"
+#include "drivers/TwiMaster.h"
+#include "emulation/Spim.h"
+#include "emulation/St7789Panel.h"
+#include "emulation/Timer.h"
+#include "emulation/Twim.h"
+#include "touchhandler/TouchHandler.h"
+
+using namespace Pinetime;
+using Pinetime::Applications::TouchEvents;
+using Pinetime::Applications::Display::Messages;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  // Same peripherals and pins as main.cpp
+  Drivers::SpiMaster spiMaster {Drivers::SpiMaster::SpiModule::SPI0,
+                                {Drivers::SpiMaster::BitOrder::Msb_Lsb, Drivers::SpiMaster::Modes::Mode3,
+                                 Drivers::SpiMaster::Frequencies::Freq8Mhz, 2, 3, 4}};
+  constexpr uint8_t pinLcdCsn = 25;
+  constexpr uint8_t pinLcdDataCommand = 18;
+  Drivers::Spi lcdSpi {spiMaster, pinLcdCsn};
+  Drivers::St7789 lcd {lcdSpi, pinLcdDataCommand};
+
+  Drivers::TwiMaster twiMaster {NRF_TWIM1, 0x06200000, 6, 7};
+  constexpr uint8_t touchPanelTwiAddress = 0x15;
+  Drivers::Cst816S touchPanel {twiMaster, touchPanelTwiAddress};
+
+  void SpimIrqHandler() {
+    if (((NRF_SPIM0->INTENSET & (1 << 6)) != 0) && NRF_SPIM0->EVENTS_END == 1) {
+      NRF_SPIM0->EVENTS_END = 0;
+      spiMaster.OnEndEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 19)) != 0) && NRF_SPIM0->EVENTS_STARTED == 1) {
+      NRF_SPIM0->EVENTS_STARTED = 0;
+      spiMaster.OnStartedEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 1)) != 0) && NRF_SPIM0->EVENTS_STOPPED == 1) {
+      NRF_SPIM0->EVENTS_STOPPED = 0;
+    }
+  }
+
+  void Timer3IrqHandler() {
+    if (NRF_TIMER3->EVENTS_COMPARE[0] == 1) {
+      NRF_TIMER3->EVENTS_COMPARE[0] = 0;
+      spiMaster.OnChainEndEvent();
+    }
+  }
+
+  void TwimIrqHandler() {
+    twiMaster.OnInterrupt();
+  }
+
+  Emulation::Spim spim {*NRF_SPIM0, SpimIrqHandler};
+  Emulation::Timer timer3 {*NRF_TIMER3, Timer3IrqHandler};
+  Emulation::St7789Panel panel {pinLcdDataCommand};
+  Emulation::Twim twim {*NRF_TWIM1, TwimIrqHandler};
+  // The CST816S: the gesture, the number of touch points and the coordinates are in the registers 1 to 6
+  Emulation::RegisterDevice touchController;
+
+  // The controllers the recovery DisplayApp takes but never uses: they are only declared in its header
+  template <class T> T& Unused() {
+    static uint64_t storage[8];
+    return *reinterpret_cast<T*>(storage);
+  }
+
+  Components::LittleVgl lvgl {lcd, touchPanel};
+  Controllers::TouchHandler touchHandler {touchPanel, lvgl};
+  Controllers::Ble bleController;
+  Drivers::Watchdog watchdog;
+  Drivers::WatchdogView watchdogView {watchdog};
+  Controllers::MotorController motorController;
+  Applications::DisplayApp displayApp {lcd,
+                                       lvgl,
+                                       touchPanel,
+                                       Unused<Controllers::Battery>(),
+                                       bleController,
+                                       Unused<Controllers::DateTime>(),
+                                       watchdogView,
+                                       Unused<Controllers::NotificationManager>(),
+                                       Unused<Controllers::HeartRateController>(),
+                                       Unused<Controllers::Settings>(),
+                                       motorController,
+                                       Unused<Controllers::MotionController>(),
+                                       Unused<Controllers::TimerController>(),
+                                       Unused<Controllers::AlarmController>(),
+                                       Unused<Controllers::BrightnessController>(),
+                                       touchHandler,
+                                       Unused<Controllers::FS>()};
+
+  const char* framePrefix = "frame";
+  bool completed = false;
+
+  // The logo and the progress bar are drawn in the top 240x240 pixels of the panel
+  constexpr uint16_t screenSize = 240;
+  constexpr uint16_t barHeight = 20;
+  constexpr uint32_t firmwareSize = 400000;
+  // RGB565, as received by the panel
+  constexpr uint16_t white = 0xffff;
+  constexpr uint16_t green = 0x07e0;
+
+  double Milliseconds(uint64_t cycles) {
+    return cycles * 1000.0 / HostStubs::cpuFrequency;
+  }
+
+  std::vector<uint16_t> Screen() {
+    std::vector<uint16_t> pixels;
+    for (uint16_t y = 0; y < screenSize; y++) {
+      for (uint16_t x = 0; x < screenSize; x++) {
+        pixels.push_back(panel.Pixel(x, y));
+      }
+    }
+    return pixels;
+  }
+
+  // Runs a step of the script for duration, then dumps the frame and reports the pixels flushed meanwhile
+  void RunStep(const char* name, void (*action)(), TickType_t duration) {
+    uint64_t start = HostStubs::Now();
+    panel.pixelsWritten = 0;
+    auto before = spiMaster.GetStatistics();
+    action();
+    vTaskDelay(duration);
+
+    const auto& after = spiMaster.GetStatistics();
+    std::string path = std::string(framePrefix) + "-" + name + ".ppm";
+    Check(panel.Dump(path.c_str()), name, "frame not dumped");
+    if (panel.pixelsWritten == 0) {
+      std::printf("%s: no pixel flushed\n", name);
+      return;
+    }
+    std::printf("%s: %u pixels flushed from %.2f ms to %.2f ms, %u SPI transfers, %u DMA transactions, %u interrupts\n",
+                name,
+                panel.pixelsWritten,
+                Milliseconds(panel.firstPixelTime - start),
+                Milliseconds(panel.lastPixelTime - start),
+                after.transfers - before.transfers,
+                after.dmaTransactions - before.dmaTransactions,
+                after.interrupts - before.interrupts);
+  }
+
+  // The logo is drawn in 2 colors, the background is black
+  void CheckLogo(const char* test, const std::vector<uint16_t>& screen, const std::vector<uint16_t>& reference) {
+    std::set<uint16_t> colors(screen.begin(), screen.end());
+    Check(colors.size() == 2 && colors.count(0) == 1, test, "not a logo on a black background");
+    bool sameShape = true;
+    for (size_t i = 0; i < screen.size(); i++) {
+      sameShape = sameShape && (screen[i] == 0) == (reference[i] == 0);
+    }
+    Check(sameShape, test, "not the same logo");
+  }
+
+  // The progress bar is drawn in color over the bottom lines of the logo, on the left of the screen
+  void CheckBar(const char* test, const std::vector<uint16_t>& logo, uint8_t percent, uint16_t color) {
+    uint16_t width = static_cast<uint16_t>(percent * screenSize / 100);
+    bool barOk = true;
+    bool logoOk = true;
+    for (uint16_t y = 0; y < screenSize; y++) {
+      for (uint16_t x = 0; x < screenSize; x++) {
+        if (y >= screenSize - barHeight && x < width) {
+          barOk = barOk && panel.Pixel(x, y) == color;
+        } else {
+          logoOk = logoOk && panel.Pixel(x, y) == logo[y * screenSize + x];
+        }
+      }
+    }
+    Check(barOk, test, "wrong progress bar");
+    Check(logoOk, test, "logo changed outside of the progress bar");
+  }
+
+  void Progress(uint8_t percent) {
+    bleController.FirmwareUpdateCurrentBytes(firmwareSize / 100 * percent);
+  }
+
+  // The messages and the controller updates of SystemTask
+  void RunDisplaySteps() {
+    RunStep("01-boot", [] {}, pdMS_TO_TICKS(200));
+    auto boot = Screen();
+    Check(panel.pixelsWritten == screenSize * screenSize, "boot", "logo not drawn once");
+    CheckLogo("boot", boot, boot);
+
+    RunStep(
+      "02-ble-connected",
+      [] {
+        bleController.Connect();
+        displayApp.PushMessage(Messages::UpdateBleConnection);
+      },
+      pdMS_TO_TICKS(200));
+    auto connected = Screen();
+    CheckLogo("ble connected", connected, boot);
+    Check(connected != boot, "ble connected", "logo color not changed");
+
+    // Redraws the logo, then the progress bar every 200 ticks
+    RunStep(
+      "03-update-started",
+      [] {
+        bleController.StartFirmwareUpdate();
+        bleController.FirmwareUpdateTotalBytes(firmwareSize);
+        bleController.State(Controllers::Ble::FirmwareUpdateStates::Running);
+        displayApp.PushMessage(Messages::BleFirmwareUpdateStarted);
+      },
+      pdMS_TO_TICKS(150));
+    auto logo = Screen();
+    CheckLogo("update started", logo, boot);
+    Check(logo != boot && logo != connected, "update started", "logo color not changed");
+
+    RunStep("04-progress-25", [] { Progress(25); }, pdMS_TO_TICKS(250));
+    CheckBar("progress 25", logo, 25, white);
+    RunStep("05-progress-50", [] { Progress(50); }, pdMS_TO_TICKS(250));
+    CheckBar("progress 50", logo, 50, white);
+    RunStep("06-progress-75", [] { Progress(75); }, pdMS_TO_TICKS(250));
+    CheckBar("progress 75", logo, 75, white);
+    RunStep(
+      "07-validated",
+      [] {
+        Progress(100);
+        bleController.State(Controllers::Ble::FirmwareUpdateStates::Validated);
+      },
+      pdMS_TO_TICKS(250));
+    CheckBar("validated", logo, 100, green);
+  }
+
+  struct TouchReport {
+    Drivers::Cst816S::Gestures gesture;
+    bool touching;
+    uint16_t x;
+    uint16_t y;
+    // Result of TouchHandler::GetNewTouchInfo() and gesture decoded
+    bool valid;
+    TouchEvents expected;
+  };
+
+  // Reads a touch report, as SystemTask does on the interrupt of the touch controller
+  void RunTouchReports(const char* name, std::initializer_list<TouchReport> reports) {
+    uint64_t busCycles = 0;
+    uint64_t latency = 0;
+    for (const auto& report : reports) {
+      touchController.registers[1] = static_cast<uint8_t>(report.gesture);
+      touchController.registers[2] = report.touching ? 1 : 0;
+      touchController.registers[3] = static_cast<uint8_t>(report.x >> 8);
+      touchController.registers[4] = static_cast<uint8_t>(report.x);
+      touchController.registers[5] = static_cast<uint8_t>(report.y >> 8);
+      touchController.registers[6] = static_cast<uint8_t>(report.y);
+      twim.Reset();
+      uint64_t start = HostStubs::Now();
+
+      bool valid = touchHandler.GetNewTouchInfo();
+
+      latency += HostStubs::Now() - start;
+      busCycles += twim.BusyCycles();
+      Check(valid == report.valid, name, "wrong validity of the touch report");
+      Check(touchHandler.GestureGet() == report.expected, name, "wrong gesture");
+      if (valid) {
+        Check(touchHandler.GetX() == report.x && touchHandler.GetY() == report.y, name, "wrong touch point");
+        Check(touchHandler.IsTouching() == report.touching, name, "wrong touch state");
+      }
+    }
+    std::printf("%s: %zu touch reports, TWI bus %.3f ms, read in %.3f ms\n",
+                name,
+                reports.size(),
+                Milliseconds(busCycles),
+                Milliseconds(latency));
+  }
+
+  void RunTouchSteps() {
+    using Gestures = Drivers::Cst816S::Gestures;
+    RunTouchReports("tap",
+                    {{Gestures::SingleTap, true, 120, 160, true, TouchEvents::Tap},
+                     {Gestures::None, false, 120, 160, true, TouchEvents::None}});
+    // A swipe is only reported once, until the finger is released
+    RunTouchReports("swipe up",
+                    {{Gestures::None, true, 120, 200, true, TouchEvents::None},
+                     {Gestures::SlideUp, true, 120, 120, true, TouchEvents::SwipeUp},
+                     {Gestures::SlideUp, true, 120, 60, true, TouchEvents::None},
+                     {Gestures::SlideUp, false, 120, 60, true, TouchEvents::None}});
+    RunTouchReports("long press",
+                    {{Gestures::LongPress, true, 40, 40, true, TouchEvents::LongTap},
+                     {Gestures::None, false, 40, 40, true, TouchEvents::None}});
+    RunTouchReports("invalid", {{Gestures::None, true, 300, 40, false, TouchEvents::None}});
+  }
+
+  // SystemTask::Work(): initializes the display and the touch panel, then starts the display task
+  void Script(void* /*parameters*/) {
+    spiMaster.Init();
+    lcd.Init();
+    twiMaster.Init();
+    touchPanel.Init();
+    Check(twim.transactions.size() >= 4, "init", "touch panel not initialized");
+    displayApp.Start();
+
+    RunDisplaySteps();
+    RunTouchSteps();
+    completed = true;
+    HostStubs::StopScheduler();
+    vTaskDelete(nullptr);
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    framePrefix = argv[1];
+  }
+  spim.Connect(pinLcdCsn, panel);
+  twim.Connect(touchPanelTwiAddress, touchController);
+  // Higher priority than the display task
+  xTaskCreate(Script, "script", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+  vTaskStartScheduler();
+  Check(completed, "script", "the script task is blocked forever");
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
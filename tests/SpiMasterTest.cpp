@@ -0,0 +1,367 @@
+// Host test of the SpiMaster transfers, against the emulated SPIM, PPI and TIMER3 (tests/emulation) that run the
+// chained EasyDMA transfers: checks the data on the bus and the number of interrupts per transfer, the CPU time spent
+// spinning, and the bus latency of the display while the flash is read.
+#include "drivers/SpiMaster.h"
+#include <hal/nrf_gpio.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "drivers/Spi.h"
+#include "drivers/SpiNorFlash.h"
+#include "emulation/NorFlash.h"
+#include "emulation/Spim.h"
+#include "emulation/Timer.h"
+
+using namespace Pinetime::Drivers;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  SpiMaster spi {SpiMaster::SpiModule::SPI0,
+                 {SpiMaster::BitOrder::Msb_Lsb, SpiMaster::Modes::Mode3, SpiMaster::Frequencies::Freq8Mhz, 2, 3, 4}};
+  constexpr uint8_t pinCsn = 25;
+
+  // Same handlers as in main.cpp
+  void SpimIrqHandler() {
+    if (((NRF_SPIM0->INTENSET & (1 << 6)) != 0) && NRF_SPIM0->EVENTS_END == 1) {
+      NRF_SPIM0->EVENTS_END = 0;
+      spi.OnEndEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 19)) != 0) && NRF_SPIM0->EVENTS_STARTED == 1) {
+      NRF_SPIM0->EVENTS_STARTED = 0;
+      spi.OnStartedEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 1)) != 0) && NRF_SPIM0->EVENTS_STOPPED == 1) {
+      NRF_SPIM0->EVENTS_STOPPED = 0;
+    }
+  }
+
+  void Timer3IrqHandler() {
+    if (NRF_TIMER3->EVENTS_COMPARE[0] == 1) {
+      NRF_TIMER3->EVENTS_COMPARE[0] = 0;
+      spi.OnChainEndEvent();
+    }
+  }
+
+  Emulation::Spim spim {*NRF_SPIM0, SpimIrqHandler};
+  Emulation::Timer timer3 {*NRF_TIMER3, Timer3IrqHandler};
+
+  // Sends back the position of the byte in the transaction
+  class Device : public Emulation::SpiDevice {
+  public:
+    void Select() override {
+      position = 0;
+    }
+
+    uint8_t Exchange(uint8_t /*mosi*/) override {
+      return static_cast<uint8_t>(position++);
+    }
+
+  private:
+    uint32_t position = 0;
+  };
+
+  Device device;
+  constexpr uint8_t pinDataCommand = 18;
+  constexpr uint8_t pinFlashCsn = 5;
+  Emulation::NorFlash flash;
+  bool completed = false;
+
+  std::vector<uint8_t> Sent() {
+    std::vector<uint8_t> sent;
+    for (const auto& transaction : spim.transactions) {
+      sent.insert(sent.end(), transaction.sent.begin(), transaction.sent.end());
+    }
+    return sent;
+  }
+
+  void TestWrite(const char* test, size_t size, uint32_t expectedSpimInterrupts, uint32_t expectedTimerInterrupts) {
+    std::vector<uint8_t> buffer(size);
+    for (size_t i = 0; i < size; i++) {
+      buffer[i] = static_cast<uint8_t>(i * 7);
+    }
+    spim.Reset();
+    timer3.interrupts = 0;
+
+    Check(spi.Write(pinCsn, SpiMaster::Priorities::Low, buffer.data(), size), test, "Write() failed");
+    Check(!HostStubs::gpioLevels[pinCsn], test, "CS is not asserted during the transfer");
+    Check(ulTaskNotifyTake(pdTRUE, portMAX_DELAY) == 1, test, "the task is not notified once");
+
+    Check(Sent() == buffer, test, "wrong data sent");
+    Check(HostStubs::gpioLevels[pinCsn], test, "CS is still asserted");
+    Check(spim.interrupts == expectedSpimInterrupts, test, "unexpected number of SPIM interrupts");
+    Check(timer3.interrupts == expectedTimerInterrupts, test, "unexpected number of TIMER3 interrupts");
+    Check(NRF_SPIM0->INTEN == ((1U << 6) | (1U << 1) | (1U << 19)), test, "SPIM interrupts not restored");
+    Check((NRF_PPI->CHEN & 0b1110) == 0, test, "chain PPI channels still enabled");
+    std::printf("%s: %zu bytes, %zu DMA transactions, %u SPIM + %u TIMER3 interrupts\n",
+                test,
+                size,
+                spim.transactions.size(),
+                spim.interrupts,
+                timer3.interrupts);
+  }
+
+  void TestRead(const char* test, size_t size) {
+    uint8_t cmd[4] = {0x03};
+    std::vector<uint8_t> data(size);
+    spim.Reset();
+
+    Check(spi.Read(pinCsn, SpiMaster::Priorities::High, cmd, 4, data.data(), size), test, "Read() failed");
+    Check(HostStubs::gpioLevels[pinCsn], test, "CS is still asserted");
+    auto sent = Sent();
+    Check(sent.size() == 4 && sent[0] == 0x03, test, "wrong command sent");
+    bool dataOk = true;
+    for (size_t i = 0; i < size; i++) {
+      dataOk = dataOk && data[i] == static_cast<uint8_t>(sizeof(cmd) + i);
+    }
+    Check(dataOk, test, "wrong data received");
+  }
+
+  // SpiMaster::Read() before it was interrupt driven: the SPIM interrupts are disabled, and the CPU spins on END
+  // while the command is sent and again while the data is received. Returns the cycles spent.
+  uint32_t BaselineRead(uint8_t pinCsn, const uint8_t* cmd, size_t cmdSize, uint8_t* data, size_t dataSize) {
+    uint32_t startCycleCount = DWT->CYCCNT;
+    NRF_SPIM0->INTENCLR = (1 << 6);
+    NRF_SPIM0->INTENCLR = (1 << 1);
+    NRF_SPIM0->INTENCLR = (1 << 19);
+    nrf_gpio_pin_clear(pinCsn);
+
+    NRF_SPIM0->TXD.PTR = HostStubs::Address(cmd);
+    NRF_SPIM0->TXD.MAXCNT = cmdSize;
+    NRF_SPIM0->TXD.LIST = 0;
+    NRF_SPIM0->RXD.PTR = 0;
+    NRF_SPIM0->RXD.MAXCNT = 0;
+    NRF_SPIM0->RXD.LIST = 0;
+    NRF_SPIM0->EVENTS_END = 0;
+    NRF_SPIM0->TASKS_START = 1;
+    while (NRF_SPIM0->EVENTS_END == 0)
+      ;
+
+    NRF_SPIM0->TXD.PTR = 0;
+    NRF_SPIM0->TXD.MAXCNT = 0;
+    NRF_SPIM0->RXD.PTR = HostStubs::Address(data);
+    NRF_SPIM0->RXD.MAXCNT = dataSize;
+    NRF_SPIM0->EVENTS_END = 0;
+    NRF_SPIM0->TASKS_START = 1;
+    while (NRF_SPIM0->EVENTS_END == 0)
+      ;
+    nrf_gpio_pin_set(pinCsn);
+
+    NRF_SPIM0->EVENTS_END = 0;
+    NRF_SPIM0->INTENSET = (1 << 6);
+    NRF_SPIM0->INTENSET = (1 << 1);
+    NRF_SPIM0->INTENSET = (1 << 19);
+    return DWT->CYCCNT - startCycleCount;
+  }
+
+  // CPU cycles spent spinning during a redraw of the 240x240 screen in bands of 4 lines (the default LVGL draw
+  // buffer), after reading 4KB from the flash (a background image, some glyphs...), with the current driver and with
+  // the baseline one: the address window of each band was set with 11 one-byte writes, and the reads spun.
+  void TestRedrawSpinCycles() {
+    constexpr uint16_t bandLines = 4;
+    constexpr size_t bandSize = 240 * bandLines * 2;
+    constexpr size_t nbReads = 16;
+    constexpr size_t readSize = 255;
+    std::vector<uint8_t> band(bandSize, 0x5a);
+    uint8_t cmd[4] = {0x03};
+    std::vector<uint8_t> data(readSize);
+    const char* test = "redraw spin cycles";
+
+    // Current driver: the command sequence of the first band (CASET, RASET, RAMWR), then RAMWRC for the next ones
+    auto start = spi.GetStatistics();
+    for (size_t i = 0; i < nbReads; i++) {
+      spi.Read(pinFlashCsn, SpiMaster::Priorities::Low, cmd, sizeof(cmd), data.data(), data.size());
+    }
+    uint32_t readSpinCycles = spi.GetStatistics().spinCycles - start.spinCycles;
+    for (uint16_t y = 0; y < 240; y += bandLines) {
+      if (y == 0) {
+        const uint8_t sequence[] = {0x2a, 0, 0, 0, 239, 0x2b, 0, 0, 0x01, 0x3f, 0x2c};
+        const uint8_t runSizes[] = {5, 5, 1};
+        spi.WriteCommandSequence(pinCsn, SpiMaster::Priorities::Low, pinDataCommand, sequence, runSizes, 3);
+      } else {
+        const uint8_t sequence[] = {0x3c};
+        const uint8_t runSizes[] = {1};
+        spi.WriteCommandSequence(pinCsn, SpiMaster::Priorities::Low, pinDataCommand, sequence, runSizes, 1);
+      }
+      spi.Write(pinCsn, SpiMaster::Priorities::Low, band.data(), band.size());
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    uint32_t spinCycles = spi.GetStatistics().spinCycles - start.spinCycles;
+
+    // Baseline driver
+    uint32_t baselineReadSpinCycles = 0;
+    for (size_t i = 0; i < nbReads; i++) {
+      baselineReadSpinCycles += BaselineRead(pinFlashCsn, cmd, sizeof(cmd), data.data(), data.size());
+    }
+    start = spi.GetStatistics();
+    for (uint16_t y = 0; y < 240; y += bandLines) {
+      const uint8_t window[] = {
+        0x2a, 0, 0, 0, 239, 0x2b, 0, static_cast<uint8_t>(y), 0, static_cast<uint8_t>(y + bandLines - 1), 0x2c};
+      for (uint8_t byte : window) {
+        spi.Write(pinCsn, SpiMaster::Priorities::Low, &byte, 1);
+      }
+      spi.Write(pinCsn, SpiMaster::Priorities::Low, band.data(), band.size());
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    uint32_t baselineSpinCycles = baselineReadSpinCycles + spi.GetStatistics().spinCycles - start.spinCycles;
+
+    Check(readSpinCycles == 0, test, "the CPU spins during the reads");
+    Check(spinCycles * 10 < baselineSpinCycles, test, "the CPU does not spin much less than with the baseline driver");
+    std::printf("%s: %u cycles (reads: %u), baseline: %u cycles (reads: %u)\n",
+                test,
+                spinCycles,
+                readSpinCycles,
+                baselineSpinCycles,
+                baselineReadSpinCycles);
+  }
+
+  // The display (High priority) flushes a band every 5ms while a file is read from the flash (Low priority) by
+  // SpiNorFlash, in slices of 256 bytes. The display must get the bus at the end of the slice in progress.
+  namespace Arbitration {
+    Spi lcdSpi {spi, pinCsn, SpiMaster::Priorities::High};
+    Spi flashSpi {spi, pinFlashCsn};
+    SpiNorFlash spiNorFlash {flashSpi};
+
+    constexpr size_t fileSize = 64 * 1024;
+    constexpr int nbFlushes = 40;
+    // The 4 bytes command and the 256 bytes of a slice, in 3 DMA transactions (RXD.MAXCNT is 255) with a margin for
+    // the start of each one
+    constexpr uint64_t sliceCycles = (4 + 256) * Emulation::Spim::cyclesPerByte + 3 * 16;
+
+    bool sliced = true;
+    bool flushesDone = false;
+    bool fileOk = true;
+    uint64_t maxWait = 0;
+    int flushes = 0;
+
+    void DisplayTask(void* /*parameters*/) {
+      std::vector<uint8_t> band(240 * 4 * 2, 0x5a);
+      for (int i = 0; i < nbFlushes; i++) {
+        vTaskDelay(pdMS_TO_TICKS(5));
+        uint64_t callTime = HostStubs::Now();
+        size_t nbTransactions = spim.transactions.size();
+        lcdSpi.Write(band.data(), band.size());
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // First transaction of the flush
+        auto flush = std::find_if(spim.transactions.begin() + nbTransactions, spim.transactions.end(), [](const auto& t) {
+          return t.pinCsn == pinCsn;
+        });
+        if (flush != spim.transactions.end()) {
+          maxWait = std::max(maxWait, flush->startTime - callTime);
+          flushes++;
+        }
+      }
+      flushesDone = true;
+      vTaskDelete(nullptr);
+    }
+
+    void FileTask(void* /*parameters*/) {
+      std::vector<uint8_t> file(fileSize);
+      while (!flushesDone) {
+        if (sliced) {
+          spiNorFlash.Read(0, file.data(), file.size());
+        } else {
+          uint8_t cmd[4] = {0x03, 0, 0, 0};
+          flashSpi.Read(cmd, sizeof(cmd), file.data(), file.size());
+        }
+        fileOk = fileOk && std::equal(file.begin(), file.end(), flash.memory.begin());
+      }
+      vTaskDelete(nullptr);
+    }
+  }
+
+  // Returns the longest wait of the display for the bus
+  uint64_t RunArbitration(bool slicedReads) {
+    using namespace Arbitration;
+    sliced = slicedReads;
+    flushesDone = false;
+    fileOk = true;
+    maxWait = 0;
+    flushes = 0;
+    xTaskCreate(DisplayTask, "display", configMINIMAL_STACK_SIZE, nullptr, 2, nullptr);
+    xTaskCreate(FileTask, "file", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+    // Lets both tasks run until they are done
+    while (!flushesDone) {
+      vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+    return maxWait;
+  }
+
+  void TestArbitration() {
+    using namespace Arbitration;
+    const char* test = "arbitration";
+    for (size_t i = 0; i < fileSize; i++) {
+      flash.memory[i] = static_cast<uint8_t>(i * 13 + (i >> 8));
+    }
+    spim.Reset();
+    uint32_t bytesReadBefore = flash.bytesRead;
+    RunArbitration(true);
+
+    uint32_t maxStatisticsWait = spi.GetStatistics().maxHighPriorityWaitCycles;
+    Check(flushes == nbFlushes, test, "flushes missing");
+    Check(fileOk, test, "wrong data read from the flash");
+    Check(flash.bytesRead - bytesReadBefore >= fileSize, test, "the file was not read while the display was flushed");
+    Check(maxWait > 0, test, "the display never waited for the flash");
+    Check(maxWait <= sliceCycles, test, "the display waited for more than a slice of the flash read");
+    Check(maxStatisticsWait <= maxWait && maxWait - maxStatisticsWait < Emulation::Spim::cyclesPerByte,
+          test,
+          "maxHighPriorityWaitCycles does not report the wait of the display");
+    std::printf("%s: %d flushes during %u bytes of flash reads, max wait %lu cycles (statistics: %u), slice %lu cycles\n",
+                test,
+                flushes,
+                flash.bytesRead - bytesReadBefore,
+                static_cast<unsigned long>(maxWait),
+                maxStatisticsWait,
+                static_cast<unsigned long>(sliceCycles));
+
+    // Reference: the whole file in a single read
+    uint64_t unslicedMaxWait = RunArbitration(false);
+    Check(unslicedMaxWait > sliceCycles, test, "the display does not wait for an unsliced read");
+    std::printf("%s: max wait with unsliced reads %lu cycles\n", test, static_cast<unsigned long>(unslicedMaxWait));
+  }
+
+  void RunTests(void* /*parameters*/) {
+    spi.Init();
+
+    // 20 lines of 240 RGB565 pixels: 40 chunks of 240 bytes, a single interrupt
+    TestWrite("chained write", 240 * 20 * 2, 0, 1);
+    // 1009 is prime: 3 chained chunks of 255 bytes, and the remaining 244 bytes (STARTED and END interrupts)
+    TestWrite("chained write with remainder", 1009, 2, 1);
+    // Single DMA transaction: STARTED and END interrupts
+    TestWrite("single write", 200, 2, 0);
+
+    // The completion of the reads must not leak from one read to the next one
+    for (int i = 0; i < 10; i++) {
+      TestRead("read", 600);
+    }
+
+    TestRedrawSpinCycles();
+    TestArbitration();
+    completed = true;
+  }
+}
+
+int main() {
+  spim.Connect(pinCsn, device);
+  spim.Connect(pinFlashCsn, flash);
+  xTaskCreate(RunTests, "tests", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+  vTaskStartScheduler();
+  Check(completed, "tests", "the test task is blocked forever");
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
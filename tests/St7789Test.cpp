@@ -0,0 +1,207 @@
+// Host test of the St7789 driver:
+// - the RGB444 conversion of the display buffers: compares St7789::PackRgb444() with a conversion done pixel by pixel.
+// - the SPI traffic of DrawBuffer(), against the emulated SPIM and panel: counts the DMA transactions (and those the
+//   CPU spins on) needed to set up the address window, depending on the previous window, and checks the frame memory.
+//   An empty area is drawn without pixels.
+#include "drivers/St7789.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "drivers/Spi.h"
+#include "drivers/SpiMaster.h"
+#include "emulation/Spim.h"
+#include "emulation/St7789Panel.h"
+#include "emulation/Timer.h"
+
+using namespace Pinetime::Drivers;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, size_t nbPixels, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %zu pixels: %s\n", nbPixels, what);
+      failures++;
+    }
+  }
+
+  // RGB565 big endian pixels to RGB444, 2 pixels in 3 bytes. An odd last pixel is sent as 2 bytes.
+  std::vector<uint8_t> Reference(const std::vector<uint8_t>& rgb565) {
+    std::vector<uint16_t> pixels;
+    for (size_t i = 0; i + 1 < rgb565.size(); i += 2) {
+      uint16_t pixel = (rgb565[i] << 8) | rgb565[i + 1];
+      uint16_t red = (pixel >> 12) & 0x0f;
+      uint16_t green = (pixel >> 7) & 0x0f;
+      uint16_t blue = (pixel >> 1) & 0x0f;
+      pixels.push_back((red << 8) | (green << 4) | blue);
+    }
+
+    std::vector<uint8_t> packed;
+    for (size_t i = 0; i < pixels.size(); i += 2) {
+      packed.push_back(pixels[i] >> 4);
+      if (i + 1 < pixels.size()) {
+        packed.push_back(((pixels[i] & 0x0f) << 4) | (pixels[i + 1] >> 8));
+        packed.push_back(pixels[i + 1] & 0xff);
+      } else {
+        packed.push_back((pixels[i] & 0x0f) << 4);
+      }
+    }
+    return packed;
+  }
+
+  void Test(size_t nbPixels) {
+    std::vector<uint8_t> buffer(nbPixels * 2);
+    uint32_t seed = 12345 + nbPixels;
+    for (auto& byte : buffer) {
+      seed = seed * 1103515245 + 12345;
+      byte = static_cast<uint8_t>(seed >> 16);
+    }
+    auto expected = Reference(buffer);
+
+    size_t size = St7789::PackRgb444(buffer.data(), nbPixels);
+    Check(size == expected.size(), nbPixels, "wrong packed size");
+    Check(size == St7789::BufferSize(nbPixels, St7789::PixelFormats::Rgb444), nbPixels, "BufferSize() does not match");
+    Check(std::equal(expected.begin(), expected.end(), buffer.begin()), nbPixels, "wrong packed pixels");
+  }
+
+  SpiMaster spiMaster {SpiMaster::SpiModule::SPI0,
+                       {SpiMaster::BitOrder::Msb_Lsb, SpiMaster::Modes::Mode3, SpiMaster::Frequencies::Freq8Mhz, 2, 3, 4}};
+  constexpr uint8_t pinLcdCsn = 25;
+  constexpr uint8_t pinLcdDataCommand = 18;
+  Spi lcdSpi {spiMaster, pinLcdCsn};
+  St7789 lcd {lcdSpi, pinLcdDataCommand};
+
+  // Same handlers as in main.cpp
+  void SpimIrqHandler() {
+    if (((NRF_SPIM0->INTENSET & (1 << 6)) != 0) && NRF_SPIM0->EVENTS_END == 1) {
+      NRF_SPIM0->EVENTS_END = 0;
+      spiMaster.OnEndEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 19)) != 0) && NRF_SPIM0->EVENTS_STARTED == 1) {
+      NRF_SPIM0->EVENTS_STARTED = 0;
+      spiMaster.OnStartedEvent();
+    }
+
+    if (((NRF_SPIM0->INTENSET & (1 << 1)) != 0) && NRF_SPIM0->EVENTS_STOPPED == 1) {
+      NRF_SPIM0->EVENTS_STOPPED = 0;
+    }
+  }
+
+  void Timer3IrqHandler() {
+    if (NRF_TIMER3->EVENTS_COMPARE[0] == 1) {
+      NRF_TIMER3->EVENTS_COMPARE[0] = 0;
+      spiMaster.OnChainEndEvent();
+    }
+  }
+
+  Emulation::Spim spim {*NRF_SPIM0, SpimIrqHandler};
+  Emulation::Timer timer3 {*NRF_TIMER3, Timer3IrqHandler};
+  Emulation::St7789Panel panel {pinLcdDataCommand};
+  bool completed = false;
+
+  void CheckDraw(const char* test, bool condition, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  // Draws an area of random RGB565 pixels, and checks the commands sent before them and the cost of the address
+  // window setup: the command sequence is sent in DMA transactions the CPU spins on, the pixels are not.
+  void TestDraw(const char* test,
+                uint16_t x,
+                uint16_t y,
+                uint16_t width,
+                uint16_t height,
+                const std::vector<uint8_t>& expectedCommands,
+                uint32_t expectedSetupTransactions) {
+    std::vector<uint8_t> buffer(width * height * 2);
+    uint32_t seed = 12345 + x + y * 1000;
+    for (auto& byte : buffer) {
+      seed = seed * 1103515245 + 12345;
+      byte = static_cast<uint8_t>(seed >> 16);
+    }
+    auto start = spiMaster.GetStatistics();
+    panel.commands.clear();
+
+    lcd.DrawBuffer(x, y, width, height, buffer.data(), buffer.size());
+    CheckDraw(test, ulTaskNotifyTake(pdTRUE, portMAX_DELAY) == 1, "the transfer is not completed");
+
+    const auto& end = spiMaster.GetStatistics();
+    uint32_t setupTransactions = end.spinWaits - start.spinWaits;
+    uint32_t pixelTransactions = end.dmaTransactions - start.dmaTransactions - setupTransactions;
+    CheckDraw(test, panel.commands == expectedCommands, "unexpected commands");
+    CheckDraw(test, setupTransactions == expectedSetupTransactions, "unexpected number of address window transactions");
+    CheckDraw(test, end.transfers - start.transfers == 2, "the command sequence and the pixels are not 2 transfers");
+
+    bool pixelsOk = true;
+    for (uint16_t row = 0; row < height; row++) {
+      for (uint16_t column = 0; column < width; column++) {
+        size_t index = (row * width + column) * 2;
+        uint16_t expected = static_cast<uint16_t>((buffer[index] << 8) | buffer[index + 1]);
+        pixelsOk = pixelsOk && panel.Pixel(x + column, y + row) == expected;
+      }
+    }
+    CheckDraw(test, pixelsOk, "wrong pixels in the frame memory");
+    std::printf("%s: %zu commands, %u address window DMA transactions (%u spin cycles), %u pixel DMA transactions\n",
+                test,
+                panel.commands.size(),
+                setupTransactions,
+                end.spinCycles - start.spinCycles,
+                pixelTransactions);
+  }
+
+  // An empty area, as the progress bar of the recovery firmware at 0%: the transfer completes without pixels
+  void TestEmptyDraw() {
+    const char* test = "empty area";
+    uint8_t pixel[2] = {};
+    uint32_t pixelsWritten = panel.pixelsWritten;
+    lcd.DrawBuffer(0, 230, 0, 1, pixel, 0);
+    CheckDraw(test, ulTaskNotifyTake(pdTRUE, portMAX_DELAY) == 1, "the transfer is not completed");
+    CheckDraw(test, panel.pixelsWritten == pixelsWritten, "pixels written");
+  }
+
+  constexpr uint8_t caset = 0x2a;
+  constexpr uint8_t raset = 0x2b;
+  constexpr uint8_t ramwr = 0x2c;
+  constexpr uint8_t ramwrc = 0x3c;
+
+  void RunDrawTests(void* /*parameters*/) {
+    spiMaster.Init();
+    lcd.Init();
+
+    // CASET and RASET with their parameters, RAMWR: 5 transactions (the D/C pin changes 4 times)
+    TestDraw("first band", 0, 0, 240, 20, {caset, raset, ramwr}, 5);
+    // Next rows, same columns: RAMWRC in a single transaction
+    TestDraw("contiguous band", 0, 20, 240, 20, {ramwrc}, 1);
+    TestDraw("contiguous band 2", 0, 40, 240, 20, {ramwrc}, 1);
+    // Same columns, not contiguous: RASET and RAMWR
+    TestDraw("same columns", 0, 100, 240, 20, {raset, ramwr}, 3);
+    // Other columns
+    TestDraw("other columns", 10, 200, 100, 10, {caset, raset, ramwr}, 5);
+    TestDraw("other columns, contiguous", 10, 210, 100, 10, {ramwrc}, 1);
+    TestEmptyDraw();
+    // The address window of the empty area is not reused
+    TestDraw("after empty area", 0, 231, 240, 4, {caset, raset, ramwr}, 5);
+    completed = true;
+  }
+}
+
+int main() {
+  for (size_t nbPixels : {1, 2, 3, 4, 5, 239, 240, 240 * 4 + 1, 240 * 4 * 2}) {
+    Test(nbPixels);
+  }
+  Check(St7789::BufferSize(240, St7789::PixelFormats::Rgb565) == 480, 240, "wrong RGB565 buffer size");
+
+  spim.Connect(pinLcdCsn, panel);
+  xTaskCreate(RunDrawTests, "draw", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+  vTaskStartScheduler();
+  CheckDraw("draw", completed, "the test task is blocked forever");
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
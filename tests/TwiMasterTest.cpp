@@ -0,0 +1,217 @@
+// Host test of the TwiMaster transactions, against the emulated TWIM (tests/emulation): checks the shortcuts used for
+// the register reads and writes, the data on the bus, that each transaction raises a single interrupt, the queue of
+// asynchronous transactions and the recovery after a device does not answer.
+// The CPU cycles of the statistics of TwiMaster only count the time the CPU waits for the TWIM (the code itself runs
+// in zero emulated time): they must be 0, where the polling driver spent the whole transaction on the bus.
+#include "drivers/TwiMaster.h"
+#include <task.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "emulation/Twim.h"
+
+using namespace Pinetime::Drivers;
+
+namespace {
+  int failures = 0;
+
+  void Check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+      std::printf("FAIL %s: %s\n", test, what);
+      failures++;
+    }
+  }
+
+  // Same as main.cpp
+  TwiMaster twiMaster {NRF_TWIM1, 0x06200000, 6, 7};
+
+  void TwimIrqHandler() {
+    twiMaster.OnInterrupt();
+  }
+
+  Emulation::Twim twim {*NRF_TWIM1, TwimIrqHandler};
+  constexpr uint8_t deviceAddress = 0x15;
+  constexpr uint8_t absentAddress = 0x30;
+  Emulation::RegisterDevice device;
+  bool completed = false;
+
+  constexpr uint32_t readShorts = TWIM_SHORTS_LASTTX_STARTRX_Msk | TWIM_SHORTS_LASTRX_STOP_Msk;
+  constexpr uint32_t writeShorts = TWIM_SHORTS_LASTTX_STOP_Msk;
+
+  void TestInit() {
+    const char* test = "init";
+    Check(NRF_TWIM1->INTEN == (TWIM_INTEN_STOPPED_Msk | TWIM_INTEN_ERROR_Msk), test, "interrupts other than STOPPED and ERROR");
+    Check(NRF_TWIM1->ENABLE == TWIM_ENABLE_ENABLE_Disabled, test, "TWIM enabled without transaction");
+  }
+
+  void TestRead(const char* test, uint8_t registerAddress, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      device.registers[registerAddress + i] = static_cast<uint8_t>(registerAddress * 3 + i);
+    }
+    std::vector<uint8_t> data(size);
+    twim.Reset();
+    auto before = twiMaster.GetStatistics();
+
+    Check(twiMaster.Read(deviceAddress, registerAddress, data.data(), size) == TwiMaster::ErrorCodes::NoError, test, "read failed");
+
+    const auto& after = twiMaster.GetStatistics();
+    bool dataOk = true;
+    for (size_t i = 0; i < size; i++) {
+      dataOk = dataOk && data[i] == static_cast<uint8_t>(registerAddress * 3 + i);
+    }
+    Check(dataOk, test, "wrong data received");
+    Check(twim.transactions.size() == 1, test, "not a single bus transaction");
+    if (!twim.transactions.empty()) {
+      const auto& transaction = twim.transactions[0];
+      Check(transaction.address == deviceAddress, test, "wrong device address");
+      Check(transaction.written == std::vector<uint8_t> {registerAddress}, test, "register address not sent alone");
+      Check(transaction.read == size, test, "wrong number of bytes received");
+      Check(transaction.shorts == readShorts, test, "not the LASTTX_STARTRX and LASTRX_STOP shortcuts");
+    }
+    Check(twim.interrupts == 1 && after.interrupts - before.interrupts == 1, test, "not a single interrupt");
+    Check(after.transactions - before.transactions == 1, test, "transaction not counted");
+    Check(after.cpuCycles == before.cpuCycles, test, "the CPU waits for the TWIM");
+    Check(NRF_TWIM1->ENABLE == TWIM_ENABLE_ENABLE_Disabled, test, "TWIM still enabled");
+    std::printf("%s: %zu bytes, %zu transaction, %u interrupt, bus %lu cycles, CPU waiting %u cycles\n",
+                test,
+                size,
+                twim.transactions.size(),
+                twim.interrupts,
+                static_cast<unsigned long>(twim.BusyCycles()),
+                after.cpuCycles - before.cpuCycles);
+  }
+
+  void TestWrite(const char* test, uint8_t registerAddress, const std::vector<uint8_t>& data) {
+    twim.Reset();
+    auto before = twiMaster.GetStatistics();
+
+    Check(twiMaster.Write(deviceAddress, registerAddress, data.data(), data.size()) == TwiMaster::ErrorCodes::NoError,
+          test,
+          "write failed");
+
+    const auto& after = twiMaster.GetStatistics();
+    bool dataOk = true;
+    for (size_t i = 0; i < data.size(); i++) {
+      dataOk = dataOk && device.registers[registerAddress + i] == data[i];
+    }
+    Check(dataOk, test, "registers not written");
+    Check(twim.transactions.size() == 1, test, "not a single bus transaction");
+    if (!twim.transactions.empty()) {
+      const auto& transaction = twim.transactions[0];
+      std::vector<uint8_t> expected {registerAddress};
+      expected.insert(expected.end(), data.begin(), data.end());
+      Check(transaction.written == expected, test, "wrong bytes sent");
+      Check(transaction.read == 0, test, "bytes received");
+      Check(transaction.shorts == writeShorts, test, "not the LASTTX_STOP shortcut");
+    }
+    Check(twim.interrupts == 1 && after.interrupts - before.interrupts == 1, test, "not a single interrupt");
+    Check(after.cpuCycles == before.cpuCycles, test, "the CPU waits for the TWIM");
+    Check(NRF_TWIM1->ENABLE == TWIM_ENABLE_ENABLE_Disabled, test, "TWIM still enabled");
+    std::printf("%s: %zu bytes, %zu transaction, %u interrupt, bus %lu cycles\n",
+                test,
+                data.size(),
+                twim.transactions.size(),
+                twim.interrupts,
+                static_cast<unsigned long>(twim.BusyCycles()));
+  }
+
+  // A full queue of reads, submitted at once: they run back to back, in order, with one interrupt each
+  void TestQueue() {
+    const char* test = "queue";
+    constexpr size_t nbTransactions = 8;
+    TwiMaster::Transaction transactions[nbTransactions + 1];
+    uint8_t data[nbTransactions][6];
+    uint32_t nbCompleted = 0;
+    auto onCompleted = [](void* context) {
+      (*static_cast<uint32_t*>(context))++;
+    };
+    for (uint8_t i = 0; i < 64; i++) {
+      device.registers[i] = i;
+    }
+    twim.Reset();
+    auto before = twiMaster.GetStatistics();
+
+    for (size_t i = 0; i < nbTransactions; i++) {
+      Check(twiMaster.ReadAsync(transactions[i], deviceAddress, i * 6, data[i], 6, onCompleted, &nbCompleted), test, "not queued");
+    }
+    Check(!twiMaster.ReadAsync(transactions[nbTransactions], deviceAddress, 0, data[0], 6, onCompleted, &nbCompleted),
+          test,
+          "queued in a full queue");
+    Check(nbCompleted == 0, test, "completed before the bus transaction");
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    const auto& after = twiMaster.GetStatistics();
+    Check(nbCompleted == nbTransactions, test, "transactions not completed");
+    bool dataOk = true;
+    for (size_t i = 0; i < nbTransactions; i++) {
+      dataOk = dataOk && !transactions[i].pending && transactions[i].result == TwiMaster::ErrorCodes::NoError;
+      for (size_t j = 0; j < 6; j++) {
+        dataOk = dataOk && data[i][j] == i * 6 + j;
+      }
+    }
+    Check(dataOk, test, "wrong data received");
+    Check(twim.transactions.size() == nbTransactions, test, "wrong number of bus transactions");
+    uint64_t maxGap = 0;
+    for (size_t i = 0; i < twim.transactions.size(); i++) {
+      Check(twim.transactions[i].written == std::vector<uint8_t> {static_cast<uint8_t>(i * 6)}, test, "transactions out of order");
+      if (i > 0) {
+        maxGap = std::max(maxGap, twim.transactions[i].startTime - twim.transactions[i - 1].endTime);
+      }
+    }
+    Check(maxGap < Emulation::Twim::cyclesPerByte, test, "the bus is idle between the queued transactions");
+    Check(twim.interrupts == nbTransactions, test, "not one interrupt per transaction");
+    Check(after.maxPending == nbTransactions, test, "maximum number of pending transactions");
+    Check(after.cpuCycles == before.cpuCycles, test, "the CPU waits for the TWIM");
+    std::printf("%s: %zu reads, %u interrupts, bus %lu cycles, max %lu cycles between the transactions\n",
+                test,
+                nbTransactions,
+                twim.interrupts,
+                static_cast<unsigned long>(twim.BusyCycles()),
+                static_cast<unsigned long>(maxGap));
+  }
+
+  // The address is not acknowledged: the transaction fails and the bus is released for the next one
+  void TestNack() {
+    const char* test = "nack";
+    uint8_t data[2];
+    twim.Reset();
+    auto before = twiMaster.GetStatistics();
+
+    Check(twiMaster.Read(absentAddress, 0, data, 2) == TwiMaster::ErrorCodes::TransactionFailed, test, "read did not fail");
+    const auto& after = twiMaster.GetStatistics();
+    Check(after.errors - before.errors == 1, test, "error not counted");
+    Check(after.timeouts == before.timeouts, test, "timed out instead of failing");
+    Check(twim.transactions.size() == 1 && twim.transactions[0].nack, test, "wrong bus transaction");
+    Check(twim.interrupts <= 2, test, "more than the ERROR and STOPPED interrupts");
+    Check(NRF_TWIM1->ENABLE == TWIM_ENABLE_ENABLE_Disabled, test, "TWIM still enabled");
+
+    TestRead("read after nack", 0x10, 2);
+  }
+
+  void RunTests(void* /*parameters*/) {
+    twiMaster.Init();
+    TestInit();
+    // A touch event of the Cst816S, a sample of the Bma421 and a single register
+    TestRead("read", 0x01, 6);
+    TestRead("read 1 byte", 0xa7, 1);
+    TestWrite("write", 0xec, {0x01, 0x02, 0x03});
+    TestWrite("write 1 byte", 0xfa, {0x71});
+    TestQueue();
+    TestNack();
+    completed = true;
+    vTaskDelete(nullptr);
+  }
+}
+
+int main() {
+  twim.Connect(deviceAddress, device);
+  xTaskCreate(RunTests, "tests", configMINIMAL_STACK_SIZE, nullptr, 1, nullptr);
+  vTaskStartScheduler();
+  Check(completed, "tests", "the test task is blocked forever");
+
+  if (failures == 0) {
+    std::printf("OK\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
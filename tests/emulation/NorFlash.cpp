@@ -0,0 +1,92 @@
+#include "NorFlash.h"
+#include <algorithm>
+
+using namespace Emulation;
+
+namespace {
+  constexpr uint8_t pageProgram = 0x02;
+  constexpr uint8_t read = 0x03;
+  constexpr uint8_t readStatusRegister = 0x05;
+  constexpr uint8_t writeEnable = 0x06;
+  constexpr uint8_t sectorErase = 0x20;
+  constexpr uint8_t readIdentification = 0x9f;
+
+  constexpr uint8_t identification[] = {0x0b, 0x40, 0x16};
+}
+
+NorFlash::NorFlash() : memory(size, 0xff) {
+}
+
+bool NorFlash::Busy() const {
+  return HostStubs::Now() < busyUntil;
+}
+
+void NorFlash::Select() {
+  position = 0;
+  address = 0;
+  pageData.clear();
+}
+
+uint8_t NorFlash::Exchange(uint8_t mosi) {
+  uint32_t index = position++;
+  if (index == 0) {
+    command = mosi;
+    return 0xff;
+  }
+  // 24 bits address after the command
+  bool addressed = command == read || command == pageProgram || command == sectorErase;
+  if (addressed && index <= 3) {
+    address = (address << 8) | mosi;
+    return 0xff;
+  }
+
+  switch (command) {
+    case read:
+      if (Busy()) {
+        return 0xff;
+      }
+      bytesRead++;
+      return memory[address++ % size];
+    case pageProgram:
+      pageData.push_back(mosi);
+      return 0xff;
+    case readStatusRegister:
+      return static_cast<uint8_t>((Busy() ? 0x01 : 0) | (writeEnabled ? 0x02 : 0));
+    case readIdentification:
+      return index <= sizeof(identification) ? identification[index - 1] : 0xff;
+    default:
+      return 0xff;
+  }
+}
+
+void NorFlash::Deselect() {
+  if (position == 0 || Busy()) {
+    return;
+  }
+  switch (command) {
+    case writeEnable:
+      writeEnabled = true;
+      break;
+    case pageProgram:
+      if (writeEnabled && position >= 4) {
+        // The address wraps around in the page, the bits can only be cleared
+        for (size_t i = 0; i < pageData.size(); i++) {
+          uint32_t byteAddress = (address & ~(pageSize - 1)) + ((address + i) % pageSize);
+          memory[byteAddress % size] &= pageData[i];
+        }
+        writeEnabled = false;
+        busyUntil = HostStubs::Now() + pageProgramCycles;
+      }
+      break;
+    case sectorErase:
+      if (writeEnabled && position == 4) {
+        uint32_t sector = (address % size) & ~(sectorSize - 1);
+        std::fill(memory.begin() + sector, memory.begin() + sector + sectorSize, 0xff);
+        writeEnabled = false;
+        busyUntil = HostStubs::Now() + sectorEraseCycles;
+      }
+      break;
+    default:
+      break;
+  }
+}
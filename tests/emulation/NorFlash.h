@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Spim.h"
+
+namespace Emulation {
+  // 4MB SPI NOR flash (XT25F32B): identification, status, read, page program and sector erase. The programs and
+  // erases are done when CS is released, and keep the flash busy for a fixed time.
+  class NorFlash : public SpiDevice {
+  public:
+    static constexpr size_t size = 4 * 1024 * 1024;
+    static constexpr size_t pageSize = 256;
+    static constexpr size_t sectorSize = 4096;
+    static constexpr uint64_t pageProgramCycles = HostStubs::cpuFrequency / 1000;
+    static constexpr uint64_t sectorEraseCycles = HostStubs::cpuFrequency / 1000 * 50;
+
+    NorFlash();
+
+    void Select() override;
+    void Deselect() override;
+    uint8_t Exchange(uint8_t mosi) override;
+
+    std::vector<uint8_t> memory;
+    // Bytes read with the Read command
+    uint32_t bytesRead = 0;
+
+  private:
+    bool Busy() const;
+
+    uint8_t command = 0;
+    uint32_t position = 0;
+    uint32_t address = 0;
+    std::vector<uint8_t> pageData;
+    bool writeEnabled = false;
+    uint64_t busyUntil = 0;
+  };
+}
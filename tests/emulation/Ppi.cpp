@@ -0,0 +1,60 @@
+#include "Ppi.h"
+#include <map>
+#include <vector>
+
+using namespace Emulation;
+
+namespace {
+  std::map<uint32_t, HostStubs::TaskRegister*>& Tasks() {
+    static std::map<uint32_t, HostStubs::TaskRegister*> tasks;
+    return tasks;
+  }
+
+  void ConnectGroups() {
+    static bool connected = false;
+    if (connected) {
+      return;
+    }
+    connected = true;
+    for (uint32_t group = 0; group < 6; group++) {
+      auto* context = reinterpret_cast<void*>(static_cast<uintptr_t>(group));
+      Ppi::Connect(
+        NRF_PPI->TASKS_CHG[group].EN,
+        [](void* context) {
+          NRF_PPI->CHEN |= NRF_PPI->CHG[reinterpret_cast<uintptr_t>(context)];
+        },
+        context);
+      Ppi::Connect(
+        NRF_PPI->TASKS_CHG[group].DIS,
+        [](void* context) {
+          NRF_PPI->CHEN &= ~NRF_PPI->CHG[reinterpret_cast<uintptr_t>(context)];
+        },
+        context);
+    }
+  }
+}
+
+void Ppi::Connect(HostStubs::TaskRegister& task, void (*onTrigger)(void* context), void* context) {
+  task.onTrigger = onTrigger;
+  task.context = context;
+  Tasks()[HostStubs::Address(&task)] = &task;
+}
+
+void Ppi::Event(const volatile void* event) {
+  ConnectGroups();
+  auto eventAddress = HostStubs::Address(event);
+
+  // The channels triggered by the event are those enabled when it happens, even if one of the tasks changes them
+  std::vector<HostStubs::TaskRegister*> triggered;
+  for (uint8_t channel = 0; channel < 20; channel++) {
+    if ((NRF_PPI->CHEN & (1U << channel)) != 0 && NRF_PPI->CH[channel].EEP == eventAddress) {
+      auto task = Tasks().find(NRF_PPI->CH[channel].TEP);
+      if (task != Tasks().end()) {
+        triggered.push_back(task->second);
+      }
+    }
+  }
+  for (auto* task : triggered) {
+    *task = 1;
+  }
+}
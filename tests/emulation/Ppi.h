@@ -0,0 +1,12 @@
+#pragma once
+#include <nrf.h>
+
+namespace Emulation {
+  // PPI: the events raised by the emulated peripherals trigger the tasks of the enabled channels. The groups can be
+  // enabled and disabled through their tasks.
+  namespace Ppi {
+    // Makes a task reachable from the channels
+    void Connect(HostStubs::TaskRegister& task, void (*onTrigger)(void* context), void* context);
+    void Event(const volatile void* event);
+  }
+}
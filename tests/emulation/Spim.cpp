@@ -0,0 +1,152 @@
+#include "Spim.h"
+#include "Ppi.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Emulation;
+
+Spim::Spim(NRF_SPIM_Type& registers, void (*irqHandler)()) : registers {registers}, irqHandler {irqHandler} {
+  Ppi::Connect(
+    registers.TASKS_START,
+    [](void* context) {
+      static_cast<Spim*>(context)->Start();
+    },
+    this);
+  Ppi::Connect(
+    registers.TASKS_STOP,
+    [](void* context) {
+      static_cast<Spim*>(context)->Stop();
+    },
+    this);
+}
+
+void Spim::Connect(uint8_t pinCsn, SpiDevice& device) {
+  connections.push_back({pinCsn, &device});
+  HostStubs::gpioLevels[pinCsn] = true;
+  HostStubs::WatchPin(
+    pinCsn,
+    [](void* context, uint32_t /*pin*/, bool level) {
+      auto* device = static_cast<SpiDevice*>(context);
+      if (level) {
+        device->Deselect();
+      } else {
+        device->Select();
+      }
+    },
+    &device);
+}
+
+void Spim::Reset() {
+  transactions.clear();
+  interrupts = 0;
+}
+
+Spim::Connection* Spim::Selected() {
+  Connection* selected = nullptr;
+  for (auto& connection : connections) {
+    if (!HostStubs::gpioLevels[connection.pinCsn]) {
+      if (selected != nullptr) {
+        std::printf("SPIM: several devices are selected\n");
+        std::abort();
+      }
+      selected = &connection;
+    }
+  }
+  return selected;
+}
+
+void Spim::Start() {
+  if (registers.ENABLE != SPIM_ENABLE_ENABLE_Enabled) {
+    return;
+  }
+  if (busy) {
+    std::printf("SPIM: START while a transaction is in progress\n");
+    std::abort();
+  }
+  busy = true;
+  stopRequested = false;
+  // The DMA pointers and sizes are latched by START: the next transaction can be prepared while this one runs
+  txd = registers.TXD;
+  rxd = registers.RXD;
+
+  uint64_t startTime = HostStubs::Now() + startLatency;
+  uint64_t size = std::max(txd.MAXCNT, rxd.MAXCNT);
+  HostStubs::At(startTime, [this]() {
+    registers.EVENTS_STARTED = 1;
+    Ppi::Event(&registers.EVENTS_STARTED);
+    UpdateInterrupt();
+  });
+  HostStubs::At(startTime + size * cyclesPerByte, [this]() {
+    End();
+  });
+}
+
+void Spim::Stop() {
+  if (busy) {
+    stopRequested = true;
+    return;
+  }
+  HostStubs::At(HostStubs::Now() + startLatency, [this]() {
+    registers.EVENTS_STOPPED = 1;
+    UpdateInterrupt();
+  });
+}
+
+void Spim::End() {
+  auto* selected = Selected();
+  Transaction transaction {selected != nullptr ? selected->pinCsn : uint8_t(0xff), {}, rxd.MAXCNT, 0, HostStubs::Now()};
+  uint32_t size = std::max(txd.MAXCNT, rxd.MAXCNT);
+  transaction.startTime = transaction.endTime - size * cyclesPerByte;
+  for (uint32_t i = 0; i < size; i++) {
+    // Over-read character once the TX buffer is exhausted
+    uint8_t mosi = i < txd.MAXCNT ? HostStubs::Pointer(txd.PTR)[i] : static_cast<uint8_t>(registers.ORC);
+    uint8_t miso = selected != nullptr ? selected->device->Exchange(mosi) : 0xff;
+    if (i < txd.MAXCNT) {
+      transaction.sent.push_back(mosi);
+    }
+    if (i < rxd.MAXCNT) {
+      HostStubs::Pointer(rxd.PTR)[i] = miso;
+    }
+  }
+  transactions.push_back(std::move(transaction));
+
+  registers.TXD.AMOUNT = txd.MAXCNT;
+  registers.RXD.AMOUNT = rxd.MAXCNT;
+  if (txd.LIST == SPIM_TXD_LIST_LIST_ArrayList) {
+    registers.TXD.PTR = txd.PTR + txd.MAXCNT;
+  }
+  if (rxd.LIST == SPIM_TXD_LIST_LIST_ArrayList) {
+    registers.RXD.PTR = rxd.PTR + rxd.MAXCNT;
+  }
+  busy = false;
+
+  registers.EVENTS_ENDTX = 1;
+  registers.EVENTS_ENDRX = 1;
+  registers.EVENTS_END = 1;
+  Ppi::Event(&registers.EVENTS_ENDTX);
+  Ppi::Event(&registers.EVENTS_ENDRX);
+  Ppi::Event(&registers.EVENTS_END);
+  if (stopRequested) {
+    stopRequested = false;
+    registers.EVENTS_STOPPED = 1;
+  }
+  UpdateInterrupt();
+}
+
+void Spim::UpdateInterrupt() {
+  // The interrupt line stays up as long as an enabled event is set
+  for (int i = 0; i < 8; i++) {
+    uint32_t pending = (registers.EVENTS_STOPPED.value != 0 ? (1U << 1) : 0) |
+                       (registers.EVENTS_ENDRX.value != 0 ? (1U << 4) : 0) |
+                       (registers.EVENTS_END.value != 0 ? (1U << 6) : 0) |
+                       (registers.EVENTS_ENDTX.value != 0 ? (1U << 8) : 0) |
+                       (registers.EVENTS_STARTED.value != 0 ? (1U << 19) : 0);
+    if ((registers.INTEN & pending) == 0) {
+      return;
+    }
+    interrupts++;
+    HostStubs::Interrupt(irqHandler);
+  }
+  std::printf("SPIM: the interrupt handler does not clear the events\n");
+  std::abort();
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <nrf.h>
+#include <cstdint>
+#include <vector>
+
+namespace Emulation {
+  // A device on the SPI bus, selected by its chip select pin (active low)
+  class SpiDevice {
+  public:
+    virtual ~SpiDevice() = default;
+    virtual void Select() {
+    }
+    virtual void Deselect() {
+    }
+    // Receives a byte from the master and returns the byte it sends back
+    virtual uint8_t Exchange(uint8_t mosi) = 0;
+  };
+
+  // SPIM with EasyDMA, at 8MHz. Each START runs one DMA transaction: STARTED is raised right away, END once all the
+  // bytes have been clocked out. The bytes are exchanged with the selected device when the transaction ends.
+  class Spim {
+  public:
+    static constexpr uint64_t cyclesPerByte = HostStubs::cpuFrequency / 8000000 * 8;
+
+    struct Transaction {
+      uint8_t pinCsn;
+      std::vector<uint8_t> sent;
+      size_t received;
+      uint64_t startTime;
+      uint64_t endTime;
+    };
+
+    Spim(NRF_SPIM_Type& registers, void (*irqHandler)());
+
+    void Connect(uint8_t pinCsn, SpiDevice& device);
+    void Reset();
+
+    std::vector<Transaction> transactions;
+    uint32_t interrupts = 0;
+
+  private:
+    struct Connection {
+      uint8_t pinCsn;
+      SpiDevice* device;
+    };
+
+    void Start();
+    void Stop();
+    void End();
+    void UpdateInterrupt();
+    Connection* Selected();
+
+    static constexpr uint64_t startLatency = 4;
+    NRF_SPIM_Type& registers;
+    void (*irqHandler)();
+    std::vector<Connection> connections;
+    bool busy = false;
+    bool stopRequested = false;
+    HostStubs::EasyDmaChannel txd;
+    HostStubs::EasyDmaChannel rxd;
+  };
+}
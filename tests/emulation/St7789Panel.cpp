@@ -0,0 +1,147 @@
+#include "St7789Panel.h"
+#include <cstdio>
+
+using namespace Emulation;
+
+namespace {
+  constexpr uint8_t columnAddressSet = 0x2a;
+  constexpr uint8_t rowAddressSet = 0x2b;
+  constexpr uint8_t writeToRam = 0x2c;
+  constexpr uint8_t verticalScrollDefinition = 0x33;
+  constexpr uint8_t verticalScrollStartAddress = 0x37;
+  constexpr uint8_t colMod = 0x3a;
+  constexpr uint8_t writeToRamContinue = 0x3c;
+
+  constexpr uint8_t rgb444 = 0x53;
+
+  uint16_t Rgb444ToRgb565(uint16_t pixel) {
+    return static_cast<uint16_t>(((pixel & 0xf00) << 4) | ((pixel & 0x0f0) << 3) | ((pixel & 0x00f) << 1));
+  }
+
+  uint16_t Word(const std::vector<uint8_t>& parameters, size_t index) {
+    return static_cast<uint16_t>((parameters[index] << 8) | parameters[index + 1]);
+  }
+}
+
+St7789Panel::St7789Panel(uint8_t pinDataCommand) : pinDataCommand {pinDataCommand}, frameMemory(width * height) {
+}
+
+void St7789Panel::Select() {
+  // The bits of an incomplete pixel are dropped when CS is released
+  pixelBytes = 0;
+}
+
+uint8_t St7789Panel::Exchange(uint8_t mosi) {
+  if (!HostStubs::gpioLevels[pinDataCommand]) {
+    Command(mosi);
+  } else {
+    Parameter(mosi);
+  }
+  return 0;
+}
+
+void St7789Panel::Command(uint8_t newCommand) {
+  command = newCommand;
+  commands.push_back(command);
+  parameters.clear();
+  pixelBytes = 0;
+  switch (command) {
+    case writeToRam:
+      x = columnStart;
+      y = rowStart;
+      break;
+    default:
+      break;
+  }
+}
+
+void St7789Panel::Parameter(uint8_t parameter) {
+  if (command == writeToRam || command == writeToRamContinue) {
+    pixelData[pixelBytes++] = parameter;
+    if (pixelFormat == rgb444) {
+      // 2 pixels in 3 bytes, each one is written once its 12 bits are received. The 4 bits components are expanded
+      // to the RGB565 of the frame memory.
+      if (pixelBytes == 2) {
+        WritePixel(Rgb444ToRgb565(static_cast<uint16_t>((pixelData[0] << 4) | (pixelData[1] >> 4))));
+      } else if (pixelBytes == 3) {
+        WritePixel(Rgb444ToRgb565(static_cast<uint16_t>(((pixelData[1] & 0x0f) << 8) | pixelData[2])));
+        pixelBytes = 0;
+      }
+    } else if (pixelBytes == 2) {
+      WritePixel(static_cast<uint16_t>((pixelData[0] << 8) | pixelData[1]));
+      pixelBytes = 0;
+    }
+    return;
+  }
+
+  parameters.push_back(parameter);
+  switch (command) {
+    case columnAddressSet:
+      if (parameters.size() == 4) {
+        columnStart = Word(parameters, 0);
+        columnEnd = Word(parameters, 2);
+      }
+      break;
+    case rowAddressSet:
+      if (parameters.size() == 4) {
+        rowStart = Word(parameters, 0);
+        rowEnd = Word(parameters, 2);
+      }
+      break;
+    case colMod:
+      pixelFormat = parameter;
+      break;
+    case verticalScrollDefinition:
+      if (parameters.size() == 6) {
+        topFixedLines = Word(parameters, 0);
+        scrollLines = Word(parameters, 2);
+      }
+      break;
+    case verticalScrollStartAddress:
+      if (parameters.size() == 2) {
+        scrollStart = Word(parameters, 0);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void St7789Panel::WritePixel(uint16_t rgb565) {
+  if (x < width && y < height) {
+    frameMemory[y * width + x] = rgb565;
+  }
+  if (pixelsWritten == 0) {
+    firstPixelTime = HostStubs::Now();
+  }
+  lastPixelTime = HostStubs::Now();
+  pixelsWritten++;
+  if (x < columnEnd) {
+    x++;
+    return;
+  }
+  x = columnStart;
+  y = (y < rowEnd) ? y + 1 : rowStart;
+}
+
+bool St7789Panel::Dump(const char* path) const {
+  FILE* file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  std::fprintf(file, "P6\n%u %u\n255\n", width, height);
+  for (uint16_t row = 0; row < height; row++) {
+    uint16_t memoryRow = row;
+    if (row >= topFixedLines && row < topFixedLines + scrollLines) {
+      memoryRow = topFixedLines + (row - topFixedLines + scrollStart - topFixedLines + scrollLines) % scrollLines;
+    }
+    for (uint16_t column = 0; column < width; column++) {
+      uint16_t pixel = Pixel(column, memoryRow);
+      uint8_t rgb[] = {static_cast<uint8_t>((pixel >> 11) << 3),
+                       static_cast<uint8_t>(((pixel >> 5) & 0x3f) << 2),
+                       static_cast<uint8_t>((pixel & 0x1f) << 3)};
+      std::fwrite(rgb, sizeof(rgb), 1, file);
+    }
+  }
+  return std::fclose(file) == 0;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Spim.h"
+
+namespace Emulation {
+  // ST7789 controller of a 240x320 panel, on the SPI bus with a D/C pin. Decodes the commands used by the driver
+  // and writes the pixels in a RGB565 frame memory.
+  class St7789Panel : public SpiDevice {
+  public:
+    static constexpr uint16_t width = 240;
+    static constexpr uint16_t height = 320;
+
+    explicit St7789Panel(uint8_t pinDataCommand);
+
+    void Select() override;
+    uint8_t Exchange(uint8_t mosi) override;
+
+    uint16_t Pixel(uint16_t x, uint16_t y) const {
+      return frameMemory[y * width + x];
+    }
+    // Writes the frame memory as a binary PPM image, as the panel shows it (with the vertical scrolling)
+    bool Dump(const char* path) const;
+
+    // Commands received, in order
+    std::vector<uint8_t> commands;
+    uint32_t pixelsWritten = 0;
+    // Emulated time of the first pixel written since pixelsWritten was reset, and of the last one
+    uint64_t firstPixelTime = 0;
+    uint64_t lastPixelTime = 0;
+
+  private:
+    void Command(uint8_t command);
+    void Parameter(uint8_t parameter);
+    void WritePixel(uint16_t rgb565);
+
+    uint8_t pinDataCommand;
+    std::vector<uint16_t> frameMemory;
+    uint8_t command = 0;
+    std::vector<uint8_t> parameters;
+    uint8_t pixelFormat = 0x66;
+    uint16_t columnStart = 0;
+    uint16_t columnEnd = width - 1;
+    uint16_t rowStart = 0;
+    uint16_t rowEnd = height - 1;
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint32_t pixelBytes = 0;
+    uint8_t pixelData[3];
+    uint16_t topFixedLines = 0;
+    uint16_t scrollLines = height;
+    uint16_t scrollStart = 0;
+  };
+}
@@ -0,0 +1,62 @@
+#include "Timer.h"
+#include "Ppi.h"
+
+using namespace Emulation;
+
+Timer::Timer(NRF_TIMER_Type& registers, void (*irqHandler)()) : registers {registers}, irqHandler {irqHandler} {
+  Ppi::Connect(
+    registers.TASKS_START,
+    [](void* context) {
+      static_cast<Timer*>(context)->running = true;
+    },
+    this);
+  Ppi::Connect(
+    registers.TASKS_STOP,
+    [](void* context) {
+      static_cast<Timer*>(context)->running = false;
+    },
+    this);
+  Ppi::Connect(
+    registers.TASKS_CLEAR,
+    [](void* context) {
+      static_cast<Timer*>(context)->counter = 0;
+    },
+    this);
+  Ppi::Connect(
+    registers.TASKS_COUNT,
+    [](void* context) {
+      static_cast<Timer*>(context)->Count();
+    },
+    this);
+}
+
+void Timer::Count() {
+  if (!running || registers.MODE != TIMER_MODE_MODE_Counter) {
+    return;
+  }
+  counter = (counter + 1) & 0xffff;
+  for (uint8_t i = 0; i < 6; i++) {
+    if (counter != registers.CC[i]) {
+      continue;
+    }
+    registers.EVENTS_COMPARE[i] = 1;
+    Ppi::Event(&registers.EVENTS_COMPARE[i]);
+    if ((registers.SHORTS & (TIMER_SHORTS_COMPARE0_CLEAR_Msk << i)) != 0) {
+      counter = 0;
+    }
+    if ((registers.SHORTS & (TIMER_SHORTS_COMPARE0_STOP_Msk << i)) != 0) {
+      running = false;
+    }
+  }
+  UpdateInterrupt();
+}
+
+void Timer::UpdateInterrupt() {
+  for (uint8_t i = 0; i < 6; i++) {
+    if ((registers.INTEN & (TIMER_INTENSET_COMPARE0_Msk << i)) != 0 && registers.EVENTS_COMPARE[i].value != 0) {
+      interrupts++;
+      HostStubs::Interrupt(irqHandler);
+      return;
+    }
+  }
+}
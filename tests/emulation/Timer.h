@@ -0,0 +1,21 @@
+#pragma once
+#include <nrf.h>
+
+namespace Emulation {
+  // TIMER in counter mode, incremented by its COUNT task
+  class Timer {
+  public:
+    Timer(NRF_TIMER_Type& registers, void (*irqHandler)());
+
+    uint32_t interrupts = 0;
+
+  private:
+    void Count();
+    void UpdateInterrupt();
+
+    NRF_TIMER_Type& registers;
+    void (*irqHandler)();
+    bool running = false;
+    uint32_t counter = 0;
+  };
+}
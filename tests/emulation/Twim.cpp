@@ -0,0 +1,181 @@
+#include "Twim.h"
+#include "Ppi.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Emulation;
+
+void RegisterDevice::Write(const uint8_t* data, size_t size) {
+  if (size == 0) {
+    return;
+  }
+  address = data[0];
+  for (size_t i = 1; i < size; i++) {
+    registers[address++] = data[i];
+  }
+}
+
+void RegisterDevice::Read(uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    data[i] = registers[address++];
+  }
+}
+
+Twim::Twim(NRF_TWIM_Type& registers, void (*irqHandler)()) : registers {registers}, irqHandler {irqHandler} {
+  Ppi::Connect(
+    registers.TASKS_STARTTX,
+    [](void* context) {
+      static_cast<Twim*>(context)->StartTx();
+    },
+    this);
+  Ppi::Connect(
+    registers.TASKS_STARTRX,
+    [](void* context) {
+      static_cast<Twim*>(context)->StartRx();
+    },
+    this);
+  Ppi::Connect(
+    registers.TASKS_STOP,
+    [](void* context) {
+      static_cast<Twim*>(context)->Stop();
+    },
+    this);
+}
+
+void Twim::Connect(uint8_t address, TwiDevice& device) {
+  connections.push_back({address, &device});
+}
+
+void Twim::Reset() {
+  transactions.clear();
+  interrupts = 0;
+}
+
+uint64_t Twim::BusyCycles() const {
+  uint64_t cycles = 0;
+  for (const auto& transaction : transactions) {
+    cycles += transaction.endTime - transaction.startTime;
+  }
+  return cycles;
+}
+
+TwiDevice* Twim::Addressed() const {
+  for (const auto& connection : connections) {
+    if (connection.address == registers.ADDRESS) {
+      return connection.device;
+    }
+  }
+  return nullptr;
+}
+
+void Twim::StartTx() {
+  if (registers.ENABLE != TWIM_ENABLE_ENABLE_Enabled) {
+    return;
+  }
+  if (busy) {
+    std::printf("TWIM: STARTTX while a transaction is in progress\n");
+    std::abort();
+  }
+  busy = true;
+  // The DMA pointers and sizes are latched by STARTTX, the shortcuts are read when their event happens
+  txd = registers.TXD;
+  rxd = registers.RXD;
+  uint64_t startTime = HostStubs::Now() + startLatency;
+  transactions.push_back(
+    {static_cast<uint8_t>(registers.ADDRESS), {}, 0, registers.SHORTS, startTime, startTime, Addressed() == nullptr});
+
+  HostStubs::At(startTime, [this]() {
+    registers.EVENTS_TXSTARTED = 1;
+    UpdateInterrupt();
+  });
+  if (transactions.back().nack) {
+    HostStubs::At(startTime + cyclesPerByte, [this]() {
+      registers.ERRORSRC |= TWIM_ERRORSRC_ANACK_Msk;
+      registers.EVENTS_ERROR = 1;
+      UpdateInterrupt();
+    });
+    return;
+  }
+  HostStubs::At(startTime + (1 + txd.MAXCNT) * cyclesPerByte, [this]() {
+    LastTx();
+  });
+}
+
+void Twim::LastTx() {
+  auto& transaction = transactions.back();
+  const uint8_t* data = HostStubs::Pointer(txd.PTR);
+  transaction.written.assign(data, data + txd.MAXCNT);
+  Addressed()->Write(data, txd.MAXCNT);
+  registers.TXD.AMOUNT = txd.MAXCNT;
+  registers.EVENTS_LASTTX = 1;
+  UpdateInterrupt();
+
+  if ((registers.SHORTS & TWIM_SHORTS_LASTTX_STARTRX_Msk) != 0) {
+    StartRx();
+  } else if ((registers.SHORTS & TWIM_SHORTS_LASTTX_STOP_Msk) != 0) {
+    Stop();
+  }
+  // Otherwise the TWIM holds the bus until the STOP task
+}
+
+void Twim::StartRx() {
+  if (transactions.empty() || Addressed() == nullptr) {
+    std::printf("TWIM: STARTRX without a transaction\n");
+    std::abort();
+  }
+  rxd = registers.RXD;
+  HostStubs::At(HostStubs::Now() + startLatency, [this]() {
+    registers.EVENTS_RXSTARTED = 1;
+    UpdateInterrupt();
+  });
+  // Repeated start and address, then the data
+  HostStubs::At(HostStubs::Now() + (1 + rxd.MAXCNT) * cyclesPerByte, [this]() {
+    LastRx();
+  });
+}
+
+void Twim::LastRx() {
+  Addressed()->Read(HostStubs::Pointer(rxd.PTR), rxd.MAXCNT);
+  transactions.back().read = rxd.MAXCNT;
+  registers.RXD.AMOUNT = rxd.MAXCNT;
+  registers.EVENTS_LASTRX = 1;
+  UpdateInterrupt();
+
+  if ((registers.SHORTS & TWIM_SHORTS_LASTRX_STOP_Msk) != 0) {
+    Stop();
+  }
+  // Otherwise the TWIM holds the bus until the STOP task
+}
+
+void Twim::Stop() {
+  // Only after the last byte or an error: a STOP in the middle of a byte is not emulated
+  if (!busy) {
+    return;
+  }
+  HostStubs::At(HostStubs::Now() + stopCycles, [this]() {
+    busy = false;
+    transactions.back().endTime = HostStubs::Now();
+    registers.EVENTS_STOPPED = 1;
+    UpdateInterrupt();
+  });
+}
+
+void Twim::UpdateInterrupt() {
+  // The interrupt line stays up as long as an enabled event is set
+  for (int i = 0; i < 8; i++) {
+    uint32_t pending = (registers.EVENTS_STOPPED.value != 0 ? TWIM_INTEN_STOPPED_Msk : 0) |
+                       (registers.EVENTS_ERROR.value != 0 ? TWIM_INTEN_ERROR_Msk : 0) |
+                       (registers.EVENTS_SUSPENDED.value != 0 ? TWIM_INTEN_SUSPENDED_Msk : 0) |
+                       (registers.EVENTS_RXSTARTED.value != 0 ? TWIM_INTEN_RXSTARTED_Msk : 0) |
+                       (registers.EVENTS_TXSTARTED.value != 0 ? TWIM_INTEN_TXSTARTED_Msk : 0) |
+                       (registers.EVENTS_LASTRX.value != 0 ? TWIM_INTEN_LASTRX_Msk : 0) |
+                       (registers.EVENTS_LASTTX.value != 0 ? TWIM_INTEN_LASTTX_Msk : 0);
+    if ((registers.INTEN & pending) == 0) {
+      return;
+    }
+    interrupts++;
+    HostStubs::Interrupt(irqHandler);
+  }
+  std::printf("TWIM: the interrupt handler does not clear the events\n");
+  std::abort();
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <nrf.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Emulation {
+  // A device on the I2C bus, at a 7 bits address
+  class TwiDevice {
+  public:
+    virtual ~TwiDevice() = default;
+    // Bytes written by the master in a transaction, the register address first
+    virtual void Write(const uint8_t* data, size_t size) = 0;
+    // Bytes read by the master, after a repeated start
+    virtual void Read(uint8_t* data, size_t size) = 0;
+  };
+
+  // Device with 256 registers, whose register address is incremented at each byte written or read
+  class RegisterDevice : public TwiDevice {
+  public:
+    void Write(const uint8_t* data, size_t size) override;
+    void Read(uint8_t* data, size_t size) override;
+
+    uint8_t registers[256] = {};
+
+  private:
+    uint8_t address = 0;
+  };
+
+  // TWIM with EasyDMA, at 400KHz (9 bits per byte, including the ACK). STARTTX sends the address and TXD.MAXCNT
+  // bytes, then LASTTX is raised and the shortcuts receive RXD.MAXCNT bytes after a repeated start (LASTTX_STARTRX)
+  // and send the STOP condition (LASTTX_STOP, LASTRX_STOP). A device that does not answer raises ERROR (address
+  // NACK), and the TWIM waits for the STOP task.
+  class Twim {
+  public:
+    static constexpr uint64_t cyclesPerByte = HostStubs::cpuFrequency / 400000 * 9;
+
+    struct Transaction {
+      uint8_t address;
+      std::vector<uint8_t> written;
+      size_t read;
+      uint32_t shorts;
+      uint64_t startTime;
+      uint64_t endTime;
+      bool nack;
+    };
+
+    Twim(NRF_TWIM_Type& registers, void (*irqHandler)());
+
+    void Connect(uint8_t address, TwiDevice& device);
+    void Reset();
+    // Time the bus was busy, since the last reset
+    uint64_t BusyCycles() const;
+
+    std::vector<Transaction> transactions;
+    uint32_t interrupts = 0;
+
+  private:
+    struct Connection {
+      uint8_t address;
+      TwiDevice* device;
+    };
+
+    void StartTx();
+    void LastTx();
+    void StartRx();
+    void LastRx();
+    void Stop();
+    void UpdateInterrupt();
+    TwiDevice* Addressed() const;
+
+    static constexpr uint64_t startLatency = 4;
+    // The STOP condition, after the last byte
+    static constexpr uint64_t stopCycles = cyclesPerByte / 9;
+    NRF_TWIM_Type& registers;
+    void (*irqHandler)();
+    std::vector<Connection> connections;
+    bool busy = false;
+    HostStubs::EasyDmaChannel txd;
+    HostStubs::EasyDmaChannel rxd;
+  };
+}
@@ -0,0 +1,29 @@
+#pragma once
+// Host replacement of FreeRTOS for the tests: the tasks are coroutines that run on emulated time (see HostStubs.h).
+#include <cassert>
+#include <cstdint>
+#include <nrf.h> // Included by FreeRTOSConfig.h in the firmware
+
+using BaseType_t = long;
+using UBaseType_t = unsigned long;
+using TickType_t = uint32_t;
+using StackType_t = uint32_t;
+
+#define pdFALSE ((BaseType_t) 0)
+#define pdTRUE ((BaseType_t) 1)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+#define configTICK_RATE_HZ 1024
+#define configMAX_PRIORITIES 3
+#define configMINIMAL_STACK_SIZE 120
+#define tskIDLE_PRIORITY 0
+#define pdMS_TO_TICKS(ms) ((TickType_t) (((TickType_t) (ms) * (TickType_t) configTICK_RATE_HZ) / (TickType_t) 1000))
+#define portTICK_PERIOD_MS ((TickType_t) 1000 / configTICK_RATE_HZ)
+#define portYIELD_FROM_ISR(x) ((void) (x))
+
+#define ASSERT(expression) assert(expression)
+
+// app_error.h, included by app_util_platform.h in FreeRTOSConfig.h
+#define NRF_ERROR_NO_MEM 4
+#define APP_ERROR_HANDLER(error) assert((error) == 0)
@@ -0,0 +1,156 @@
+// Controllers::FS on files kept in memory (HostFs::files), for the host tests of the components that read the
+// filesystem. The flash driver is not used.
+#include "components/fs/FS.h"
+#include <algorithm>
+#include <cstring>
+#include "HostFs.h"
+
+using namespace Pinetime::Controllers;
+
+namespace HostFs {
+  std::map<std::string, std::vector<uint8_t>> files;
+  Statistics statistics;
+}
+
+FS::FS(Pinetime::Drivers::SpiNorFlash& driver) : flashDriver {driver}, lfsConfig {} {
+}
+
+void FS::Init() {
+}
+
+void FS::VerifyResource() {
+  resourcesValid = true;
+}
+
+void FS::LVGLFileSystemInit() {
+}
+
+int FS::FileOpen(lfs_file_t* file_p, const char* fileName, const int flags) {
+  auto file = HostFs::files.find(fileName);
+  if (file == HostFs::files.end()) {
+    if ((flags & LFS_O_CREAT) == 0) {
+      return LFS_ERR_NOENT;
+    }
+    file = HostFs::files.emplace(fileName, std::vector<uint8_t> {}).first;
+  }
+  if ((flags & LFS_O_TRUNC) != 0) {
+    file->second.clear();
+  }
+  file_p->path = fileName;
+  file_p->position = 0;
+  file_p->flags = flags;
+  return LFS_ERR_OK;
+}
+
+int FS::FileClose(lfs_file_t* file_p) {
+  file_p->path.clear();
+  return LFS_ERR_OK;
+}
+
+int FS::FileRead(lfs_file_t* file_p, uint8_t* buff, uint32_t size) {
+  auto file = HostFs::files.find(file_p->path);
+  if (file == HostFs::files.end()) {
+    return LFS_ERR_IO;
+  }
+  const auto& data = file->second;
+  uint32_t count = file_p->position < data.size() ? std::min<uint32_t>(size, data.size() - file_p->position) : 0;
+  std::memcpy(buff, data.data() + file_p->position, count);
+  file_p->position += count;
+  HostFs::statistics.reads++;
+  HostFs::statistics.bytesRead += count;
+  return static_cast<int>(count);
+}
+
+int FS::FileWrite(lfs_file_t* file_p, const uint8_t* buff, uint32_t size) {
+  auto file = HostFs::files.find(file_p->path);
+  if (file == HostFs::files.end()) {
+    return LFS_ERR_IO;
+  }
+  auto& data = file->second;
+  if (data.size() < file_p->position + size) {
+    data.resize(file_p->position + size);
+  }
+  std::memcpy(data.data() + file_p->position, buff, size);
+  file_p->position += size;
+  return static_cast<int>(size);
+}
+
+int FS::FileSeek(lfs_file_t* file_p, uint32_t pos) {
+  file_p->position = pos;
+  HostFs::statistics.seeks++;
+  return static_cast<int>(pos);
+}
+
+int FS::FileDelete(const char* fileName) {
+  return HostFs::files.erase(fileName) != 0 ? LFS_ERR_OK : LFS_ERR_NOENT;
+}
+
+int FS::DirOpen(const char* path, lfs_dir_t* lfs_dir) {
+  lfs_dir->path = path;
+  if (lfs_dir->path.empty() || lfs_dir->path.back() != '/') {
+    lfs_dir->path += '/';
+  }
+  lfs_dir->position = 0;
+  return LFS_ERR_OK;
+}
+
+int FS::DirClose(lfs_dir_t*) {
+  return LFS_ERR_OK;
+}
+
+// Only lists the files, the directories only exist through the paths of their files
+int FS::DirRead(lfs_dir_t* dir, lfs_info* info) {
+  uint32_t index = 0;
+  for (const auto& [path, data] : HostFs::files) {
+    if (path.compare(0, dir->path.size(), dir->path) != 0 || path.find('/', dir->path.size()) != std::string::npos) {
+      continue;
+    }
+    if (index++ == dir->position) {
+      dir->position++;
+      info->type = LFS_TYPE_REG;
+      info->size = data.size();
+      std::strncpy(info->name, path.c_str() + dir->path.size(), sizeof(info->name) - 1);
+      info->name[sizeof(info->name) - 1] = '\0';
+      return 1;
+    }
+  }
+  return 0;
+}
+
+int FS::DirRewind(lfs_dir_t* dir) {
+  dir->position = 0;
+  return LFS_ERR_OK;
+}
+
+int FS::DirCreate(const char*) {
+  return LFS_ERR_OK;
+}
+
+lfs_ssize_t FS::GetFSSize() {
+  lfs_ssize_t used = 0;
+  for (const auto& file : HostFs::files) {
+    used += (file.second.size() + blockSize - 1) / blockSize;
+  }
+  return used;
+}
+
+int FS::Rename(const char* oldPath, const char* newPath) {
+  auto file = HostFs::files.find(oldPath);
+  if (file == HostFs::files.end()) {
+    return LFS_ERR_NOENT;
+  }
+  auto data = std::move(file->second);
+  HostFs::files.erase(file);
+  HostFs::files[newPath] = std::move(data);
+  return LFS_ERR_OK;
+}
+
+int FS::Stat(const char* path, lfs_info* info) {
+  auto file = HostFs::files.find(path);
+  if (file == HostFs::files.end()) {
+    return LFS_ERR_NOENT;
+  }
+  info->type = LFS_TYPE_REG;
+  info->size = file->second.size();
+  return LFS_ERR_OK;
+}
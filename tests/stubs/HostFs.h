@@ -0,0 +1,18 @@
+#pragma once
+// Files of the filesystem of the host tests (stubs/Fs.cpp), by path, and the accesses to them
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace HostFs {
+  extern std::map<std::string, std::vector<uint8_t>> files;
+
+  struct Statistics {
+    uint32_t reads;
+    uint32_t bytesRead;
+    uint32_t seeks;
+  };
+
+  extern Statistics statistics;
+}
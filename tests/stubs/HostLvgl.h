@@ -0,0 +1,7 @@
+#pragma once
+// Objects of LVGL alive in the host tests (stubs/LvglObjects.cpp), including the screens
+#include <cstdint>
+
+namespace HostLvgl {
+  extern uint32_t nbObjects;
+}
@@ -0,0 +1,45 @@
+#pragma once
+// Emulated time, tasks and interrupts of the host tests.
+//
+// The FreeRTOS tasks are coroutines scheduled by priority: a task runs until it blocks (or until a task of higher
+// priority is woken up), in zero emulated time. The time only advances when all the tasks are blocked, when a task
+// polls a register of a peripheral (a spin loop), or when a test explicitly spends CPU cycles. The emulated peripherals
+// schedule their events (end of a transfer...) at a given time, and run the interrupt handlers when they happen.
+#include <cstdint>
+#include <functional>
+
+namespace HostStubs {
+  constexpr uint64_t cpuFrequency = 64000000;
+
+  // Emulated time, in CPU cycles since the beginning of the test. DWT->CYCCNT follows it.
+  uint64_t Now();
+
+  // Runs action at the given time (a hardware event)
+  void At(uint64_t time, std::function<void()> action);
+
+  // The running code spends cycles: the hardware events that happen in the meantime are run
+  void Spend(uint64_t cycles);
+
+  // Called when a register is polled and the value it waits for is not there yet: runs the next hardware event.
+  // Does nothing in an interrupt handler.
+  void WaitForEvent();
+
+  // Runs an interrupt handler now. The task woken up by the handler runs when it returns, if it has a higher
+  // priority than the interrupted task.
+  void Interrupt(void (*handler)());
+  bool InInterrupt();
+
+  // Makes vTaskStartScheduler() return, once the running task blocks or right away when called from a task
+  void StopScheduler();
+
+  // Level of the GPIOs driven by the firmware, and the emulated devices that watch them
+  extern bool gpioLevels[32];
+  using PinListener = void (*)(void* context, uint32_t pin, bool level);
+  void WatchPin(uint32_t pin, PinListener listener, void* context);
+  void SetPin(uint32_t pin, bool level);
+
+  // The 32 bits address of an object, as seen by the PPI and EasyDMA. The tests are linked without PIE so that the
+  // global data, the heap and the stacks of the tasks are in the first 4GB of the address space.
+  uint32_t Address(const volatile void* pointer);
+  uint8_t* Pointer(uint32_t address);
+}
@@ -0,0 +1,445 @@
+// Emulated time and FreeRTOS scheduler of the host tests (see HostStubs.h)
+#include <FreeRTOS.h>
+#include <queue.h>
+#include <semphr.h>
+#include <task.h>
+#include <malloc.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+struct HostTask {
+  enum class States { Ready, Blocked, Deleted };
+
+  ucontext_t context;
+  uint8_t* stack;
+  TaskFunction_t function;
+  void* parameters;
+  UBaseType_t priority;
+  const char* name;
+  States state;
+  // Object the task is blocked on, and the time at which it stops waiting for it
+  const void* waitingFor;
+  uint64_t wakeUpTime;
+  bool timedOut;
+  // Order in which the tasks of the same priority became ready
+  uint64_t readyOrder;
+  uint32_t notificationCount;
+};
+
+struct HostSemaphore {
+  UBaseType_t count;
+  UBaseType_t maxCount;
+};
+
+struct HostQueue {
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+namespace {
+  constexpr uint64_t cyclesPerTick = HostStubs::cpuFrequency / configTICK_RATE_HZ;
+  constexpr uint64_t never = UINT64_MAX;
+  // The code built for the host needs more stack than on the device
+  constexpr size_t stackSize = 256 * 1024;
+
+  uint64_t now = 0;
+  // Hardware events, by time and then by order of creation
+  std::map<std::pair<uint64_t, uint64_t>, std::function<void()>> events;
+  uint64_t nbEvents = 0;
+
+  std::vector<HostTask*> tasks;
+  HostTask* current = nullptr;
+  // Notifications sent to the code that runs outside of the tasks (before the scheduler is started)
+  HostTask mainTask {};
+  ucontext_t schedulerContext;
+  bool stopScheduler = false;
+  uint64_t nbReady = 0;
+  uint32_t interruptNesting = 0;
+
+  struct LowAddressSpaceCheck {
+    LowAddressSpaceCheck() {
+      // Allocations large enough to be mapped outside of the heap would be out of the 32 bits address space
+      mallopt(M_MMAP_THRESHOLD, 32 * 1024 * 1024);
+      void* allocation = std::malloc(16);
+      if ((reinterpret_cast<uintptr_t>(&now) >> 32) != 0 || (reinterpret_cast<uintptr_t>(allocation) >> 32) != 0) {
+        std::printf("The tests must be linked without PIE: the DMA buffers must have 32 bits addresses\n");
+        std::abort();
+      }
+      std::free(allocation);
+    }
+  } lowAddressSpaceCheck;
+
+  void SetTime(uint64_t time) {
+    now = std::max(now, time);
+    DWT->CYCCNT = static_cast<uint32_t>(now);
+  }
+
+  void MakeReady(HostTask* task) {
+    task->state = HostTask::States::Ready;
+    task->waitingFor = nullptr;
+    task->readyOrder = nbReady++;
+  }
+
+  void WakeUpTimedOut() {
+    for (auto* task : tasks) {
+      if (task->state == HostTask::States::Blocked && task->wakeUpTime <= now) {
+        MakeReady(task);
+        task->timedOut = true;
+      }
+    }
+  }
+
+  uint64_t NextDeadline() {
+    uint64_t deadline = events.empty() ? never : events.begin()->first.first;
+    for (auto* task : tasks) {
+      if (task->state == HostTask::States::Blocked) {
+        deadline = std::min(deadline, task->wakeUpTime);
+      }
+    }
+    return deadline;
+  }
+
+  // Runs the hardware events up to the given time
+  void RunUntil(uint64_t time) {
+    while (!events.empty() && events.begin()->first.first <= time) {
+      auto event = events.begin();
+      auto action = std::move(event->second);
+      SetTime(event->first.first);
+      events.erase(event);
+      action();
+    }
+    SetTime(time);
+    WakeUpTimedOut();
+  }
+
+  HostTask* HighestReady(const HostTask* except) {
+    HostTask* highest = nullptr;
+    for (auto* task : tasks) {
+      if (task != except && task->state == HostTask::States::Ready &&
+          (highest == nullptr || task->priority > highest->priority ||
+           (task->priority == highest->priority && task->readyOrder < highest->readyOrder))) {
+        highest = task;
+      }
+    }
+    return highest;
+  }
+
+  // Gives the CPU back to the scheduler, the task resumes when it is chosen again
+  void Switch() {
+    HostTask* self = current;
+    swapcontext(&self->context, &schedulerContext);
+  }
+
+  void Preempt() {
+    if (current == nullptr || interruptNesting > 0) {
+      return;
+    }
+    auto* highest = HighestReady(current);
+    if (highest != nullptr && highest->priority > current->priority) {
+      Switch();
+    }
+  }
+
+  uint64_t Deadline(TickType_t ticks) {
+    return ticks == portMAX_DELAY ? never : now + ticks * cyclesPerTick;
+  }
+
+  // Waits until object is signaled by Signal() or until the deadline. Returns false on timeout.
+  bool Block(const void* object, uint64_t deadline) {
+    if (deadline <= now) {
+      return false;
+    }
+    if (current == nullptr) {
+      // Outside of the tasks, only the hardware can signal the object
+      uint64_t next = events.empty() ? never : events.begin()->first.first;
+      if (next == never || next > deadline) {
+        RunUntil(deadline == never ? now : deadline);
+        return false;
+      }
+      RunUntil(next);
+      return true;
+    }
+
+    HostTask* self = current;
+    self->state = HostTask::States::Blocked;
+    self->waitingFor = object;
+    self->wakeUpTime = deadline;
+    self->timedOut = false;
+    Switch();
+    return !self->timedOut;
+  }
+
+  void Signal(const void* object) {
+    for (auto* task : tasks) {
+      if (task->state == HostTask::States::Blocked && task->waitingFor == object) {
+        MakeReady(task);
+      }
+    }
+    Preempt();
+  }
+
+  void RunTask() {
+    HostTask* self = current;
+    self->function(self->parameters);
+    self->state = HostTask::States::Deleted;
+    Switch();
+  }
+
+  void DeleteStoppedTasks() {
+    for (auto it = tasks.begin(); it != tasks.end();) {
+      if ((*it)->state == HostTask::States::Deleted && *it != current) {
+        munmap((*it)->stack, stackSize);
+        delete *it;
+        it = tasks.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+uint64_t HostStubs::Now() {
+  return now;
+}
+
+void HostStubs::At(uint64_t time, std::function<void()> action) {
+  events.emplace(std::make_pair(std::max(time, now), nbEvents++), std::move(action));
+}
+
+void HostStubs::Spend(uint64_t cycles) {
+  RunUntil(now + cycles);
+  Preempt();
+}
+
+void HostStubs::WaitForEvent() {
+  if (interruptNesting > 0) {
+    return;
+  }
+  uint64_t deadline = NextDeadline();
+  if (deadline == never) {
+    std::printf("A register is polled while no hardware event is pending\n");
+    std::abort();
+  }
+  RunUntil(deadline);
+  Preempt();
+}
+
+void HostStubs::Interrupt(void (*handler)()) {
+  interruptNesting++;
+  handler();
+  interruptNesting--;
+}
+
+bool HostStubs::InInterrupt() {
+  return interruptNesting > 0;
+}
+
+void HostStubs::StopScheduler() {
+  stopScheduler = true;
+  if (current != nullptr) {
+    Switch();
+  }
+}
+
+uint32_t HostStubs::Address(const volatile void* pointer) {
+  return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(pointer));
+}
+
+uint8_t* HostStubs::Pointer(uint32_t address) {
+  return reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(address));
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint16_t /*stackDepth*/,
+                       void* parameters,
+                       UBaseType_t priority,
+                       TaskHandle_t* createdTask) {
+  void* stack = mmap(nullptr, stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+  if (stack == MAP_FAILED) {
+    return pdFAIL;
+  }
+  auto* task = new HostTask {};
+  task->stack = static_cast<uint8_t*>(stack);
+  task->function = function;
+  task->parameters = parameters;
+  task->priority = priority;
+  task->name = name;
+  getcontext(&task->context);
+  task->context.uc_stack.ss_sp = stack;
+  task->context.uc_stack.ss_size = stackSize;
+  task->context.uc_link = nullptr;
+  makecontext(&task->context, RunTask, 0);
+  MakeReady(task);
+  tasks.push_back(task);
+  if (createdTask != nullptr) {
+    *createdTask = task;
+  }
+  Preempt();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == current) {
+    current->state = HostTask::States::Deleted;
+    Switch();
+    return;
+  }
+  task->state = HostTask::States::Deleted;
+  DeleteStoppedTasks();
+}
+
+void vTaskStartScheduler() {
+  stopScheduler = false;
+  while (!stopScheduler) {
+    auto* next = HighestReady(nullptr);
+    if (next != nullptr) {
+      current = next;
+      swapcontext(&schedulerContext, &next->context);
+      current = nullptr;
+      DeleteStoppedTasks();
+      continue;
+    }
+    uint64_t deadline = NextDeadline();
+    if (deadline == never) {
+      break;
+    }
+    RunUntil(deadline);
+  }
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return current != nullptr ? current : &mainTask;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  if (current == nullptr) {
+    RunUntil(now + ticks * cyclesPerTick);
+    return;
+  }
+  if (ticks == 0) {
+    // Yields to the other ready tasks of the same priority
+    MakeReady(current);
+    Switch();
+    return;
+  }
+  Block(nullptr, Deadline(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+  return static_cast<TickType_t>(now / cyclesPerTick);
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken) {
+  task->notificationCount++;
+  *higherPriorityTaskWoken = pdTRUE;
+  Signal(task);
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  task->notificationCount++;
+  Signal(task);
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  HostTask* self = xTaskGetCurrentTaskHandle();
+  uint64_t deadline = Deadline(ticksToWait);
+  while (self->notificationCount == 0) {
+    if (!Block(self, deadline)) {
+      return 0;
+    }
+  }
+  uint32_t count = self->notificationCount;
+  self->notificationCount = clearCountOnExit == pdTRUE ? 0 : count - 1;
+  return count;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return new HostSemaphore {0, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+  return new HostSemaphore {initialCount, maxCount};
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new HostSemaphore {1, 1};
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  uint64_t deadline = Deadline(ticksToWait);
+  while (semaphore->count == 0) {
+    if (!Block(semaphore, deadline)) {
+      return pdFALSE;
+    }
+  }
+  semaphore->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  if (semaphore->count == semaphore->maxCount) {
+    return pdFALSE;
+  }
+  semaphore->count++;
+  Signal(semaphore);
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higherPriorityTaskWoken) {
+  *higherPriorityTaskWoken = pdTRUE;
+  return xSemaphoreGive(semaphore);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  return new HostQueue {length, itemSize, {}};
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait) {
+  uint64_t deadline = Deadline(ticksToWait);
+  while (queue->items.size() == queue->length) {
+    if (!Block(&queue->length, deadline)) {
+      return pdFALSE;
+    }
+  }
+  auto* bytes = static_cast<const uint8_t*>(item);
+  queue->items.emplace_back(bytes, bytes + queue->itemSize);
+  Signal(&queue->items);
+  return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higherPriorityTaskWoken) {
+  *higherPriorityTaskWoken = pdTRUE;
+  return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticksToWait) {
+  uint64_t deadline = Deadline(ticksToWait);
+  while (queue->items.empty()) {
+    if (!Block(&queue->items, deadline)) {
+      return pdFALSE;
+    }
+  }
+  std::memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  Signal(&queue->length);
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return queue->items.size();
+}
@@ -0,0 +1,79 @@
+// Glyph descriptor lookup of the LVGL 7 fonts (lv_font_fmt_txt.c), without kerning: the character maps are searched
+// the same way as on the watch, so that the host tests of the font caches see the same glyph ids and the same cost.
+#include <lvgl/lvgl.h>
+#include <cstdlib>
+
+namespace {
+  int UnicodeListCompare(const void* ref, const void* element) {
+    return static_cast<int>(*static_cast<const uint16_t*>(ref)) - static_cast<int>(*static_cast<const uint16_t*>(element));
+  }
+
+  uint32_t GetGlyphDscId(const lv_font_t* font, uint32_t letter) {
+    if (letter == '\0') {
+      return 0;
+    }
+    auto* fdsc = static_cast<lv_font_fmt_txt_dsc_t*>(font->dsc);
+    if (letter == fdsc->last_letter) {
+      return fdsc->last_glyph_id;
+    }
+
+    for (uint16_t i = 0; i < fdsc->cmap_num; i++) {
+      const lv_font_fmt_txt_cmap_t& cmap = fdsc->cmaps[i];
+      uint32_t rcp = letter - cmap.range_start;
+      if (rcp > cmap.range_length) {
+        continue;
+      }
+      uint32_t glyphId = 0;
+      if (cmap.type == LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY) {
+        glyphId = cmap.glyph_id_start + rcp;
+      } else if (cmap.type == LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL) {
+        glyphId = cmap.glyph_id_start + static_cast<const uint8_t*>(cmap.glyph_id_ofs_list)[rcp];
+      } else {
+        auto key = static_cast<uint16_t>(rcp);
+        auto* found = static_cast<const uint16_t*>(
+          std::bsearch(&key, cmap.unicode_list, cmap.list_length, sizeof(cmap.unicode_list[0]), UnicodeListCompare));
+        if (found != nullptr) {
+          size_t offset = found - cmap.unicode_list;
+          if (cmap.type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY) {
+            glyphId = cmap.glyph_id_start + offset;
+          } else {
+            glyphId = cmap.glyph_id_start + static_cast<const uint16_t*>(cmap.glyph_id_ofs_list)[offset];
+          }
+        }
+      }
+      fdsc->last_letter = letter;
+      fdsc->last_glyph_id = glyphId;
+      return glyphId;
+    }
+
+    fdsc->last_letter = letter;
+    fdsc->last_glyph_id = 0;
+    return 0;
+  }
+}
+
+bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t unicode_letter, uint32_t) {
+  bool isTab = false;
+  if (unicode_letter == '\t') {
+    unicode_letter = ' ';
+    isTab = true;
+  }
+  auto* fdsc = static_cast<lv_font_fmt_txt_dsc_t*>(font->dsc);
+  uint32_t glyphId = GetGlyphDscId(font, unicode_letter);
+  if (glyphId == 0) {
+    return false;
+  }
+
+  const lv_font_fmt_txt_glyph_dsc_t& glyph = fdsc->glyph_dsc[glyphId];
+  uint32_t advanceWidth = glyph.adv_w;
+  if (isTab) {
+    advanceWidth *= 2;
+  }
+  dsc_out->adv_w = (advanceWidth + (1 << 3)) >> 4;
+  dsc_out->box_h = glyph.box_h;
+  dsc_out->box_w = isTab ? glyph.box_w * 2 : glyph.box_w;
+  dsc_out->ofs_x = glyph.ofs_x;
+  dsc_out->ofs_y = glyph.ofs_y;
+  dsc_out->bpp = fdsc->bpp;
+  return true;
+}
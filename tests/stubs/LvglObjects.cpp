@@ -0,0 +1,65 @@
+// Tree of the LVGL objects, for the host tests of the components that create, load and delete screens
+#include <lvgl/lvgl.h>
+#include <algorithm>
+#include <vector>
+#include "HostLvgl.h"
+
+struct lv_obj_t {
+  lv_obj_t* parent;
+  std::vector<lv_obj_t*> children;
+};
+
+namespace HostLvgl {
+  uint32_t nbObjects = 0;
+}
+
+namespace {
+  lv_obj_t* activeScreen = nullptr;
+}
+
+lv_obj_t* lv_obj_create(lv_obj_t* parent, const lv_obj_t*) {
+  auto* obj = new lv_obj_t {parent, {}};
+  HostLvgl::nbObjects++;
+  if (parent != nullptr) {
+    parent->children.push_back(obj);
+  }
+  return obj;
+}
+
+void lv_obj_del(lv_obj_t* obj) {
+  lv_obj_clean(obj);
+  if (obj->parent != nullptr) {
+    auto& siblings = obj->parent->children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), obj));
+  }
+  if (obj == activeScreen) {
+    activeScreen = nullptr;
+  }
+  delete obj;
+  HostLvgl::nbObjects--;
+}
+
+void lv_obj_clean(lv_obj_t* obj) {
+  while (!obj->children.empty()) {
+    lv_obj_del(obj->children.back());
+  }
+}
+
+lv_obj_t* lv_obj_get_parent(const lv_obj_t* obj) {
+  return obj->parent;
+}
+
+uint16_t lv_obj_count_children(const lv_obj_t* obj) {
+  return obj->children.size();
+}
+
+lv_obj_t* lv_scr_act() {
+  if (activeScreen == nullptr) {
+    activeScreen = lv_obj_create(nullptr, nullptr);
+  }
+  return activeScreen;
+}
+
+void lv_scr_load(lv_obj_t* scr) {
+  activeScreen = scr;
+}
@@ -0,0 +1,58 @@
+// Registers of the peripherals and GPIOs of the host tests
+#include <nrf.h>
+#include <hal/nrf_gpio.h>
+#include <vector>
+
+// The registers are constructed before the emulated peripherals of the tests, which hook their tasks
+#define REGISTERS __attribute__((init_priority(101)))
+
+namespace {
+  REGISTERS NRF_SPIM_Type spim0;
+  REGISTERS NRF_SPIM_Type spim1;
+  REGISTERS NRF_TWIM_Type twim1;
+  REGISTERS NRF_TIMER_Type timer3;
+  REGISTERS NRF_PPI_Type ppi;
+  NRF_GPIO_Type gpio;
+  REGISTERS NRF_GPIOTE_Type gpiote;
+  DWT_Type dwt;
+  CoreDebug_Type coreDebug;
+
+  struct Watcher {
+    uint32_t pin;
+    HostStubs::PinListener listener;
+    void* context;
+  };
+
+  std::vector<Watcher>& Watchers() {
+    static std::vector<Watcher> watchers;
+    return watchers;
+  }
+}
+
+NRF_SPIM_Type* NRF_SPIM0 = &spim0;
+NRF_SPIM_Type* NRF_SPIM1 = &spim1;
+NRF_TWIM_Type* NRF_TWIM1 = &twim1;
+NRF_TIMER_Type* NRF_TIMER3 = &timer3;
+NRF_PPI_Type* NRF_PPI = &ppi;
+NRF_GPIO_Type* NRF_GPIO = &gpio;
+NRF_GPIOTE_Type* NRF_GPIOTE = &gpiote;
+DWT_Type* DWT = &dwt;
+CoreDebug_Type* CoreDebug = &coreDebug;
+
+bool HostStubs::gpioLevels[32] = {};
+
+void HostStubs::WatchPin(uint32_t pin, PinListener listener, void* context) {
+  Watchers().push_back({pin, listener, context});
+}
+
+void HostStubs::SetPin(uint32_t pin, bool level) {
+  bool changed = gpioLevels[pin] != level;
+  gpioLevels[pin] = level;
+  if (changed) {
+    for (const auto& watcher : Watchers()) {
+      if (watcher.pin == pin) {
+        watcher.listener(watcher.context, pin, level);
+      }
+    }
+  }
+}
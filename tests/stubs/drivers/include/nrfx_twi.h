@@ -0,0 +1,7 @@
+#pragma once
+// nrfx_common.h, through the TWI driver of nrfx
+#include <nrf.h>
+
+inline IRQn_Type nrfx_get_irq_number(const void* reg) {
+  return reg == NRF_TWIM1 ? SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQn : SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn;
+}
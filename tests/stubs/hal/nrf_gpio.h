@@ -0,0 +1,25 @@
+#pragma once
+#include <nrf.h>
+
+inline void nrf_gpio_pin_set(uint32_t pin) {
+  HostStubs::SetPin(pin, true);
+}
+
+inline void nrf_gpio_pin_clear(uint32_t pin) {
+  HostStubs::SetPin(pin, false);
+}
+
+inline uint32_t nrf_gpio_pin_read(uint32_t pin) {
+  return HostStubs::gpioLevels[pin] ? 1 : 0;
+}
+
+enum nrf_gpio_pin_pull_t { NRF_GPIO_PIN_NOPULL, NRF_GPIO_PIN_PULLDOWN, NRF_GPIO_PIN_PULLUP = 3 };
+
+inline void nrf_gpio_cfg_output(uint32_t) {
+}
+
+inline void nrf_gpio_cfg_input(uint32_t, nrf_gpio_pin_pull_t) {
+}
+
+inline void nrf_gpio_cfg_default(uint32_t) {
+}
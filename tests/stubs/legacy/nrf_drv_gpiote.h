@@ -0,0 +1,3 @@
+#pragma once
+// The GPIO functions of the drivers that include the GPIOTE driver
+#include <hal/nrf_gpio.h>
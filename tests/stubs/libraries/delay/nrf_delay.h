@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include "HostStubs.h"
+
+// Busy waits, in emulated time
+inline void nrf_delay_ms(uint32_t ms) {
+  HostStubs::Spend(ms * (HostStubs::cpuFrequency / 1000));
+}
+
+inline void nrf_delay_us(uint32_t us) {
+  HostStubs::Spend(us * (HostStubs::cpuFrequency / 1000000));
+}
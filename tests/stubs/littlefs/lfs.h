@@ -0,0 +1,35 @@
+#pragma once
+// Types of littlefs used by the interface of Controllers::FS. The host tests do not build littlefs: the files are kept
+// in memory by stubs/Fs.cpp.
+#include <cstdint>
+#include <string>
+
+typedef uint32_t lfs_size_t;
+typedef uint32_t lfs_off_t;
+typedef int32_t lfs_ssize_t;
+typedef int32_t lfs_soff_t;
+typedef uint32_t lfs_block_t;
+
+enum lfs_error { LFS_ERR_OK = 0, LFS_ERR_IO = -5, LFS_ERR_NOENT = -2, LFS_ERR_INVAL = -22 };
+enum lfs_open_flags { LFS_O_RDONLY = 1, LFS_O_WRONLY = 2, LFS_O_RDWR = 3, LFS_O_CREAT = 0x0100, LFS_O_TRUNC = 0x0400 };
+enum lfs_type { LFS_TYPE_REG = 0x001, LFS_TYPE_DIR = 0x002 };
+
+struct lfs_config {};
+struct lfs_t {};
+
+struct lfs_info {
+  uint8_t type;
+  lfs_size_t size;
+  char name[51];
+};
+
+typedef struct lfs_file {
+  std::string path;
+  lfs_off_t position;
+  int flags;
+} lfs_file_t;
+
+typedef struct lfs_dir {
+  std::string path;
+  uint32_t position;
+} lfs_dir_t;
@@ -0,0 +1,185 @@
+#pragma once
+// Subset of the LVGL 7 API used by the components built in the host tests
+#include <cstdint>
+#include <cstdlib>
+
+// Same as src/libs/lv_conf.h
+#define LV_MEM_SIZE (14U * 1024U)
+#define LV_MEM_CUSTOM 1
+
+#define LV_DISP_DEF_REFR_PERIOD 20
+
+using lv_coord_t = int16_t;
+
+struct lv_area_t {
+  lv_coord_t x1;
+  lv_coord_t y1;
+  lv_coord_t x2;
+  lv_coord_t y2;
+};
+
+struct lv_task_t;
+
+// Objects: only their tree, in stubs/LvglObjects.cpp
+struct lv_obj_t;
+
+lv_obj_t* lv_obj_create(lv_obj_t* parent, const lv_obj_t* copy);
+void lv_obj_del(lv_obj_t* obj);
+void lv_obj_clean(lv_obj_t* obj);
+lv_obj_t* lv_obj_get_parent(const lv_obj_t* obj);
+uint16_t lv_obj_count_children(const lv_obj_t* obj);
+lv_obj_t* lv_scr_act();
+void lv_scr_load(lv_obj_t* scr);
+
+// Input devices
+struct lv_point_t {
+  lv_coord_t x;
+  lv_coord_t y;
+};
+
+enum { LV_INDEV_STATE_REL = 0, LV_INDEV_STATE_PR };
+using lv_indev_state_t = uint8_t;
+
+struct lv_indev_data_t {
+  lv_point_t point;
+  uint32_t key;
+  uint32_t btn_id;
+  int16_t enc_diff;
+  lv_indev_state_t state;
+};
+
+// Images (LV_COLOR_DEPTH 16)
+using lv_img_cf_t = uint8_t;
+using lv_res_t = uint8_t;
+
+enum { LV_RES_INV = 0, LV_RES_OK = 1 };
+enum { LV_IMG_CF_RAW = 1, LV_IMG_CF_INDEXED_1BIT = 7, LV_IMG_CF_USER_ENCODED_0 = 0x18, LV_IMG_CF_USER_ENCODED_1 = 0x19 };
+enum { LV_IMG_SRC_VARIABLE = 0, LV_IMG_SRC_FILE = 1 };
+
+union lv_color_t {
+  uint16_t full;
+};
+
+#define LV_COLOR_MAKE(r8, g8, b8)                                                                                      \
+  (lv_color_t {static_cast<uint16_t>((((r8) >> 3) << 11) | (((g8) >> 2) << 5) | ((b8) >> 3))})
+#define LV_COLOR_BLACK LV_COLOR_MAKE(0x00, 0x00, 0x00)
+#define LV_COLOR_WHITE LV_COLOR_MAKE(0xff, 0xff, 0xff)
+
+struct lv_img_header_t {
+  uint32_t cf : 5;
+  uint32_t always_zero : 3;
+  uint32_t reserved : 2;
+  uint32_t w : 11;
+  uint32_t h : 11;
+};
+
+struct lv_img_dsc_t {
+  lv_img_header_t header;
+  uint32_t data_size;
+  const uint8_t* data;
+};
+
+struct lv_img_decoder_t {};
+
+struct lv_img_decoder_dsc_t {
+  const void* src;
+  uint8_t src_type;
+  void* user_data;
+  const uint8_t* img_data;
+};
+
+inline uint8_t lv_img_src_get_type(const void*) {
+  return LV_IMG_SRC_VARIABLE;
+}
+
+inline void* lv_mem_alloc(size_t size) {
+  return malloc(size);
+}
+
+inline void lv_mem_free(const void* data) {
+  free(const_cast<void*>(data));
+}
+
+inline lv_img_decoder_t* lv_img_decoder_create() {
+  static lv_img_decoder_t decoder;
+  return &decoder;
+}
+
+template <class Callback> void lv_img_decoder_set_info_cb(lv_img_decoder_t*, Callback) {
+}
+
+template <class Callback> void lv_img_decoder_set_open_cb(lv_img_decoder_t*, Callback) {
+}
+
+template <class Callback> void lv_img_decoder_set_read_line_cb(lv_img_decoder_t*, Callback) {
+}
+
+template <class Callback> void lv_img_decoder_set_close_cb(lv_img_decoder_t*, Callback) {
+}
+
+// Fonts (LV_FONT_FMT_TXT_LARGE 0, LV_USE_USER_DATA 1). lv_font_get_glyph_dsc_fmt_txt() is in stubs/LvglFont.cpp.
+enum { LV_FONT_SUBPX_NONE = 0 };
+enum { LV_FONT_FMT_TXT_PLAIN = 0 };
+
+enum lv_font_fmt_txt_cmap_type_t {
+  LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL,
+  LV_FONT_FMT_TXT_CMAP_SPARSE_FULL,
+  LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY,
+  LV_FONT_FMT_TXT_CMAP_SPARSE_TINY,
+};
+
+struct lv_font_glyph_dsc_t {
+  uint16_t adv_w;
+  uint16_t box_w;
+  uint16_t box_h;
+  int16_t ofs_x;
+  int16_t ofs_y;
+  uint8_t bpp;
+};
+
+struct lv_font_t {
+  bool (*get_glyph_dsc)(const lv_font_t*, lv_font_glyph_dsc_t*, uint32_t letter, uint32_t letter_next);
+  const uint8_t* (*get_glyph_bitmap)(const lv_font_t*, uint32_t);
+  lv_coord_t line_height;
+  lv_coord_t base_line;
+  uint8_t subpx : 2;
+  int8_t underline_position;
+  int8_t underline_thickness;
+  void* dsc;
+  void* user_data;
+};
+
+struct lv_font_fmt_txt_glyph_dsc_t {
+  uint32_t bitmap_index : 20;
+  uint32_t adv_w : 12;
+  uint8_t box_w;
+  uint8_t box_h;
+  int8_t ofs_x;
+  int8_t ofs_y;
+};
+
+struct lv_font_fmt_txt_cmap_t {
+  uint32_t range_start;
+  uint16_t range_length;
+  uint16_t glyph_id_start;
+  const uint16_t* unicode_list;
+  const void* glyph_id_ofs_list;
+  uint16_t list_length;
+  lv_font_fmt_txt_cmap_type_t type;
+};
+
+struct lv_font_fmt_txt_dsc_t {
+  const uint8_t* glyph_bitmap;
+  const lv_font_fmt_txt_glyph_dsc_t* glyph_dsc;
+  const lv_font_fmt_txt_cmap_t* cmaps;
+  const void* kern_dsc;
+  uint16_t kern_scale;
+  uint16_t cmap_num : 9;
+  uint16_t bpp : 4;
+  uint16_t kern_classes : 1;
+  uint16_t bitmap_format : 2;
+  uint32_t last_letter;
+  uint32_t last_glyph_id;
+};
+
+bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t* font, lv_font_glyph_dsc_t* dsc_out, uint32_t unicode_letter, uint32_t unicode_letter_next);
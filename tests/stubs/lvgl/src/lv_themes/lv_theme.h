@@ -0,0 +1,3 @@
+#pragma once
+// Included by displayapp/DummyLittleVgl.h
+#include <lvgl/lvgl.h>
@@ -0,0 +1,242 @@
+#pragma once
+// Host replacement of the nRF52 device header: the peripherals used by the drivers under test are plain structs
+// in RAM. The registers with side effects (tasks, events, set/clear registers) are small classes through which the
+// emulated peripherals of tests/emulation see the accesses of the firmware.
+#include <cstdint>
+#include "HostStubs.h"
+
+namespace HostStubs {
+  // Writing a non-zero value triggers the task
+  struct TaskRegister {
+    uint32_t triggered = 0;
+    void (*onTrigger)(void* context) = nullptr;
+    void* context = nullptr;
+
+    TaskRegister& operator=(uint32_t value) {
+      if (value != 0) {
+        triggered++;
+        if (onTrigger != nullptr) {
+          onTrigger(context);
+        }
+      }
+      return *this;
+    }
+  };
+
+  // Set by the hardware, cleared by the firmware. Reading it while it is not set, from a task, is a polling loop:
+  // the hardware runs until its next event.
+  struct EventRegister {
+    uint32_t value = 0;
+
+    EventRegister& operator=(uint32_t newValue) {
+      value = newValue;
+      return *this;
+    }
+
+    operator uint32_t() const {
+      if (value == 0) {
+        WaitForEvent();
+      }
+      return value;
+    }
+  };
+
+  // INTENSET/INTENCLR and CHENSET/CHENCLR: writing sets or clears bits of the enable register, reading returns it
+  template <bool Set> struct SetClearRegister {
+    uint32_t* enabled;
+
+    SetClearRegister& operator=(uint32_t value) {
+      if (Set) {
+        *enabled |= value;
+      } else {
+        *enabled &= ~value;
+      }
+      return *this;
+    }
+
+    operator uint32_t() const {
+      return *enabled;
+    }
+  };
+
+  struct EasyDmaChannel {
+    uint32_t PTR;
+    uint32_t MAXCNT;
+    uint32_t AMOUNT;
+    uint32_t LIST;
+  };
+}
+
+struct NRF_SPIM_Type {
+  HostStubs::TaskRegister TASKS_START;
+  HostStubs::TaskRegister TASKS_STOP;
+  HostStubs::EventRegister EVENTS_STOPPED;
+  HostStubs::EventRegister EVENTS_ENDRX;
+  HostStubs::EventRegister EVENTS_END;
+  HostStubs::EventRegister EVENTS_ENDTX;
+  HostStubs::EventRegister EVENTS_STARTED;
+  uint32_t INTEN;
+  HostStubs::SetClearRegister<true> INTENSET {&INTEN};
+  HostStubs::SetClearRegister<false> INTENCLR {&INTEN};
+  uint32_t ENABLE;
+  struct {
+    uint32_t SCK;
+    uint32_t MOSI;
+    uint32_t MISO;
+  } PSEL;
+  uint32_t FREQUENCY;
+  HostStubs::EasyDmaChannel RXD;
+  HostStubs::EasyDmaChannel TXD;
+  uint32_t CONFIG;
+  uint32_t ORC;
+};
+
+struct NRF_TWIM_Type {
+  HostStubs::TaskRegister TASKS_STARTRX;
+  HostStubs::TaskRegister TASKS_STARTTX;
+  HostStubs::TaskRegister TASKS_STOP;
+  HostStubs::TaskRegister TASKS_SUSPEND;
+  HostStubs::TaskRegister TASKS_RESUME;
+  HostStubs::EventRegister EVENTS_STOPPED;
+  HostStubs::EventRegister EVENTS_ERROR;
+  HostStubs::EventRegister EVENTS_SUSPENDED;
+  HostStubs::EventRegister EVENTS_RXSTARTED;
+  HostStubs::EventRegister EVENTS_TXSTARTED;
+  HostStubs::EventRegister EVENTS_LASTRX;
+  HostStubs::EventRegister EVENTS_LASTTX;
+  uint32_t SHORTS;
+  uint32_t INTEN;
+  HostStubs::SetClearRegister<true> INTENSET {&INTEN};
+  HostStubs::SetClearRegister<false> INTENCLR {&INTEN};
+  uint32_t ERRORSRC;
+  uint32_t ENABLE;
+  struct {
+    uint32_t SCL;
+    uint32_t SDA;
+  } PSEL;
+  uint32_t FREQUENCY;
+  HostStubs::EasyDmaChannel RXD;
+  HostStubs::EasyDmaChannel TXD;
+  uint32_t ADDRESS;
+};
+
+struct NRF_TIMER_Type {
+  HostStubs::TaskRegister TASKS_START;
+  HostStubs::TaskRegister TASKS_STOP;
+  HostStubs::TaskRegister TASKS_COUNT;
+  HostStubs::TaskRegister TASKS_CLEAR;
+  HostStubs::EventRegister EVENTS_COMPARE[6];
+  uint32_t SHORTS;
+  uint32_t INTEN;
+  HostStubs::SetClearRegister<true> INTENSET {&INTEN};
+  HostStubs::SetClearRegister<false> INTENCLR {&INTEN};
+  uint32_t MODE;
+  uint32_t BITMODE;
+  uint32_t CC[6];
+};
+
+struct NRF_PPI_Type {
+  struct {
+    HostStubs::TaskRegister EN;
+    HostStubs::TaskRegister DIS;
+  } TASKS_CHG[6];
+  uint32_t CHEN;
+  HostStubs::SetClearRegister<true> CHENSET {&CHEN};
+  HostStubs::SetClearRegister<false> CHENCLR {&CHEN};
+  struct {
+    uint32_t EEP;
+    uint32_t TEP;
+  } CH[20];
+  uint32_t CHG[6];
+};
+
+struct NRF_GPIOTE_Type {
+  HostStubs::EventRegister EVENTS_IN[8];
+  uint32_t CONFIG[8];
+};
+
+struct NRF_GPIO_Type {
+  uint32_t PIN_CNF[32];
+};
+
+struct DWT_Type {
+  uint32_t CTRL;
+  uint32_t CYCCNT;
+};
+
+struct CoreDebug_Type {
+  uint32_t DEMCR;
+};
+
+extern NRF_SPIM_Type* NRF_SPIM0;
+extern NRF_SPIM_Type* NRF_SPIM1;
+extern NRF_TWIM_Type* NRF_TWIM1;
+extern NRF_TIMER_Type* NRF_TIMER3;
+extern NRF_PPI_Type* NRF_PPI;
+extern NRF_GPIO_Type* NRF_GPIO;
+extern NRF_GPIOTE_Type* NRF_GPIOTE;
+extern DWT_Type* DWT;
+extern CoreDebug_Type* CoreDebug;
+
+enum IRQn_Type { SPIM0_SPIS0_TWIM0_TWIS0_SPI0_TWI0_IRQn, SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQn, TIMER3_IRQn };
+
+#define NRFX_IRQ_PRIORITY_SET(irq, priority)
+#define NRFX_IRQ_ENABLE(irq)
+
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+
+// nrf52_name_change.h
+#define PSELSCK PSEL.SCK
+#define PSELMOSI PSEL.MOSI
+#define PSELMISO PSEL.MISO
+
+#define GPIO_PIN_CNF_DIR_Pos (0UL)
+#define GPIO_PIN_CNF_DIR_Input (0UL)
+#define GPIO_PIN_CNF_INPUT_Pos (1UL)
+#define GPIO_PIN_CNF_INPUT_Connect (0UL)
+#define GPIO_PIN_CNF_PULL_Pos (2UL)
+#define GPIO_PIN_CNF_PULL_Disabled (0UL)
+#define GPIO_PIN_CNF_DRIVE_Pos (8UL)
+#define GPIO_PIN_CNF_DRIVE_S0D1 (6UL)
+#define GPIO_PIN_CNF_SENSE_Pos (16UL)
+#define GPIO_PIN_CNF_SENSE_Disabled (0UL)
+
+#define GPIOTE_CONFIG_MODE_Pos (0UL)
+#define GPIOTE_CONFIG_MODE_Event (1UL)
+#define GPIOTE_CONFIG_PSEL_Pos (8UL)
+#define GPIOTE_CONFIG_POLARITY_Pos (16UL)
+#define GPIOTE_CONFIG_POLARITY_Toggle (3UL)
+
+#define SPIM_ENABLE_ENABLE_Pos (0UL)
+#define SPIM_ENABLE_ENABLE_Disabled (0UL)
+#define SPIM_ENABLE_ENABLE_Enabled (7UL)
+#define SPIM_TXD_LIST_LIST_Pos (0UL)
+#define SPIM_TXD_LIST_LIST_ArrayList (1UL)
+
+#define TWIM_ENABLE_ENABLE_Pos (0UL)
+#define TWIM_ENABLE_ENABLE_Disabled (0UL)
+#define TWIM_ENABLE_ENABLE_Enabled (6UL)
+#define TWIM_SHORTS_LASTTX_STARTRX_Msk (1UL << 7)
+#define TWIM_SHORTS_LASTTX_SUSPEND_Msk (1UL << 8)
+#define TWIM_SHORTS_LASTTX_STOP_Msk (1UL << 9)
+#define TWIM_SHORTS_LASTRX_STARTTX_Msk (1UL << 10)
+#define TWIM_SHORTS_LASTRX_STOP_Msk (1UL << 12)
+#define TWIM_INTEN_STOPPED_Msk (1UL << 1)
+#define TWIM_INTEN_ERROR_Msk (1UL << 9)
+#define TWIM_INTEN_SUSPENDED_Msk (1UL << 18)
+#define TWIM_INTEN_RXSTARTED_Msk (1UL << 19)
+#define TWIM_INTEN_TXSTARTED_Msk (1UL << 20)
+#define TWIM_INTEN_LASTRX_Msk (1UL << 23)
+#define TWIM_INTEN_LASTTX_Msk (1UL << 24)
+#define TWIM_ERRORSRC_OVERRUN_Msk (1UL << 0)
+#define TWIM_ERRORSRC_ANACK_Msk (1UL << 1)
+#define TWIM_ERRORSRC_DNACK_Msk (1UL << 2)
+
+#define TIMER_MODE_MODE_Pos (0UL)
+#define TIMER_MODE_MODE_Counter (2UL)
+#define TIMER_BITMODE_BITMODE_Pos (0UL)
+#define TIMER_BITMODE_BITMODE_16Bit (0UL)
+#define TIMER_SHORTS_COMPARE0_CLEAR_Msk (1UL << 0)
+#define TIMER_SHORTS_COMPARE0_STOP_Msk (1UL << 8)
+#define TIMER_INTENSET_COMPARE0_Msk (1UL << 16)
@@ -0,0 +1,17 @@
+#pragma once
+// Fonts of the gfx library of the SDK, as declared by components/gfx/Gfx.h
+#include <cstdint>
+
+typedef struct {
+  uint8_t widthBits;
+  uint16_t offset;
+} FONT_CHAR_INFO;
+
+typedef struct {
+  uint8_t height;
+  uint8_t startChar;
+  uint8_t endChar;
+  uint8_t spacePixels;
+  const FONT_CHAR_INFO* charInfo;
+  const uint8_t* data;
+} FONT_INFO;
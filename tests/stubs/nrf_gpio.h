@@ -0,0 +1,3 @@
+#pragma once
+// The hal directory of the SDK is in the include path of the firmware
+#include <hal/nrf_gpio.h>
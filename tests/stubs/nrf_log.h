@@ -0,0 +1,4 @@
+#pragma once
+
+#define NRF_LOG_INFO(...)
+#define NRF_LOG_PUSH(string) (string)
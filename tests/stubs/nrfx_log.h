@@ -0,0 +1,3 @@
+#pragma once
+
+#define NRF_LOG_INFO(...)
@@ -0,0 +1,28 @@
+#pragma once
+#include <FreeRTOS.h>
+
+using TaskHandle_t = struct HostTask*;
+using TaskFunction_t = void (*)(void*);
+
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskENTER_CRITICAL_FROM_ISR() 0
+#define taskEXIT_CRITICAL_FROM_ISR(status) ((void) (status))
+#define taskYIELD() vTaskDelay(0)
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint16_t stackDepth,
+                       void* parameters,
+                       UBaseType_t priority,
+                       TaskHandle_t* createdTask);
+void vTaskDelete(TaskHandle_t task);
+// Runs the tasks until they are all blocked forever or deleted, then returns
+void vTaskStartScheduler();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount();
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityTaskWoken);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
@@ -0,0 +1,5 @@
+#pragma once
+// Software timers: only their handle, for the headers of the components that are not built in the host tests
+#include <FreeRTOS.h>
+
+using TimerHandle_t = struct HostTimer*;
@@ -291,6 +291,34 @@ def render_c(image, fname, indent, depth):
             i = 0
     print('\n};')
 
+def render_lvgl(image, fname, indent, depth):
+    """Render the image as an LVGL image descriptor, to be drawn with the
+    RLE image decoder of InfiniTime (src/displayapp/RleImageDecoder.h).
+    """
+    extra_indent = ' ' * indent
+    if len(image) == 3:
+        (x, y, _) = image
+        cf = 'LV_IMG_CF_USER_ENCODED_0'
+    else:
+        (x, y) = (image[1], image[2])
+        cf = 'LV_IMG_CF_USER_ENCODED_1'
+
+    render_c(image, fname, indent, depth)
+    print(f'{extra_indent}const lv_img_dsc_t {varname(fname)}_img = {{')
+    print(f'{extra_indent}  {{{cf}, 0, 0, {x}, {y}}},')
+    print(f'{extra_indent}  sizeof({varname(fname)}),')
+    print(f'{extra_indent}  {varname(fname)}')
+    print(f'{extra_indent}}};')
+
+def report(image, fname, im):
+    """Compare the size of the encoded image with the LVGL raw formats."""
+    encoded = len(image[2]) if len(image) == 3 else len(image)
+    true_color = im.width * im.height * 2
+    indexed_1bit = ((im.width + 7) // 8) * im.height + 8
+    print(f'{fname}: {im.width}x{im.height}, true color {true_color} bytes, '
+          f'1-bit indexed {indexed_1bit} bytes, RLE {encoded} bytes '
+          f'({100 * encoded // true_color}% of true color)')
+
 def render_py(image, fname, indent, depth):
     extra_indent = ' ' * indent
     if len(image) == 3:
@@ -348,6 +376,12 @@ parser.add_argument('--ascii', action='store_true',
                     help='Run the resulting image(s) through an ascii art decoder')
 parser.add_argument('--c', action='store_true',
                     help='Render the output as C instead of python')
+parser.add_argument('--lvgl', action='store_true',
+                    help='Render the output as C with an LVGL image descriptor')
+parser.add_argument('--report', action='store_true',
+                    help='Only report the encoded size compared to the raw LVGL formats')
+parser.add_argument('--black', type=lambda c: int(c, 16),
+                    help='Colour (RRGGBB) to encode as black, such as the chroma key of an image drawn on a black background')
 parser.add_argument('--indent', default=0, type=int,
                     help='Add extra indentation in the generated code')
 parser.add_argument('--2bit', action='store_true', dest='twobit',
@@ -366,14 +400,34 @@ else:
     encoder = encode
     depth =1
 
+total_raw = 0
+total_encoded = 0
 for fname in args.files:
-    image = encoder(Image.open(fname))
-
-    if args.c:
+    im = Image.open(fname)
+    if args.report or args.black is not None:
+        im = im.convert('RGB')
+    if args.black is not None:
+        key = (args.black >> 16, (args.black >> 8) & 0xff, args.black & 0xff)
+        im.putdata([(0, 0, 0) if px == key else px for px in im.getdata()])
+    image = encoder(im)
+
+    if args.report:
+        report(image, fname, im)
+        total_raw += im.width * im.height * 2
+        total_encoded += len(image[2]) if len(image) == 3 else len(image)
+        continue
+
+    if args.lvgl:
+        render_lvgl(image, fname, args.indent, depth)
+    elif args.c:
         render_c(image, fname, args.indent, depth)
     else:
         render_py(image, fname, args.indent, depth)
 
     if args.ascii:
         print()
-        decode_to_ascii(image)
\ No newline at end of file
+        decode_to_ascii(image)
+
+if args.report and total_raw:
+    print(f'Total: true color {total_raw} bytes, RLE {total_encoded} bytes '
+          f'({100 * total_encoded // total_raw}% of true color)')